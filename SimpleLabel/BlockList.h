@@ -0,0 +1,164 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef BLOCKLIST_H
+#define BLOCKLIST_H
+
+#include <QList>
+#include <QVector>
+#include <QtAlgorithms>
+
+//appended elements start a new block once the last one holds this many
+#define BLOCK_LIST_SIZE	256
+
+//Dense per frame track stored as a list of implicitly shared blocks. Tracks
+//rebuilt from via points keep one block per segment between two via points,
+//so moving a via point replaces the blocks of its two segments while every
+//other block stays shared with the undo history and the snapshots. Copying
+//the list only copies the block handles.
+//
+//Elements are read with at() and written with replace(), which copies only
+//the block holding the element if it is shared. There is no non-const
+//operator[], so reading can't detach a block by accident.
+template<class T>
+class BlockList
+{
+public:
+	BlockList() : mCount(0) {}
+
+	int count() const { return mCount; }
+	int size() const { return mCount; }
+	bool isEmpty() const { return mCount == 0; }
+
+	const T &at(int i) const
+	{
+		int b = blockOf(i);
+		return mBlocks.at(b).at(i - mStarts.at(b));
+	}
+	const T &operator[](int i) const { return at(i); }
+	const T &first() const { return mBlocks.first().first(); }
+	const T &last() const { return mBlocks.last().last(); }
+
+	void replace(int i, const T &v)
+	{
+		int b = blockOf(i);
+		mBlocks[b][i - mStarts.at(b)] = v;
+	}
+
+	void clear()
+	{
+		mBlocks.clear();
+		mStarts.clear();
+		mCount = 0;
+	}
+
+	void append(const T &v)
+	{
+		if(mBlocks.isEmpty() || mBlocks.last().count() >= BLOCK_LIST_SIZE)
+		{
+			mStarts << mCount;
+			mBlocks << QVector<T>();
+		}
+		mBlocks.last().append(v);
+		mCount++;
+	}
+
+	BlockList &operator<<(const T &v)
+	{
+		append(v);
+		return *this;
+	}
+
+	//adds the block as it is, it stays shared with the caller
+	void appendBlock(const QVector<T> &block)
+	{
+		if(block.isEmpty())
+			return;
+		mStarts << mCount;
+		mBlocks << block;
+		mCount += block.count();
+	}
+
+	int blockCount() const { return mBlocks.count(); }
+	const QVector<T> &block(int b) const { return mBlocks.at(b); }
+	int blockStart(int b) const { return mStarts.at(b); }
+
+	//the block starting at index i, -1 if no block starts there
+	int blockAt(int i) const
+	{
+		QVector<int>::const_iterator it = qBinaryFind(mStarts.constBegin(), mStarts.constEnd(), i);
+		return it == mStarts.constEnd() ? -1 : it - mStarts.constBegin();
+	}
+
+	//copy of len elements from pos
+	QList<T> mid(int pos, int len) const
+	{
+		QList<T> res;
+		res.reserve(len);
+		for(int i = pos; i < pos + len; i++)
+		{
+			res << at(i);
+		}
+		return res;
+	}
+
+	QList<T> toList() const { return mid(0, mCount); }
+
+	//blocks that are still shared are equal without looking at their elements
+	bool operator==(const BlockList &b) const
+	{
+		if(mCount != b.mCount)
+			return false;
+		if(mStarts == b.mStarts)
+		{
+			for(int k = 0; k < mBlocks.count(); k++)
+			{
+				if(mBlocks.at(k).constData() != b.mBlocks.at(k).constData() && mBlocks.at(k) != b.mBlocks.at(k))
+					return false;
+			}
+			return true;
+		}
+
+		for(int i = 0; i < mCount; i++)
+		{
+			if(!(at(i) == b.at(i)))
+				return false;
+		}
+		return true;
+	}
+
+	bool operator!=(const BlockList &b) const { return !(*this == b); }
+
+private:
+	//the last block starting at or before i
+	int blockOf(int i) const
+	{
+		return qUpperBound(mStarts.constBegin(), mStarts.constEnd(), i) - mStarts.constBegin() - 1;
+	}
+
+	QList<QVector<T> > mBlocks;
+	QVector<int> mStarts;	//index of the first element of every block
+	int mCount;
+};
+
+#endif
@@ -0,0 +1,108 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+
+//Queue between two stages of a pipeline running on different threads. push()
+//blocks while the queue is full, so a fast producer can't run away from a slow
+//consumer, and pop() blocks while it is empty.
+template<class T>
+class BoundedQueue
+{
+public:
+	BoundedQueue(int capacity) : mCapacity(qMax(capacity, 1)), mClosed(false) {}
+
+	//returns false if the queue was closed and the item was dropped
+	bool push(const T &item)
+	{
+		QMutexLocker lock(&mMutex);
+		while(mItems.count() >= mCapacity && !mClosed)
+		{
+			mNotFull.wait(&mMutex);
+		}
+		if(mClosed)
+			return false;
+
+		mItems.enqueue(item);
+		mNotEmpty.wakeOne();
+		return true;
+	}
+
+	//returns false once the queue is closed and empty
+	bool pop(T &item)
+	{
+		QMutexLocker lock(&mMutex);
+		while(mItems.isEmpty() && !mClosed)
+		{
+			mNotEmpty.wait(&mMutex);
+		}
+		if(mItems.isEmpty())
+			return false;
+
+		item = mItems.dequeue();
+		mNotFull.wakeOne();
+		return true;
+	}
+
+	//no more items are accepted, the queued ones can still be taken
+	void close()
+	{
+		QMutexLocker lock(&mMutex);
+		mClosed = true;
+		mNotEmpty.wakeAll();
+		mNotFull.wakeAll();
+	}
+
+	//closes the queue and drops the queued items
+	void abort()
+	{
+		QMutexLocker lock(&mMutex);
+		mClosed = true;
+		mItems.clear();
+		mNotEmpty.wakeAll();
+		mNotFull.wakeAll();
+	}
+
+	int count() const
+	{
+		QMutexLocker lock(&mMutex);
+		return mItems.count();
+	}
+
+private:
+	Q_DISABLE_COPY(BoundedQueue)
+
+	int mCapacity;
+	bool mClosed;
+	QQueue<T> mItems;
+	mutable QMutex mMutex;
+	QWaitCondition mNotEmpty;
+	QWaitCondition mNotFull;
+};
+
+#endif
@@ -0,0 +1,160 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "BoxTrack.h"
+
+//same rounding as the ROUND macro, but branch free so the loops below vectorize
+static inline int roundHalfUp(double v)
+{
+	return (int)floor(v + 0.5);
+}
+
+//both kinds of box lists are read through at()
+template<class List>
+static void fill(BoxTrack &track, const List &boxes)
+{
+	track.resize(boxes.count());
+
+	int *pf = track.frame.data();
+	int *px = track.x.data();
+	int *py = track.y.data();
+	int *pw = track.w.data();
+	int *ph = track.h.data();
+	float *pa = track.angle.data();
+
+	for(int i = 0; i < boxes.count(); i++)
+	{
+		const ViaPoint &b = boxes.at(i);
+		pf[i] = b.frame;
+		px[i] = b.rc.left();
+		py[i] = b.rc.top();
+		pw[i] = b.rc.width();
+		ph[i] = b.rc.height();
+		pa[i] = b.angle;
+	}
+}
+
+BoxTrack::BoxTrack()
+{
+}
+
+BoxTrack::BoxTrack(const QList<ViaPoint> &boxes)
+{
+	fill(*this, boxes);
+}
+
+BoxTrack::BoxTrack(const BlockList<ViaPoint> &boxes)
+{
+	fill(*this, boxes);
+}
+
+void BoxTrack::clear()
+{
+	resize(0);
+}
+
+void BoxTrack::resize(int n)
+{
+	frame.resize(n);
+	x.resize(n);
+	y.resize(n);
+	w.resize(n);
+	h.resize(n);
+	angle.resize(n);
+}
+
+void BoxTrack::interpolate(const ViaPoint &b1, const ViaPoint &b2)
+{
+	int n = b2.frame - b1.frame + 1;
+	if(n < 1)
+	{
+		clear();
+		return;
+	}
+	resize(n);
+
+	double df = qMax(b2.frame - b1.frame, 1);
+	double x0 = b1.rc.left();
+	double y0 = b1.rc.top();
+	double w0 = b1.rc.width();
+	double h0 = b1.rc.height();
+	double a0 = b1.angle;
+	double dx = (b2.rc.left() - b1.rc.left())/df;
+	double dy = (b2.rc.top() - b1.rc.top())/df;
+	double dw = (b2.rc.width() - b1.rc.width())/df;
+	double dh = (b2.rc.height() - b1.rc.height())/df;
+	double da = (b2.angle - b1.angle)/df;
+	int f0 = b1.frame;
+
+	int *pf = frame.data();
+	int *px = x.data();
+	int *py = y.data();
+	int *pw = w.data();
+	int *ph = h.data();
+	float *pa = angle.data();
+
+	for(int t = 0; t < n; t++)
+	{
+		pf[t] = f0 + t;
+		px[t] = roundHalfUp(x0 + t*dx);
+		py[t] = roundHalfUp(y0 + t*dy);
+		pw[t] = roundHalfUp(w0 + t*dw);
+		ph[t] = roundHalfUp(h0 + t*dh);
+		pa[t] = a0 + da*t;
+	}
+}
+
+void BoxTrack::scale(int srcW, int srcH, int destW, int destH)
+{
+	double kX = (double)destW/(double)srcW;
+	double kY = (double)destH/(double)srcH;
+	int n = count();
+
+	int *px = x.data();
+	int *py = y.data();
+	int *pw = w.data();
+	int *ph = h.data();
+
+	//corners are scaled separately, exactly like imageToImage(QRect) does
+	for(int i = 0; i < n; i++)
+	{
+		int l = roundHalfUp(px[i]*kX);
+		int r = roundHalfUp((px[i] + pw[i] - 1)*kX);
+		int t = roundHalfUp(py[i]*kY);
+		int b = roundHalfUp((py[i] + ph[i] - 1)*kY);
+
+		px[i] = l;
+		py[i] = t;
+		pw[i] = r - l + 1;
+		ph[i] = b - t + 1;
+	}
+}
+
+void BoxTrack::appendTo(QVector<ViaPoint> &boxes, int n) const
+{
+	boxes.reserve(boxes.count() + n);
+	for(int i = 0; i < n; i++)
+	{
+		boxes.append(at(i));
+	}
+}
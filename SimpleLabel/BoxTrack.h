@@ -0,0 +1,64 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef BOXTRACK_H
+#define BOXTRACK_H
+
+#include <QVector>
+#include <QList>
+#include <QRect>
+#include "Constants.h"
+
+//Struct-of-arrays representation of a rectangle track. Every box parameter
+//lives in its own contiguous column so that interpolation and coordinate
+//scaling run as tight loops over plain arrays which the compiler can vectorize.
+class BoxTrack
+{
+public:
+	BoxTrack();
+	BoxTrack(const QList<ViaPoint> &boxes);
+	BoxTrack(const BlockList<ViaPoint> &boxes);
+
+	int count() const { return frame.count(); }
+	void clear();
+	void resize(int n);
+
+	//fills the track with the boxes linearly interpolated between b1 and b2 (both ends included)
+	void interpolate(const ViaPoint &b1, const ViaPoint &b2);
+	//maps all boxes from the srcW x srcH image to the destW x destH image
+	void scale(int srcW, int srcH, int destW, int destH);
+
+	QRect rect(int i) const { return QRect(x[i], y[i], w[i], h[i]); }
+	ViaPoint at(int i) const { return ViaPoint(frame[i], angle[i], rect(i)); }
+	//appends the first n boxes
+	void appendTo(QVector<ViaPoint> &boxes, int n) const;
+
+	QVector<int> frame;
+	QVector<int> x;
+	QVector<int> y;
+	QVector<int> w;
+	QVector<int> h;
+	QVector<float> angle;
+};
+
+#endif
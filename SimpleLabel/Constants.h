@@ -31,6 +31,8 @@
 #include <QRect>
 #include <QPolygon>
 #include <QTransform>
+#include "SmallPolygon.h"
+#include "BlockList.h"
 
 #define W_DISPLAYIMAGE	800
 #define H_DISPLAYIMAGE	600
@@ -39,6 +41,7 @@
 #define WINDOW_OFFSET_Y 25
 #define CORNER_CIRCLE_RAD	5
 #define LENGTH_OF_ROTATION_LINE	20
+#define SUGGESTION_MARK_SIZE	4
 
 #define INVALID_ANGLE	0xffffffff
 
@@ -83,14 +86,14 @@ public:
 	int frame;
 	QRect rc;
 
-        bool operator == (const ViaPoint& b)
+        bool operator == (const ViaPoint& b) const
 	{
 		return this->angle == b.angle &&
 			this->frame == b.frame &&
 			this->rc == b.rc;
 	}
 
-        bool operator != (const ViaPoint& b)
+        bool operator != (const ViaPoint& b) const
 	{
 		return !(*this == b);
 	}
@@ -115,48 +118,208 @@ private:
 	}
 };
 
+Q_DECLARE_TYPEINFO(ViaPoint, Q_MOVABLE_TYPE);
+
 struct ViaPointPolygon
 {
 	int frame;
-	QPolygon pl;
+	SmallPolygon pl;
+
+	ViaPoint boundingBox() const
+	{
+		return ViaPoint(frame, 0.0, pl.boundingRect());
+	}
+
+	bool operator==(const ViaPointPolygon &b) const
+	{
+		return frame == b.frame && pl == b.pl;
+	}
+
+	//the four corners of the (rotated) box
+	static ViaPointPolygon fromBox(const ViaPoint &v)
+	{
+		QPointF c(v.rc.center());
+		QTransform tr;
+		tr.translate(c.x(), c.y());
+		tr.rotate(-v.angle);
+		tr.translate(-c.x(), -c.y());
+
+		ViaPointPolygon res;
+		res.frame = v.frame;
+		res.pl << tr.map(v.rc.topLeft()) << tr.map(v.rc.topRight()) << tr.map(v.rc.bottomRight()) << tr.map(v.rc.bottomLeft());
+		return res;
+	}
 };
 
+//polygon lists are QVectors, they are moved with memcpy when they grow
+Q_DECLARE_TYPEINFO(ViaPointPolygon, Q_MOVABLE_TYPE);
+
 struct Label
 {
+	Label() : number(0), shape(Rect), intr(LinearIntr) {}
+
 	int number;
 	QString name;
 	QString desc;
 	LabelShape shape;
-	QList<ViaPoint> boxes;
+	InterpolationMethod intr;
+	//the dense tracks are shared in blocks, they are only read through const
+	//access and written with replace()
+	BlockList<ViaPoint> boxes;
 	QList<ViaPoint> viaPoints;
-	QList<ViaPointPolygon> polygons;
-	QList<ViaPointPolygon> viaPointsPoly;
+	BlockList<ViaPointPolygon> polygons;
+	QVector<ViaPointPolygon> viaPointsPoly;
+
+	//Labels are compared by content. Qt containers compare equal at once when
+	//they share their data and BlockList skips its shared blocks, so comparing
+	//unchanged labels costs next to nothing.
+	bool operator==(const Label &b) const
+	{
+		return number == b.number && shape == b.shape && intr == b.intr &&
+			name == b.name && desc == b.desc &&
+			viaPoints == b.viaPoints && viaPointsPoly == b.viaPointsPoly &&
+			boxes == b.boxes && polygons == b.polygons;
+	}
+
+	bool operator!=(const Label &b) const { return !(*this == b); }
+
+	//index of the frame in the dense track, -1 outside of it
+	int boxIndex(int frame) const
+	{
+		int fr = boxes.isEmpty() ? -1 : frame - boxes.first().frame;
+		return fr >= 0 && fr < boxes.count() ? fr : -1;
+	}
+
+	int polygonIndex(int frame) const
+	{
+		int fr = polygons.isEmpty() ? -1 : frame - polygons.first().frame;
+		return fr >= 0 && fr < polygons.count() ? fr : -1;
+	}
+
+	const ViaPoint* findBoxByFrame(int frame) const
+	{
+		int fr = boxIndex(frame);
+		return fr >= 0 ? &boxes.at(fr) : NULL;
+	}
+
+	const ViaPointPolygon* findPolygonByFrame(int frame) const
+	{
+		int fr = polygonIndex(frame);
+		return fr >= 0 ? &polygons.at(fr) : NULL;
+	}
+
+	//Only the track of the label's own shape is stored: boxes and viaPoints for
+	//rectangles, polygons and viaPointsPoly for polygons. The other shape is
+	//derived from it when needed.
+	bool boxAt(int frame, ViaPoint &box) const
+	{
+		if(shape == Polyg)
+		{
+			const ViaPointPolygon *p = findPolygonByFrame(frame);
+			if(p != NULL)
+				box = p->boundingBox();
+			return p != NULL;
+		}
+
+		const ViaPoint *b = findBoxByFrame(frame);
+		if(b != NULL)
+			box = *b;
+		return b != NULL;
+	}
+
+	//First and last frame of the label's via points. Imported labels may only
+	//have a dense track, then it decides. Returns false if the label is empty.
+	bool frameRange(int &first, int &last) const
+	{
+		bool poly = shape == Polyg;
+		if(poly ? !viaPointsPoly.isEmpty() : !viaPoints.isEmpty())
+		{
+			first = poly ? viaPointsPoly.first().frame : viaPoints.first().frame;
+			last = poly ? viaPointsPoly.last().frame : viaPoints.last().frame;
+			return true;
+		}
+		if(poly ? !polygons.isEmpty() : !boxes.isEmpty())
+		{
+			first = poly ? polygons.first().frame : boxes.first().frame;
+			last = poly ? polygons.last().frame : boxes.last().frame;
+			return true;
+		}
+		return false;
+	}
+
+	bool polygonAt(int frame, SmallPolygon &pl) const
+	{
+		if(shape == Polyg)
+		{
+			const ViaPointPolygon *p = findPolygonByFrame(frame);
+			if(p != NULL)
+				pl = p->pl;
+			return p != NULL;
+		}
+
+		const ViaPoint *b = findBoxByFrame(frame);
+		if(b != NULL)
+			pl = ViaPointPolygon::fromBox(*b).pl;
+		return b != NULL;
+	}
+
+	BlockList<ViaPoint> boxTrack() const { return shape == Polyg ? toBoxes(polygons) : boxes; }
+	QList<ViaPoint> boxViaPoints() const { return shape == Polyg ? toBoxes(viaPointsPoly) : viaPoints; }
+	BlockList<ViaPointPolygon> polygonTrack() const { return shape == Polyg ? polygons : toPolygons(boxes); }
+	QVector<ViaPointPolygon> polygonViaPoints() const { return shape == Polyg ? viaPointsPoly : toPolygons(viaPoints); }
 
-	ViaPoint* findBoxByFrame(int frame)
+	static QList<ViaPoint> toBoxes(const QVector<ViaPointPolygon> &track)
 	{
-		ViaPoint *res = NULL;
-		int fr;
-		if(boxes.count() > 0)
+		QList<ViaPoint> res;
+		res.reserve(track.count());
+		for(int i = 0; i < track.count(); i++)
 		{
-			fr = frame - boxes[0].frame;
-			if(fr >= 0 && fr < boxes.count())
-				res = &(boxes[fr]);
+			res << track[i].boundingBox();
 		}
+		return res;
+	}
 
+	static QVector<ViaPointPolygon> toPolygons(const QList<ViaPoint> &track)
+	{
+		QVector<ViaPointPolygon> res;
+		res.reserve(track.count());
+		for(int i = 0; i < track.count(); i++)
+		{
+			res << ViaPointPolygon::fromBox(track[i]);
+		}
 		return res;
 	}
 
-	ViaPointPolygon* findPolygonByFrame(int frame)
+	//the dense tracks are converted block by block
+	static BlockList<ViaPoint> toBoxes(const BlockList<ViaPointPolygon> &track)
 	{
-		ViaPointPolygon *res = NULL;
-		int fr;
-		if(polygons.count() > 0)
+		BlockList<ViaPoint> res;
+		for(int b = 0; b < track.blockCount(); b++)
 		{
-			fr = frame - polygons[0].frame;
-			if(fr >= 0 && fr < polygons.count())
-				res = &(polygons[fr]);
+			const QVector<ViaPointPolygon> &src = track.block(b);
+			QVector<ViaPoint> dst(src.count());
+			for(int i = 0; i < src.count(); i++)
+			{
+				dst[i] = src.at(i).boundingBox();
+			}
+			res.appendBlock(dst);
 		}
+		return res;
+	}
 
+	static BlockList<ViaPointPolygon> toPolygons(const BlockList<ViaPoint> &track)
+	{
+		BlockList<ViaPointPolygon> res;
+		for(int b = 0; b < track.blockCount(); b++)
+		{
+			const QVector<ViaPoint> &src = track.block(b);
+			QVector<ViaPointPolygon> dst(src.count());
+			for(int i = 0; i < src.count(); i++)
+			{
+				dst[i] = ViaPointPolygon::fromBox(src.at(i));
+			}
+			res.appendBlock(dst);
+		}
 		return res;
 	}
 };
@@ -185,6 +348,58 @@ public:
 			index = -1;
 	}
 
+	//scales coordinates from an image of size srcW x srcH to an image of size destW x destH
+	static QPoint imageToImage(int srcW, int srcH, QPoint srcP, int destW, int destH)
+	{
+		QPoint res;
+		double kX, kY;
+
+		kX = (double)destW/(double)srcW;
+		kY = (double)destH/(double)srcH;
+
+		res.setX(ROUND(srcP.x() * kX));
+		res.setY(ROUND(srcP.y() * kY));
+
+		return res;
+	}
+
+	static QRect imageToImage(int srcW, int srcH, QRect srcP, int destW, int destH)
+	{
+		QRect res;
+		QPoint tl = imageToImage(srcW, srcH, srcP.topLeft(), destW, destH);
+		QPoint br = imageToImage(srcW, srcH, srcP.bottomRight(), destW, destH);
+
+		res.setTopLeft(tl);
+		res.setBottomRight(br);
+
+		return res;
+	}
+
+	static QPolygon imageToImage(int srcW, int srcH, QPolygon srcP, int destW, int destH)
+	{
+		QPolygon res;
+		QPoint p;
+		for(int i = 0; i < srcP.count(); i++)
+		{
+			p = imageToImage(srcW, srcH, srcP[i], destW, destH);
+			res << p;
+		}
+
+		return res;
+	}
+
+	static SmallPolygon imageToImage(int srcW, int srcH, const SmallPolygon &srcP, int destW, int destH)
+	{
+		SmallPolygon res;
+		res.reserve(srcP.count());
+		for(int i = 0; i < srcP.count(); i++)
+		{
+			res << imageToImage(srcW, srcH, srcP[i], destW, destH);
+		}
+
+		return res;
+	}
+
 	static void splitPath(QString fullpath, QString &path, QString &filename, QString &ext)
 	{
 		QString fpath = fullpath;
@@ -0,0 +1,68 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <QByteArray>
+
+//CRC-32 of zip and png. Every instance builds its own table, so checksums
+//can be computed on several threads without locking.
+class Crc32
+{
+public:
+	Crc32()
+	{
+		for(quint32 i = 0; i < 256; i++)
+		{
+			quint32 c = i;
+			for(int k = 0; k < 8; k++)
+			{
+				c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+			}
+			mTable[i] = c;
+		}
+	}
+
+	//crc is the checksum of the preceding data when the data comes in pieces
+	quint32 checksum(const char *data, qint64 len, quint32 crc = 0) const
+	{
+		const uchar *p = (const uchar*)data;
+		crc = ~crc;
+		for(qint64 i = 0; i < len; i++)
+		{
+			crc = mTable[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+
+	quint32 checksum(const QByteArray &data, quint32 crc = 0) const
+	{
+		return checksum(data.constData(), data.size(), crc);
+	}
+
+private:
+	quint32 mTable[256];
+};
+
+#endif
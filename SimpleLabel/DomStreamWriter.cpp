@@ -0,0 +1,156 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "DomStreamWriter.h"
+
+DomStreamWriter::DomStreamWriter(QIODevice *device)
+{
+	mOut.setDevice(device);
+	//QDom always saves documents without an xml declaration as UTF-8
+	mOut.setCodec("UTF-8");
+	mStartTagOpen = false;
+}
+
+void DomStreamWriter::writeDocType(const QString &name)
+{
+	mOut << "<!DOCTYPE " << name << ">\n";
+}
+
+void DomStreamWriter::writeStartElement(const QString &name)
+{
+	closeStartTag();
+	mOut << QString(mElements.count(), QLatin1Char(' ')) << '<' << name;
+	mElements << name;
+	mStartTagOpen = true;
+}
+
+void DomStreamWriter::writeAttribute(const QString &name, const QString &value)
+{
+	Attribute a;
+	a.name = name;
+	a.value = value;
+	a.bucket = attributeBucket(name);
+
+	//keep the attributes sorted by bucket, equal buckets in insertion order
+	int i = mAttributes.count();
+	while(i > 0 && mAttributes[i - 1].bucket > a.bucket)
+	{
+		i--;
+	}
+	mAttributes.insert(i, a);
+}
+
+void DomStreamWriter::writeAttribute(const QString &name, int value)
+{
+	writeAttribute(name, QString::number(value));
+}
+
+void DomStreamWriter::writeAttribute(const QString &name, float value)
+{
+	writeAttribute(name, QString::number((double)value, 'g', 6));
+}
+
+void DomStreamWriter::writeEndElement()
+{
+	if(mElements.isEmpty())
+		return;
+
+	QString name = mElements.takeLast();
+	if(mStartTagOpen)
+	{
+		writeAttributes();
+		mOut << "/>\n";
+		mStartTagOpen = false;
+	}
+	else
+	{
+		mOut << QString(mElements.count(), QLatin1Char(' ')) << "</" << name << ">\n";
+	}
+}
+
+bool DomStreamWriter::finish()
+{
+	while(!mElements.isEmpty())
+	{
+		writeEndElement();
+	}
+	mOut.flush();
+	return mOut.status() == QTextStream::Ok;
+}
+
+void DomStreamWriter::writeAttributes()
+{
+	for(int i = 0; i < mAttributes.count(); i++)
+	{
+		mOut << ' ' << mAttributes[i].name << "=\"" << escape(mAttributes[i].value) << '"';
+	}
+	mAttributes.clear();
+}
+
+void DomStreamWriter::closeStartTag()
+{
+	if(mStartTagOpen)
+	{
+		writeAttributes();
+		mOut << ">\n";
+		mStartTagOpen = false;
+	}
+}
+
+QString DomStreamWriter::escape(const QString &value)
+{
+	QString res;
+	res.reserve(value.length());
+	for(int i = 0; i < value.length(); i++)
+	{
+		QChar c = value.at(i);
+		if(c == QLatin1Char('<'))
+			res += QLatin1String("&lt;");
+		else if(c == QLatin1Char('"'))
+			res += QLatin1String("&quot;");
+		else if(c == QLatin1Char('&'))
+			res += QLatin1String("&amp;");
+		else if(c == QLatin1Char('>') && i >= 2 && value.at(i - 1) == QLatin1Char(']') && value.at(i - 2) == QLatin1Char(']'))
+			res += QLatin1String("&gt;");
+		else if(c == QChar(0xA) || c == QChar(0xD) || c == QChar(0x9))
+			res += QLatin1String("&#x") + QString::number(c.unicode(), 16) + QLatin1Char(';');
+		else
+			res += c;
+	}
+	return res;
+}
+
+//QDom keeps the attributes in a QHash, which iterates its buckets in order,
+//so this is the string hash of Qt 4 modulo the initial bucket count.
+int DomStreamWriter::attributeBucket(const QString &name)
+{
+	uint h = 0;
+	const QChar *p = name.unicode();
+	for(int n = name.length(); n > 0; n--)
+	{
+		h = (h << 4) + (*p++).unicode();
+		h ^= (h & 0xf0000000) >> 23;
+		h &= 0x0fffffff;
+	}
+	return h % DOM_HASH_BUCKETS;
+}
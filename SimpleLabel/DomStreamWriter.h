@@ -0,0 +1,81 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef DOMSTREAMWRITER_H
+#define DOMSTREAMWRITER_H
+
+#include <QTextStream>
+#include <QStringList>
+#include <QVector>
+
+//number of hash buckets of a fresh QHash in Qt 4
+#define DOM_HASH_BUCKETS	17
+
+//Streams XML to a device in exactly the layout QDomDocument::save() uses with
+//an indent of 1, so files that used to be built as a QDomDocument can be
+//written element by element in constant memory. Attributes are buffered until
+//the start tag of their element is closed, an element may have up to
+//DOM_HASH_BUCKETS attributes with unique names.
+//
+//QDom writes the attributes in the order of its internal QHash, which is an
+//implementation detail of Qt 4: attributeBucket() copies its string hash and
+//bucket count. Other Qt versions order (or seed) the hash differently, so the
+//output is only byte identical to QDomDocument::toString() where
+//DomStreamWriterTests pass. The XML is valid and equivalent either way.
+class DomStreamWriter
+{
+public:
+	DomStreamWriter(QIODevice *device);
+
+	void writeDocType(const QString &name);
+	void writeStartElement(const QString &name);
+	void writeAttribute(const QString &name, const QString &value);
+	void writeAttribute(const QString &name, int value);
+	void writeAttribute(const QString &name, float value);
+	void writeEndElement();
+	//closes all open elements and flushes the stream, returns false if writing failed
+	bool finish();
+
+	//escapes an attribute value the way QDom does
+	static QString escape(const QString &value);
+	//position of the attribute in QDom's attribute order
+	static int attributeBucket(const QString &name);
+
+private:
+	void writeAttributes();
+	void closeStartTag();
+
+	struct Attribute
+	{
+		QString name;
+		QString value;
+		int bucket;
+	};
+
+	QTextStream mOut;
+	QStringList mElements;
+	QVector<Attribute> mAttributes;
+	bool mStartTagOpen;
+};
+
+#endif
@@ -0,0 +1,301 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "DriftAnalyzer.h"
+#include "GrayImage.h"
+#include <QMetaType>
+#include <QThread>
+
+//analysis is done on images downscaled by this factor from the display image
+#define DRIFT_DOWNSCALE	4
+//frames whose box matches neither via point better than this are suspicious
+#define DRIFT_MIN_SIMILARITY	0.6
+//targets that change a lot between the via points are judged relative to that change
+#define DRIFT_RELATIVE_SIMILARITY	0.8
+//shorter runs of suspicious frames are ignored as noise
+#define DRIFT_MIN_RUN	2
+
+class DriftSegmentJob : public QRunnable
+{
+public:
+	DriftSegmentJob(DriftAnalyzer *analyzer, QSharedPointer<FrameReaderPool> readers, DriftAnalyzer::CancelToken token,
+		QSize displaySize, int row, QString key, QList<ViaPoint> boxes)
+		: mAnalyzer(analyzer), mReaders(readers), mToken(token), mDisplaySize(displaySize), mRow(row), mKey(key), mBoxes(boxes)
+	{
+	}
+
+	virtual void run()
+	{
+		QList<int> frames;
+		if(*mToken == 0)
+		{
+			FrameReader *reader = mReaders->acquire();
+			frames = DriftAnalyzer::analyzeSegment(reader, mDisplaySize, mBoxes, mToken.data());
+			mReaders->release(reader);
+		}
+
+		//always report back, even when cancelled, so the pending counter stays correct
+		QMetaObject::invokeMethod(mAnalyzer, "onSegmentFinished", Qt::QueuedConnection,
+			Q_ARG(int, mRow), Q_ARG(QString, mKey), Q_ARG(QList<int>, frames), Q_ARG(bool, *mToken == 0));
+	}
+
+private:
+	DriftAnalyzer *mAnalyzer;
+	QSharedPointer<FrameReaderPool> mReaders;
+	DriftAnalyzer::CancelToken mToken;
+	QSize mDisplaySize;
+	int mRow;
+	QString mKey;
+	QList<ViaPoint> mBoxes;
+};
+
+//samples the content of the box in its frame, returns false if the frame can't be read
+static bool sampleBox(FrameReader *reader, QSize work, double sx, double sy, const ViaPoint &v, int *out)
+{
+	GrayImage im = reader->readGray(v.frame, work);
+	if(im.isNull())
+		return false;
+
+	im.samplePatch((v.rc.left() + v.rc.width()/2.0)*sx, (v.rc.top() + v.rc.height()/2.0)*sy,
+		v.rc.width()*sx, v.rc.height()*sy, out);
+	return true;
+}
+
+DriftAnalyzer::DriftAnalyzer(QObject *parent)
+	: QObject(parent)
+{
+	qRegisterMetaType<QList<int> >("QList<int>");
+	mPending = 0;
+	mDisplaySize = QSize(W_DISPLAYIMAGE, H_DISPLAYIMAGE);
+	//leave room for the motion tracker, suggestions are not urgent
+	mPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()/2));
+}
+
+DriftAnalyzer::~DriftAnalyzer()
+{
+	cancelAll();
+	mPool.waitForDone();
+}
+
+void DriftAnalyzer::setFrameReader(QSharedPointer<FrameReader> reader)
+{
+	cancelAll();
+	mReaders.clear();
+	if(!reader.isNull() && reader->isValid())
+		mReaders = QSharedPointer<FrameReaderPool>(new FrameReaderPool(reader->fileName(), mPool.maxThreadCount()));
+}
+
+QString DriftAnalyzer::segmentKey(const QList<ViaPoint> &boxes)
+{
+	//motion tracked segments change their inner boxes, so all of them go into the key
+	QVector<int> v;
+	v.reserve(boxes.count()*4);
+	for(int i = 0; i < boxes.count(); i++)
+	{
+		v << boxes[i].rc.left() << boxes[i].rc.top() << boxes[i].rc.width() << boxes[i].rc.height();
+	}
+
+	const ViaPoint &b1 = boxes.first();
+	const ViaPoint &b2 = boxes.last();
+	QString key;
+	key.sprintf("%d:%d,%d,%d,%d|%d:%d,%d,%d,%d|%u",
+		b1.frame, b1.rc.left(), b1.rc.top(), b1.rc.width(), b1.rc.height(),
+		b2.frame, b2.rc.left(), b2.rc.top(), b2.rc.width(), b2.rc.height(),
+		(uint)qChecksum((const char*)v.constData(), v.count()*sizeof(int)));
+	return key;
+}
+
+void DriftAnalyzer::cancel(int row)
+{
+	QHash<int, QHash<QString, CancelToken> >::iterator it = mJobs.find(row);
+	if(it != mJobs.end())
+	{
+		QHash<QString, CancelToken>::iterator j;
+		for(j = it.value().begin(); j != it.value().end(); ++j)
+		{
+			j.value()->fetchAndStoreRelaxed(1);
+		}
+		mJobs.erase(it);
+	}
+
+	if(mCache.remove(row) > 0)
+		emit suggestionsChanged(row);
+}
+
+void DriftAnalyzer::cancelAll()
+{
+	QList<int> rows = mJobs.keys();
+	for(int i = 0; i < rows.count(); i++)
+	{
+		cancel(rows[i]);
+	}
+	mCache.clear();
+}
+
+void DriftAnalyzer::analyze(int row, const QList<ViaPoint> &viaPoints, const BlockList<ViaPoint> &boxes)
+{
+	if(mReaders.isNull() || viaPoints.count() < 2 || boxes.isEmpty())
+	{
+		cancel(row);
+		return;
+	}
+
+	QHash<QString, CancelToken> &jobs = mJobs[row];
+	QHash<QString, QList<int> > &cache = mCache[row];
+	QHash<QString, CancelToken> keepJobs;
+	QHash<QString, QList<int> > keepCache;
+	int first = boxes.first().frame;
+
+	for(int i = 0; i < viaPoints.count() - 1; i++)
+	{
+		int i1 = viaPoints[i].frame - first;
+		int i2 = viaPoints[i + 1].frame - first;
+		//no frames in between to check
+		if(i2 - i1 < 2 || i1 < 0 || i2 >= boxes.count())
+			continue;
+
+		QList<ViaPoint> seg = boxes.mid(i1, i2 - i1 + 1);
+		QString key = segmentKey(seg);
+		if(cache.contains(key))
+		{
+			keepCache.insert(key, cache[key]);
+		}
+		else if(jobs.contains(key))
+		{
+			keepJobs.insert(key, jobs.take(key));
+		}
+		else
+		{
+			CancelToken token(new QAtomicInt(0));
+			keepJobs.insert(key, token);
+			mPending++;
+			mPool.start(new DriftSegmentJob(this, mReaders, token, mDisplaySize, row, key, seg));
+		}
+	}
+
+	//whatever is left belongs to segments that are not part of the track any more
+	QHash<QString, CancelToken>::iterator j;
+	for(j = jobs.begin(); j != jobs.end(); ++j)
+	{
+		j.value()->fetchAndStoreRelaxed(1);
+	}
+	bool changed = keepCache.count() != cache.count();
+	jobs = keepJobs;
+	cache = keepCache;
+	if(changed)
+		emit suggestionsChanged(row);
+}
+
+QList<int> DriftAnalyzer::suggestions(int row) const
+{
+	QList<int> res;
+	QHash<int, QHash<QString, QList<int> > >::const_iterator it = mCache.find(row);
+	if(it != mCache.end())
+	{
+		QHash<QString, QList<int> >::const_iterator j;
+		for(j = it.value().begin(); j != it.value().end(); ++j)
+		{
+			res << j.value();
+		}
+		qSort(res);
+	}
+	return res;
+}
+
+void DriftAnalyzer::onSegmentFinished(int row, QString key, QList<int> frames, bool done)
+{
+	mPending--;
+
+	QHash<int, QHash<QString, CancelToken> >::iterator it = mJobs.find(row);
+	if(it != mJobs.end() && it.value().contains(key))
+	{
+		done = done && *it.value().value(key) == 0;
+		it.value().remove(key);
+		if(done)
+		{
+			mCache[row].insert(key, frames);
+			if(!frames.isEmpty())
+				emit suggestionsChanged(row);
+		}
+	}
+}
+
+QList<int> DriftAnalyzer::analyzeSegment(FrameReader *reader, QSize displaySize, const QList<ViaPoint> &boxes, const QAtomicInt *cancel)
+{
+	QList<int> res;
+	int n = boxes.count() - 1;
+	if(n < 2 || reader == NULL)
+		return res;
+
+	QSize work(qMax(1, displaySize.width()/DRIFT_DOWNSCALE), qMax(1, displaySize.height()/DRIFT_DOWNSCALE));
+	double sx = (double)work.width()/displaySize.width();
+	double sy = (double)work.height()/displaySize.height();
+
+	//the boxes are sampled in frame order so the capture never seeks
+	QVector<int> patches((n + 1)*PATCH_SIZE);
+	QVector<bool> read(n + 1);
+	for(int t = 0; t <= n; t++)
+	{
+		if(cancel && *cancel != 0)
+			return QList<int>();
+		read[t] = sampleBox(reader, work, sx, sy, boxes[t], patches.data() + t*PATCH_SIZE);
+	}
+	if(!read[0] || !read[n])
+		return res;
+	const int *tpl1 = patches.constData();
+	const int *tpl2 = patches.constData() + n*PATCH_SIZE;
+
+	double limit = qMin(DRIFT_MIN_SIMILARITY, DRIFT_RELATIVE_SIMILARITY*GrayImage::patchSimilarity(tpl1, tpl2));
+	int run = 0;
+	int worstFrame = 0;
+	double worst = 1.0;
+
+	for(int t = 1; t <= n; t++)
+	{
+		//the last via point closes the final run
+		double sim = 1.0;
+		if(t < n && read[t])
+		{
+			const int *patch = patches.constData() + t*PATCH_SIZE;
+			sim = qMax(GrayImage::patchSimilarity(tpl1, patch), GrayImage::patchSimilarity(tpl2, patch));
+		}
+
+		if(sim < limit)
+		{
+			if(run == 0 || sim < worst)
+			{
+				worst = sim;
+				worstFrame = boxes[t].frame;
+			}
+			run++;
+		}
+		else
+		{
+			if(run >= DRIFT_MIN_RUN)
+				res << worstFrame;
+			run = 0;
+		}
+	}
+
+	return res;
+}
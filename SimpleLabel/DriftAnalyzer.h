@@ -0,0 +1,94 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef DRIFTANALYZER_H
+#define DRIFTANALYZER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QHash>
+#include "Constants.h"
+#include "FrameReader.h"
+
+//Finds frames where an interpolated rectangle track slides off its target.
+//The content of every interpolated box is compared with the contents of the
+//two via points bracketing it, and the frame with the lowest similarity of
+//every run of poorly matching frames is suggested as a new via point.
+//Segments are analyzed on a thread pool, every worker reads through a capture
+//of its own; results are cached by the segment boxes so unchanged segments
+//are not analyzed again.
+class DriftAnalyzer : public QObject
+{
+	Q_OBJECT
+
+public:
+	DriftAnalyzer(QObject *parent = NULL);
+	virtual ~DriftAnalyzer();
+
+	//drops all pending jobs and suggestions and opens the file of the reader
+	//once for every worker thread
+	void setFrameReader(QSharedPointer<FrameReader> reader);
+	//size of the image the boxes are defined in
+	void setDisplaySize(QSize sz) { mDisplaySize = sz; }
+
+	//Schedules analysis of the segments of the rectangle track in the given row
+	//that were not analyzed yet. Pending jobs for segments that no longer exist
+	//are cancelled and their suggestions dropped.
+	void analyze(int row, const QList<ViaPoint> &viaPoints, const BlockList<ViaPoint> &boxes);
+	void cancel(int row);
+	void cancelAll();
+	int pendingJobs() const { return mPending; }
+
+	//suggested via point frames of the label in the given row, in ascending order
+	QList<int> suggestions(int row) const;
+
+	//boxes hold the whole segment including both via points, its frames are
+	//decoded once, in order
+	static QList<int> analyzeSegment(FrameReader *reader, QSize displaySize, const QList<ViaPoint> &boxes, const QAtomicInt *cancel = NULL);
+
+signals:
+	//emitted in the GUI thread whenever the suggestions of a row change
+	void suggestionsChanged(int row);
+
+private slots:
+	void onSegmentFinished(int row, QString key, QList<int> frames, bool done);
+
+private:
+	friend class DriftSegmentJob;
+	typedef QSharedPointer<QAtomicInt> CancelToken;
+
+	static QString segmentKey(const QList<ViaPoint> &boxes);
+
+	QThreadPool mPool;
+	QSharedPointer<FrameReaderPool> mReaders;
+	QSize mDisplaySize;
+	//all members below are only touched from the GUI thread
+	QHash<int, QHash<QString, CancelToken> > mJobs;
+	QHash<int, QHash<QString, QList<int> > > mCache;
+	int mPending;
+};
+
+#endif
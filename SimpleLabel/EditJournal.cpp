@@ -0,0 +1,785 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "EditJournal.h"
+#include "Track.h"
+#include "Crc32.h"
+#include "FileSync.h"
+#include <QDataStream>
+#include <QSet>
+#include <QtEndian>
+#include <string.h>
+
+//record types
+#define JOURNAL_CREATE			1	//label inserted at a row, with its properties
+#define JOURNAL_DELETE			2
+#define JOURNAL_LABEL			3	//number, name, description, shape and interpolation
+#define JOURNAL_SET_BOX			4	//via point added or moved
+#define JOURNAL_REMOVE_BOX		5
+#define JOURNAL_SET_POLYGON		6
+#define JOURNAL_REMOVE_POLYGON	7
+#define JOURNAL_VIA_BOXES		8	//all via points of a created label
+#define JOURNAL_VIA_POLYGONS	9
+#define JOURNAL_BOXES			10	//run of the dense track of a motion tracked label
+#define JOURNAL_POLYGONS		11
+#define JOURNAL_SAVED			12
+#define JOURNAL_COMMIT			13	//end of a batch, which is replayed whole or not at all
+#define JOURNAL_RECORD_HEADER_SIZE	8
+//a larger record means the size field is damaged
+#define JOURNAL_MAX_RECORD_SIZE	(256*1024*1024)
+
+static QByteArray makeRecord(const Crc32 &crc, const QByteArray &payload)
+{
+	QByteArray rec(JOURNAL_RECORD_HEADER_SIZE, 0);
+	qToLittleEndian<quint32>(payload.size(), (uchar*)rec.data());
+	qToLittleEndian<quint32>(crc.checksum(payload), (uchar*)rec.data() + 4);
+	rec.append(payload);
+	return rec;
+}
+
+static void prepareStream(QDataStream &s)
+{
+	s.setVersion(QDataStream::Qt_4_6);
+	s.setByteOrder(QDataStream::LittleEndian);
+	s.setFloatingPointPrecision(QDataStream::SinglePrecision);
+}
+
+static void writeItem(QDataStream &out, const ViaPoint &v)
+{
+	out << (qint32)v.frame << v.angle << (qint32)v.rc.x() << (qint32)v.rc.y() << (qint32)v.rc.width() << (qint32)v.rc.height();
+}
+
+static void writeItem(QDataStream &out, const ViaPointPolygon &v)
+{
+	out << (qint32)v.frame << (qint32)v.pl.count();
+	for(int k = 0; k < v.pl.count(); k++)
+	{
+		out << (qint32)v.pl[k].x() << (qint32)v.pl[k].y();
+	}
+}
+
+static bool readItem(QDataStream &in, ViaPoint &v)
+{
+	qint32 frame, x, y, w, h;
+	float angle;
+	in >> frame >> angle >> x >> y >> w >> h;
+	v = ViaPoint(frame, angle, QRect(x, y, w, h));
+	return in.status() == QDataStream::Ok;
+}
+
+static bool readItem(QDataStream &in, ViaPointPolygon &v)
+{
+	qint32 frame, points;
+	in >> frame >> points;
+	if(in.status() != QDataStream::Ok || points < 0)
+		return false;
+	v.frame = frame;
+	v.pl.clear();
+	v.pl.reserve(points);
+	for(int k = 0; k < points && in.status() == QDataStream::Ok; k++)
+	{
+		qint32 x, y;
+		in >> x >> y;
+		v.pl << QPoint(x, y);
+	}
+	return in.status() == QDataStream::Ok;
+}
+
+//Appends the records of one batch. Every record is about one row, the
+//payload starts with its type and the row.
+class RecordWriter
+{
+public:
+	RecordWriter(QByteArray &data) : mData(data) {}
+
+	void label(quint8 type, int row, const Label &lb)
+	{
+		QByteArray payload;
+		QDataStream out(&payload, QIODevice::WriteOnly);
+		begin(out, type, row);
+		out << (qint32)lb.number << lb.name << lb.desc << (qint32)lb.shape << (qint32)lb.intr;
+		mData.append(makeRecord(mCrc, payload));
+	}
+
+	void remove(quint8 type, int row, int frame)
+	{
+		QByteArray payload;
+		QDataStream out(&payload, QIODevice::WriteOnly);
+		begin(out, type, row);
+		out << (qint32)frame;
+		mData.append(makeRecord(mCrc, payload));
+	}
+
+	template<class T>
+	void item(quint8 type, int row, const T &v)
+	{
+		QByteArray payload;
+		QDataStream out(&payload, QIODevice::WriteOnly);
+		begin(out, type, row);
+		writeItem(out, v);
+		mData.append(makeRecord(mCrc, payload));
+	}
+
+	template<class List>
+	void run(quint8 type, int row, const List &items)
+	{
+		QByteArray payload;
+		QDataStream out(&payload, QIODevice::WriteOnly);
+		begin(out, type, row);
+		out << (qint32)items.count();
+		for(int i = 0; i < items.count(); i++)
+		{
+			writeItem(out, items.at(i));
+		}
+		mData.append(makeRecord(mCrc, payload));
+	}
+
+	void saved(const QString &project)
+	{
+		QByteArray payload;
+		QDataStream out(&payload, QIODevice::WriteOnly);
+		begin(out, JOURNAL_SAVED, -1);
+		out << project;
+		mData.append(makeRecord(mCrc, payload));
+	}
+
+	void commit()
+	{
+		QByteArray payload;
+		QDataStream out(&payload, QIODevice::WriteOnly);
+		begin(out, JOURNAL_COMMIT, -1);
+		mData.append(makeRecord(mCrc, payload));
+	}
+
+private:
+	static void begin(QDataStream &out, quint8 type, int row)
+	{
+		prepareStream(out);
+		out << type << (qint32)row;
+	}
+
+	QByteArray &mData;
+	Crc32 mCrc;
+};
+
+//records turning the via points a into b, both are in frame order
+template<class List>
+static void diffViaPoints(RecordWriter &rec, int row, const List &a, const List &b, quint8 setType, quint8 removeType)
+{
+	if(a == b)
+		return;
+
+	int i = 0, k = 0;
+	while(i < a.count() || k < b.count())
+	{
+		if(k >= b.count() || (i < a.count() && a.at(i).frame < b.at(k).frame))
+		{
+			rec.remove(removeType, row, a.at(i).frame);
+			i++;
+		}
+		else if(i >= a.count() || b.at(k).frame < a.at(i).frame)
+		{
+			rec.item(setType, row, b.at(k));
+			k++;
+		}
+		else
+		{
+			if(!(a.at(i) == b.at(k)))
+				rec.item(setType, row, b.at(k));
+			i++;
+			k++;
+		}
+	}
+}
+
+//the blocks of the dense track b that a doesn't share, that is the segments
+//tracked or rebuilt since a was written
+template<class T>
+static void diffFrames(RecordWriter &rec, int row, const BlockList<T> &a, const BlockList<T> &b, quint8 type)
+{
+	QSet<const void*> old;
+	for(int k = 0; k < a.blockCount(); k++)
+	{
+		old.insert(a.block(k).constData());
+	}
+	for(int k = 0; k < b.blockCount(); k++)
+	{
+		if(!old.contains(b.block(k).constData()))
+			rec.run(type, row, b.block(k));
+	}
+}
+
+//Records turning the label a into b. Only motion tracked labels journal their
+//dense track, the others are interpolated from the via points on replay.
+static void diffLabel(RecordWriter &rec, int row, const Label &a, const Label &b)
+{
+	if(a.number != b.number || a.name != b.name || a.desc != b.desc || a.shape != b.shape || a.intr != b.intr)
+		rec.label(JOURNAL_LABEL, row, b);
+	diffViaPoints(rec, row, a.viaPoints, b.viaPoints, JOURNAL_SET_BOX, JOURNAL_REMOVE_BOX);
+	diffViaPoints(rec, row, a.viaPointsPoly, b.viaPointsPoly, JOURNAL_SET_POLYGON, JOURNAL_REMOVE_POLYGON);
+	if(b.intr == Motion)
+	{
+		diffFrames(rec, row, a.boxes, b.boxes, JOURNAL_BOXES);
+		diffFrames(rec, row, a.polygons, b.polygons, JOURNAL_POLYGONS);
+	}
+}
+
+static void createLabel(RecordWriter &rec, int row, const Label &lb)
+{
+	rec.label(JOURNAL_CREATE, row, lb);
+	if(!lb.viaPoints.isEmpty())
+		rec.run(JOURNAL_VIA_BOXES, row, lb.viaPoints);
+	if(!lb.viaPointsPoly.isEmpty())
+		rec.run(JOURNAL_VIA_POLYGONS, row, lb.viaPointsPoly);
+	if(lb.intr == Motion)
+	{
+		for(int k = 0; k < lb.boxes.blockCount(); k++)
+		{
+			rec.run(JOURNAL_BOXES, row, lb.boxes.block(k));
+		}
+		for(int k = 0; k < lb.polygons.blockCount(); k++)
+		{
+			rec.run(JOURNAL_POLYGONS, row, lb.polygons.block(k));
+		}
+	}
+}
+
+template<class List>
+static bool readRun(QDataStream &in, List &items)
+{
+	qint32 count;
+	in >> count;
+	if(in.status() != QDataStream::Ok || count < 0)
+		return false;
+	for(int i = 0; i < count; i++)
+	{
+		typename List::value_type v;
+		if(!readItem(in, v))
+			return false;
+		items.append(v);
+	}
+	return true;
+}
+
+//the run replaces frames of the dense track, which the via points already span
+template<class T>
+static bool applyRun(QDataStream &in, BlockList<T> &track)
+{
+	QVector<T> items;
+	if(!readRun(in, items))
+		return false;
+	for(int i = 0; i < items.count(); i++)
+	{
+		int k = track.isEmpty() ? -1 : items.at(i).frame - track.first().frame;
+		if(k < 0 || k >= track.count())
+			return false;
+		track.replace(k, items.at(i));
+	}
+	return true;
+}
+
+//The via point records of a label come one after the other, its tracks are
+//rebuilt once after the last of them. The editor rebuilds after every via
+//point, which ends with the same tracks: a segment keeps its block when its
+//via points are unchanged in both cases, and the tracked segments that
+//changed follow as runs.
+struct StaleTracks
+{
+	StaleTracks() : row(-1), boxes(false), polygons(false) {}
+
+	void rebuild(QList<Label> &labels)
+	{
+		if(row >= 0 && row < labels.count())
+		{
+			if(boxes)
+				Track<RectShape>(labels[row]).rebuild();
+			if(polygons)
+				Track<PolygonShape>(labels[row]).rebuild();
+		}
+		row = -1;
+		boxes = false;
+		polygons = false;
+	}
+
+	int row;
+	bool boxes;
+	bool polygons;
+};
+
+static bool isViaPointRecord(quint8 type)
+{
+	return type == JOURNAL_SET_BOX || type == JOURNAL_REMOVE_BOX || type == JOURNAL_VIA_BOXES ||
+		type == JOURNAL_SET_POLYGON || type == JOURNAL_REMOVE_POLYGON || type == JOURNAL_VIA_POLYGONS;
+}
+
+//applies one record to the labels, they are left as they were if the record
+//can't be applied
+static bool applyRecord(const QByteArray &payload, QList<Label> &labels, bool &unsaved, StaleTracks &stale, bool &commit)
+{
+	QDataStream in(payload);
+	prepareStream(in);
+	quint8 type;
+	qint32 row;
+	in >> type >> row;
+	if(in.status() != QDataStream::Ok)
+		return false;
+
+	if(!isViaPointRecord(type) || row != stale.row)
+		stale.rebuild(labels);
+
+	commit = type == JOURNAL_COMMIT;
+	if(type == JOURNAL_COMMIT)
+		return true;
+	if(type == JOURNAL_SAVED)
+	{
+		unsaved = false;
+		return true;
+	}
+	if(row < 0 || row > labels.count() || (type != JOURNAL_CREATE && row == labels.count()))
+		return false;
+
+	if(type == JOURNAL_CREATE || type == JOURNAL_LABEL)
+	{
+		qint32 number, shape, intr;
+		Label lb = type == JOURNAL_LABEL ? labels.at(row) : Label();
+		in >> number >> lb.name >> lb.desc >> shape >> intr;
+		if(in.status() != QDataStream::Ok)
+			return false;
+		//a new shape or interpolation starts the dense tracks over, as in the editor
+		if(lb.shape != shape || lb.intr != intr)
+		{
+			lb.boxes.clear();
+			lb.polygons.clear();
+			Track<RectShape>(lb).rebuild();
+			Track<PolygonShape>(lb).rebuild();
+		}
+		lb.number = number;
+		lb.shape = (LabelShape)shape;
+		lb.intr = (InterpolationMethod)intr;
+		if(type == JOURNAL_CREATE)
+			labels.insert(row, lb);
+		else
+			labels[row] = lb;
+	}
+	else if(type == JOURNAL_DELETE)
+	{
+		labels.removeAt(row);
+	}
+	else if(type == JOURNAL_SET_BOX)
+	{
+		ViaPoint v;
+		if(!readItem(in, v))
+			return false;
+		Track<RectShape>(labels[row]).addViaPoint(v);
+		stale.boxes = true;
+	}
+	else if(type == JOURNAL_SET_POLYGON)
+	{
+		ViaPointPolygon v;
+		if(!readItem(in, v))
+			return false;
+		Track<PolygonShape>(labels[row]).addViaPoint(v);
+		stale.polygons = true;
+	}
+	else if(type == JOURNAL_REMOVE_BOX || type == JOURNAL_REMOVE_POLYGON)
+	{
+		qint32 frame;
+		in >> frame;
+		if(in.status() != QDataStream::Ok)
+			return false;
+		if(type == JOURNAL_REMOVE_BOX ? !Track<RectShape>(labels[row]).removeViaPoint(frame) :
+			!Track<PolygonShape>(labels[row]).removeViaPoint(frame))
+			return false;
+		stale.boxes = stale.boxes || type == JOURNAL_REMOVE_BOX;
+		stale.polygons = stale.polygons || type == JOURNAL_REMOVE_POLYGON;
+	}
+	else if(type == JOURNAL_VIA_BOXES)
+	{
+		QList<ViaPoint> via;
+		if(!readRun(in, via))
+			return false;
+		labels[row].viaPoints = via;
+		stale.boxes = true;
+	}
+	else if(type == JOURNAL_VIA_POLYGONS)
+	{
+		QVector<ViaPointPolygon> via;
+		if(!readRun(in, via))
+			return false;
+		labels[row].viaPointsPoly = via;
+		stale.polygons = true;
+	}
+	else if(type == JOURNAL_BOXES)
+	{
+		Label lb = labels.at(row);
+		if(!applyRun(in, lb.boxes))
+			return false;
+		labels[row] = lb;
+	}
+	else if(type == JOURNAL_POLYGONS)
+	{
+		Label lb = labels.at(row);
+		if(!applyRun(in, lb.polygons))
+			return false;
+		labels[row] = lb;
+	}
+	else
+	{
+		return false;
+	}
+	if(isViaPointRecord(type))
+		stale.row = row;
+	unsaved = true;
+	return true;
+}
+
+static QByteArray journalHeader()
+{
+	QByteArray header(JOURNAL_HEADER_SIZE, 0);
+	memcpy(header.data(), JOURNAL_MAGIC, 8);
+	qToLittleEndian<quint32>(JOURNAL_VERSION, (uchar*)header.data() + 8);
+	return header;
+}
+
+EditJournal::EditJournal(QObject *parent)
+	: QThread(parent), mOpen(false), mStop(false), mPending(false), mPendingEdit(false),
+	mPendingSaved(false), mSaved(true), mCompactedSize(0)
+{
+}
+
+EditJournal::~EditJournal()
+{
+	close();
+}
+
+bool EditJournal::replay(const QString &file, QList<Label> &labels, bool &unsaved, qint64 *validSize)
+{
+	labels.clear();
+	unsaved = false;
+	if(validSize)
+		*validSize = 0;
+
+	QFile fd(file);
+	if(!fd.open(QIODevice::ReadOnly))
+		return false;
+
+	//the journal was created but its header never reached the disk
+	QByteArray header = fd.read(JOURNAL_HEADER_SIZE);
+	if(header.size() < JOURNAL_HEADER_SIZE)
+		return true;
+	if(memcmp(header.constData(), JOURNAL_MAGIC, 8) != 0 ||
+		qFromLittleEndian<quint32>((const uchar*)header.constData() + 8) != JOURNAL_VERSION)
+		return false;
+
+	//the records of a batch are applied to a copy, which is taken over at the
+	//end of the batch, so a batch torn by a crash is dropped whole
+	Crc32 crc;
+	StaleTracks stale;
+	QList<Label> batch;
+	bool batchUnsaved = false;
+	qint64 read = JOURNAL_HEADER_SIZE;
+	qint64 valid = JOURNAL_HEADER_SIZE;
+	for(;;)
+	{
+		QByteArray rec = fd.read(JOURNAL_RECORD_HEADER_SIZE);
+		if(rec.size() != JOURNAL_RECORD_HEADER_SIZE)
+			break;
+		quint32 size = qFromLittleEndian<quint32>((const uchar*)rec.constData());
+		quint32 sum = qFromLittleEndian<quint32>((const uchar*)rec.constData() + 4);
+		if(size > JOURNAL_MAX_RECORD_SIZE)
+			break;
+		QByteArray payload = fd.read(size);
+		if((quint32)payload.size() != size || crc.checksum(payload) != sum)
+			break;
+
+		bool commit = false;
+		if(!applyRecord(payload, batch, batchUnsaved, stale, commit))
+			break;
+		read += JOURNAL_RECORD_HEADER_SIZE + size;
+		if(commit)
+		{
+			labels = batch;
+			unsaved = batchUnsaved;
+			valid = read;
+		}
+	}
+
+	if(validSize)
+		*validSize = valid;
+	return true;
+}
+
+bool EditJournal::open(const QString &file, QList<Label> &labels, bool &unsaved)
+{
+	close();
+	mError = "";
+	labels.clear();
+	unsaved = false;
+
+	//the compaction replaces the journal in one step, a crash during it only
+	//leaves the unfinished compacted journal behind
+	QFile::remove(file + ".tmp");
+
+	qint64 valid = 0;
+	if(QFile::exists(file) && !replay(file, labels, unsaved, &valid))
+	{
+		mError = file + " is not a SimpleLabel journal.";
+		return false;
+	}
+
+	mFile.setFileName(file);
+	if(!mFile.open(QIODevice::ReadWrite))
+	{
+		mError = mFile.errorString();
+		return false;
+	}
+	//drops the damaged tail, or starts a new journal
+	bool ok;
+	if(valid > 0)
+		ok = mFile.resize(valid) && mFile.seek(valid);
+	else
+		ok = mFile.resize(0) && writeAndSync(mFile, journalHeader());
+	if(!ok)
+	{
+		mError = mFile.errorString();
+		mFile.close();
+		return false;
+	}
+
+	mWritten = labels;
+	mSaved = !unsaved;
+	mProject = "";
+	//a large journal left by the last session is compacted on the first write
+	mCompactedSize = 0;
+	mPending = false;
+	mPendingEdit = false;
+	mPendingSaved = false;
+	mStop = false;
+	mOpen = true;
+	start(QThread::LowPriority);
+	return true;
+}
+
+void EditJournal::close()
+{
+	if(!mOpen)
+		return;
+
+	mMutex.lock();
+	mStop = true;
+	mWake.wakeAll();
+	mMutex.unlock();
+	wait();
+
+	mFile.close();
+	mPendingLabels.clear();
+	mPendingSavedLabels.clear();
+	mWritten.clear();
+	mOpen = false;
+}
+
+void EditJournal::record(const QList<Label> &labels)
+{
+	if(!mOpen)
+		return;
+
+	QMutexLocker lock(&mMutex);
+	mPendingLabels = labels;
+	mPendingEdit = true;
+	mPending = true;
+	mWake.wakeAll();
+}
+
+void EditJournal::markSaved(const QList<Label> &labels, const QString &project)
+{
+	if(!mOpen)
+		return;
+
+	//the saved labels supersede the edits recorded before, an edit recorded
+	//after them is written after the mark
+	QMutexLocker lock(&mMutex);
+	mPendingSavedLabels = labels;
+	mPendingSaved = true;
+	mPendingProject = project;
+	mPendingEdit = false;
+	mPendingLabels.clear();
+	mPending = true;
+	mWake.wakeAll();
+}
+
+QString EditJournal::errorString() const
+{
+	QMutexLocker lock(&mMutex);
+	return mError;
+}
+
+void EditJournal::setError(const QString &error)
+{
+	QMutexLocker lock(&mMutex);
+	mError = error;
+}
+
+//only the latest state is written, the edits that came in while the previous
+//write was syncing are folded into one batch
+void EditJournal::run()
+{
+	for(;;)
+	{
+		mMutex.lock();
+		while(!mPending && !mStop)
+		{
+			mWake.wait(&mMutex);
+		}
+		if(!mPending)
+		{
+			mMutex.unlock();
+			break;
+		}
+		QList<Label> labels = mPendingLabels;
+		QList<Label> savedLabels = mPendingSavedLabels;
+		bool edit = mPendingEdit;
+		bool saved = mPendingSaved;
+		QString project = mPendingProject;
+		mPending = false;
+		mPendingEdit = false;
+		mPendingSaved = false;
+		mPendingLabels.clear();
+		mPendingSavedLabels.clear();
+		mMutex.unlock();
+
+		if((saved && !appendChanges(savedLabels, true, project)) || (edit && !appendChanges(labels, false, project)))
+		{
+			emit failed(errorString());
+			break;
+		}
+
+		if(mFile.size() > JOURNAL_COMPACT_SIZE && mFile.size() > JOURNAL_COMPACT_RATIO * mCompactedSize && !compact())
+		{
+			emit failed(errorString());
+			break;
+		}
+	}
+}
+
+//Appends the operations that turn the written labels into these. The editor
+//inserts or deletes one label per step, so the rows are aligned by skipping a
+//label that has no equal on the other side, and the aligned labels that
+//differ are diffed by their properties, via points and tracked segments.
+bool EditJournal::appendChanges(const QList<Label> &labels, bool saved, const QString &project)
+{
+	QByteArray data;
+	RecordWriter rec(data);
+	//the rows of the replayed list are labels[0, k) followed by mWritten[i, end)
+	int i = 0, k = 0;
+	while(i < mWritten.count() || k < labels.count())
+	{
+		int oldRows = mWritten.count() - i;
+		int newRows = labels.count() - k;
+		if(oldRows > 0 && newRows > 0 && mWritten.at(i) == labels.at(k))
+		{
+			i++;
+			k++;
+		}
+		else if(newRows == 0 || (oldRows > newRows && mWritten.at(i + 1) == labels.at(k)))
+		{
+			rec.remove(JOURNAL_DELETE, k, -1);
+			i++;
+		}
+		else if(oldRows == 0 || (newRows > oldRows && mWritten.at(i) == labels.at(k + 1)))
+		{
+			createLabel(rec, k, labels.at(k));
+			k++;
+		}
+		else
+		{
+			diffLabel(rec, k, mWritten.at(i), labels.at(k));
+			i++;
+			k++;
+		}
+	}
+
+	if(saved)
+	{
+		if(!mSaved || project != mProject || !data.isEmpty())
+			rec.saved(project);
+		mProject = project;
+	}
+	mSaved = saved || (mSaved && data.isEmpty());
+	mWritten = labels;
+
+	if(data.isEmpty())
+		return true;
+	rec.commit();
+	return writeAndSync(mFile, data);
+}
+
+//writes every label once into a new journal and replaces the old one with it
+bool EditJournal::compact()
+{
+	QByteArray data = journalHeader();
+	RecordWriter rec(data);
+	for(int i = 0; i < mWritten.count(); i++)
+	{
+		createLabel(rec, i, mWritten.at(i));
+	}
+	if(mSaved)
+		rec.saved(mProject);
+	rec.commit();
+
+	QString file = mFile.fileName();
+	QFile tmp(file + ".tmp");
+	if(!tmp.open(QIODevice::WriteOnly | QIODevice::Truncate) || !writeAndSync(tmp, data))
+	{
+		setError(tmp.errorString());
+		tmp.close();
+		tmp.remove();
+		return false;
+	}
+	tmp.close();
+
+	mFile.close();
+	if(!FileSync::replace(tmp.fileName(), file))
+	{
+		setError("Failed to replace " + file);
+		return false;
+	}
+	mFile.setFileName(file);
+	if(!mFile.open(QIODevice::ReadWrite) || !mFile.seek(mFile.size()))
+	{
+		setError(mFile.errorString());
+		return false;
+	}
+
+	mCompactedSize = data.size();
+	return true;
+}
+
+bool EditJournal::writeAndSync(QFile &fd, const QByteArray &data)
+{
+	if(fd.write(data) != data.size() || !FileSync::sync(fd))
+	{
+		setError(fd.errorString());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,127 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFile>
+#include <QList>
+#include <QString>
+#include "Constants.h"
+
+#define JOURNAL_MAGIC			"SLJRNL\r\n"
+#define JOURNAL_VERSION			2
+#define JOURNAL_HEADER_SIZE		16
+//the journal is compacted once it is larger than this and than
+//JOURNAL_COMPACT_RATIO times its size after the last compaction
+#define JOURNAL_COMPACT_SIZE	(4*1024*1024)
+#define JOURNAL_COMPACT_RATIO	4
+
+//Append-only journal of the label edits, used as a crash-safe autosave. The
+//GUI thread only hands over the current labels, which are implicitly shared,
+//so recording an edit never waits for the disk. The writer thread diffs them
+//against the labels it wrote last, appends the operations in between and
+//syncs the file once for all edits that came in meanwhile. Moving a via point
+//of a long track writes that via point, not the track.
+//
+//	header		magic, version
+//	records		size and crc of the payload, the payload: the operation and
+//				its row, one of
+//				a label created, deleted, or its properties changed,
+//				a via point set (added or moved) or removed,
+//				a run of motion tracked frames,
+//				a mark that the labels were saved,
+//				the end of the batch written at once
+//
+//Replaying applies the operations the way the editor does, the tracks of a
+//label are rebuilt from its via points after its via point records. When the
+//journal grows too large the writer replaces it in the background by a
+//compacted one that creates every label once. Replaying stops at the first
+//damaged record and drops the batch it is in, so a crash only loses the last
+//edits.
+class EditJournal : public QThread
+{
+	Q_OBJECT
+
+public:
+	EditJournal(QObject *parent = NULL);
+	virtual ~EditJournal();
+
+	//Replays the journal in file, if there is one, into labels and starts
+	//appending to it. unsaved tells if labels were edited after they were
+	//last saved.
+	bool open(const QString &file, QList<Label> &labels, bool &unsaved);
+	//writes the pending edits and stops the writer
+	void close();
+	bool isOpen() const { return mOpen; }
+	QString fileName() const { return mFile.fileName(); }
+
+	//the labels become the state to be journaled
+	void record(const QList<Label> &labels);
+	//the labels were saved, in the project or in a SimpleLabel XML file
+	void markSaved(const QList<Label> &labels, const QString &project);
+
+	//reads a journal without opening it for writing, validSize is the size up
+	//to the last good record
+	static bool replay(const QString &file, QList<Label> &labels, bool &unsaved, qint64 *validSize = NULL);
+
+	QString errorString() const;
+
+signals:
+	//writing the journal failed, nothing more is written
+	void failed(QString error);
+
+protected:
+	virtual void run();
+
+private:
+	bool appendChanges(const QList<Label> &labels, bool saved, const QString &project);
+	bool compact();
+	bool writeAndSync(QFile &fd, const QByteArray &data);
+	void setError(const QString &error);
+
+	mutable QMutex mMutex;
+	QWaitCondition mWake;
+	bool mOpen;
+	bool mStop;
+	//state handed over by the GUI thread and not written yet
+	bool mPending;
+	bool mPendingEdit;
+	QList<Label> mPendingLabels;
+	bool mPendingSaved;
+	QList<Label> mPendingSavedLabels;
+	QString mPendingProject;
+
+	//owned by the writer thread while it runs
+	QFile mFile;
+	QList<Label> mWritten;
+	bool mSaved;
+	QString mProject;
+	qint64 mCompactedSize;
+	QString mError;
+};
+
+#endif
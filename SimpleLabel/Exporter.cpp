@@ -0,0 +1,2172 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "Exporter.h"
+#include "BoxTrack.h"
+#include "LabelSpanIndex.h"
+#include "Monitor.h"
+#include "DomStreamWriter.h"
+#include "BoundedQueue.h"
+#include "LabelMask.h"
+#include "NpzWriter.h"
+#include "MatWriter.h"
+#include <QPainter>
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
+#include <QDomDocument>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QMap>
+#include <QSemaphore>
+#include <QThread>
+#include <QImageWriter>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QProcess>
+#include <QtEndian>
+
+class ExportJob : public QRunnable, public ExportControl
+{
+public:
+	ExportJob(Exporter *exporter, Exporter::CancelToken token, const ExportSettings &settings,
+		const LabelSnapshot &labels, const QList<QSharedPointer<FrameReader> > &readers, const QList<CvVideoWriter*> &writers)
+		: ExportControl(token.data()), mExporter(exporter), mToken(token), mSettings(settings),
+		mLabels(labels), mReaders(readers), mWriters(writers)
+	{
+	}
+
+	virtual void run()
+	{
+		mTimer.start();
+		QList<FrameReader*> readers;
+		for(int i = 0; i < mReaders.count(); i++)
+		{
+			readers << mReaders[i].data();
+		}
+		bool ok = Exporter::run(mSettings, mLabels, readers, mWriters, *this);
+		for(int i = 0; i < mWriters.count(); i++)
+		{
+			if(mWriters[i])
+				cvReleaseVideoWriter(&mWriters[i]);
+		}
+
+		QString msg = error;
+		if(isCancelled())
+			msg = "Export cancelled.";
+		else if(ok)
+			msg = summary.isEmpty() ? QString("Export finished.") : summary;
+		QMetaObject::invokeMethod(mExporter, "onFinished", Qt::QueuedConnection, Q_ARG(bool, ok && !isCancelled()), Q_ARG(QString, msg));
+	}
+
+	virtual void progress(int done, int total)
+	{
+		//don't flood the GUI thread with events
+		if(done < total && mTimer.elapsed() < EXPORT_PROGRESS_INTERVAL)
+			return;
+
+		mTimer.restart();
+		QMetaObject::invokeMethod(mExporter, "onProgress", Qt::QueuedConnection, Q_ARG(int, done), Q_ARG(int, total));
+	}
+
+private:
+	Exporter *mExporter;
+	Exporter::CancelToken mToken;
+	ExportSettings mSettings;
+	LabelSnapshot mLabels;
+	QList<QSharedPointer<FrameReader> > mReaders;
+	QList<CvVideoWriter*> mWriters;
+	QTime mTimer;
+};
+
+//Frames written by the frame pool of the LabelMe export. Frames finish in any
+//order, next is the first frame that isn't written yet, so progress is only
+//reported for the frames without a gap before them. Runs of frames that are
+//up to date are skipped at once.
+struct FrameCompletion
+{
+	FrameCompletion(int first) : inFlight(0), next(first), failed(-1) {}
+
+	void finish(int frame, bool ok)
+	{
+		QMutexLocker lock(&mutex);
+		inFlight--;
+		if(!ok && (failed < 0 || frame < failed))
+			failed = frame;
+		done(frame, frame);
+		changed.wakeAll();
+	}
+
+	void skip(int first, int last)
+	{
+		QMutexLocker lock(&mutex);
+		done(first, last);
+	}
+
+	//the mutex is locked
+	void done(int first, int last)
+	{
+		written.insert(first, last);
+		while(written.contains(next))
+		{
+			next = written.take(next) + 1;
+		}
+	}
+
+	QMutex mutex;
+	QWaitCondition changed;
+	QMap<int, int> written;	//runs of frames written after a gap, first to last frame
+	int inFlight;
+	int next;
+	int failed;			//first frame that couldn't be written, -1 if none
+};
+
+//Opens the archive of a per frame export that writes into one. Only an
+//archive that is appended to still holds the frames that didn't change, a new
+//one needs all frames.
+static bool openArchive(const ExportSettings &settings, TarWriter &tar, FrameRangeSet &frames, ExportControl &ctl)
+{
+	if(!settings.archive || !Exporter::writesFilePerFrame(settings.format, settings.saveAsAvi))
+		return true;
+
+	QString file = Exporter::archiveFile(settings);
+	if(!tar.open(file, settings.changedOnly))
+	{
+		ctl.error = "Failed to create " + file + "\n" + tar.errorString();
+		return false;
+	}
+	if(!tar.isAppending())
+		frames = FrameRangeSet(settings.firstFrame, settings.lastFrame);
+	return true;
+}
+
+//writes the end and the index of the archive, if there is one
+static bool finishArchive(TarWriter &tar, ExportControl &ctl)
+{
+	if(tar.isOpen() && !tar.finish())
+	{
+		if(ctl.error.isEmpty())
+			ctl.error = "Failed to write the archive.\n" + tar.errorString();
+		return false;
+	}
+	return true;
+}
+
+class LabelMeFrameJob : public QRunnable
+{
+public:
+	LabelMeFrameJob(const ExportSettings &settings, const LabelSnapshot &labels, const QList<int> &rows,
+		const QString &path, int frame, TarWriter *archive, FrameCompletion *completion)
+		: mSettings(settings), mLabels(labels), mRows(rows), mPath(path), mFrame(frame), mArchive(archive), mCompletion(completion)
+	{
+	}
+
+	virtual void run()
+	{
+		bool ok = Exporter::exportFrameToLabelMeXML(mSettings, mLabels, mRows, mPath, mFrame, mArchive);
+		mCompletion->finish(mFrame, ok);
+	}
+
+private:
+	ExportSettings mSettings;
+	LabelSnapshot mLabels;
+	QList<int> mRows;
+	QString mPath;
+	int mFrame;
+	TarWriter *mArchive;
+	FrameCompletion *mCompletion;
+};
+
+//frame travelling through the stages of the movie export
+struct MovieFrame
+{
+	MovieFrame() : frame(-1), bytes(0) {}
+
+	int frame;
+	QImage image;		//dropped once the frame is saved as an image file
+	QList<int> rows;	//labels present in the frame
+	QString error;		//the frame couldn't be read or saved
+	qint64 bytes;		//size of the saved image file
+};
+
+//QImageWriter settings of the image sequence formats
+static void imageWriterOptions(ImageSequenceFormat format, QByteArray &name, int &quality, int &compression)
+{
+	quality = -1;
+	compression = -1;
+	switch(format)
+	{
+	case ImagePngSmall:
+		name = "PNG";
+		quality = 0;		//zlib level 9
+		break;
+	case ImageTiff:
+		name = "TIFF";
+		compression = 1;	//LZW
+		break;
+	case ImageBmp:
+		name = "BMP";
+		break;
+	case ImagePngFast:
+	default:
+		name = "PNG";
+		quality = 89;		//zlib level 1
+		break;
+	}
+}
+
+//shared by the stages of one movie export
+struct MoviePipeline
+{
+	MoviePipeline(int depth) : decoded(depth), rendered(depth), room(depth), stop(0) {}
+
+	BoundedQueue<MovieFrame> decoded;
+	BoundedQueue<MovieFrame> rendered;
+	QSemaphore room;	//frames that may still enter the pipeline, released by the encoder
+	QSemaphore done;	//released by every stage that returned, the pool may run other exports too
+	QAtomicInt stop;
+};
+
+//reads the frames in order, the original images are decoded here
+class MovieDecodeJob : public QRunnable
+{
+public:
+	MovieDecodeJob(MoviePipeline *pipe, const ExportSettings &settings, const FrameRangeSet &frames, const LabelSpanIndex *spans, FrameReader *reader)
+		: mPipe(pipe), mSettings(settings), mSpans(spans), mReader(reader), mFrames(frames)
+	{
+	}
+
+	virtual void run()
+	{
+		bool origBkgrd = mSettings.format == ExportOriginalImages;
+		for(int t = mSettings.firstFrame; t <= mSettings.lastFrame; t++)
+		{
+			if(!mFrames.contains(t))
+				continue;
+			mPipe->room.acquire();
+			if(mPipe->stop != 0)
+				break;
+
+			MovieFrame f;
+			f.frame = t;
+			f.rows = mSpans->labelsAt(t);
+			if(origBkgrd)
+				f.image = mReader->read(t);
+			else
+				f.image = QImage(mSettings.imageSize, QImage::Format_ARGB32);
+			if(f.image.isNull())
+				f.error = QString("Failed to read frame %1.").arg(t);
+
+			if(!mPipe->decoded.push(f))
+				break;
+		}
+		mPipe->decoded.close();
+		mPipe->done.release();
+	}
+
+private:
+	MoviePipeline *mPipe;
+	ExportSettings mSettings;
+	const LabelSpanIndex *mSpans;
+	FrameReader *mReader;
+	FrameRangeSet mFrames;
+};
+
+//draws the labels over the decoded frames and compresses the image files,
+//several of these run in parallel
+class MovieRenderJob : public QRunnable
+{
+public:
+	MovieRenderJob(MoviePipeline *pipe, const ExportSettings &settings, const LabelSnapshot &labels, TarWriter *archive)
+		: mPipe(pipe), mSettings(settings), mLabels(labels), mArchive(archive)
+	{
+		QString fname;
+		int index;
+		CommonFunctions::splitPath(settings.saveFile, mPath, fname, mPrefix, (uint)5, index, mExt);
+		imageWriterOptions(settings.imageFormat, mFormat, mQuality, mCompression);
+	}
+
+	virtual void run()
+	{
+		MovieFrame f;
+		while(mPipe->decoded.pop(f))
+		{
+			if(f.error.isEmpty())
+			{
+				render(f);
+				//image files don't depend on each other, only avi frames are encoded in order
+				if(!mSettings.saveAsAvi)
+					save(f);
+			}
+			if(!mPipe->rendered.push(f))
+				break;
+		}
+		mPipe->done.release();
+	}
+
+private:
+	void save(MovieFrame &f)
+	{
+		QString sv;
+		sv = mPath + mPrefix + sv.sprintf("%05d", f.frame) + mExt;
+
+		QByteArray data;
+		QBuffer buf(&data);
+		QImageWriter writer;
+		if(mArchive != NULL)
+		{
+			buf.open(QIODevice::WriteOnly);
+			writer.setDevice(&buf);
+		}
+		else
+		{
+			writer.setFileName(sv);
+		}
+		writer.setFormat(mFormat);
+		writer.setQuality(mQuality);
+		writer.setCompression(mCompression);
+
+		if(!writer.write(f.image))
+			f.error = "Failed to write " + sv;
+		else if(mArchive == NULL)
+			f.bytes = QFileInfo(sv).size();
+		else if(mArchive->addFile(QFileInfo(sv).fileName(), data))
+			f.bytes = data.size();
+		else
+			f.error = "Failed to write " + sv + " into the archive";
+		f.image = QImage();
+	}
+
+	void render(MovieFrame &f)
+	{
+		QSize origSz = mSettings.imageSize;
+		QSize dispSz = mSettings.displaySize;
+		QBrush br(QColor::fromRgb(200, 200, 200, 128));
+		QImage &im = f.image;
+
+		bool origBkgrd = mSettings.format == ExportOriginalImages;
+		if(origBkgrd && im.format() != QImage::Format_ARGB32)
+			im = im.convertToFormat(QImage::Format_ARGB32);
+
+		QPainter pt;
+		pt.begin(&im);
+		if(!origBkgrd)
+		{
+			pt.fillRect(im.rect(), Qt::black);
+		}
+		for(int a = 0; a < f.rows.count(); a++)
+		{
+			const Label &lb = mLabels[f.rows[a]];
+			if(lb.shape == Rect)
+			{
+				const ViaPoint *bx = lb.findBoxByFrame(f.frame);
+				if(bx != NULL)
+				{
+					QRect rt = CommonFunctions::imageToImage(dispSz.width(), dispSz.height(), bx->rc, origSz.width(), origSz.height());
+					pt.fillRect(rt, br);
+				}
+			}
+			else if(lb.shape == Polyg)
+			{
+				const ViaPointPolygon *polyg = lb.findPolygonByFrame(f.frame);
+				if(polyg != NULL)
+				{
+					pt.setBrush(br);
+					SmallPolygon pl = CommonFunctions::imageToImage(dispSz.width(), dispSz.height(), polyg->pl, origSz.width(), origSz.height());
+					pt.drawPolygon(pl.constData(), pl.count());
+				}
+			}
+		}
+		pt.end();
+	}
+
+	MoviePipeline *mPipe;
+	ExportSettings mSettings;
+	LabelSnapshot mLabels;
+	TarWriter *mArchive;
+	QString mPath;
+	QString mPrefix;
+	QString mExt;
+	QByteArray mFormat;
+	int mQuality;
+	int mCompression;
+};
+
+//number of avi segments the export is split into
+static int segmentCount(const ExportSettings &settings)
+{
+	return qBound(1, settings.segments, qMax(settings.lastFrame - settings.firstFrame + 1, 1));
+}
+
+//sums up the progress of the segments of a segmented avi export
+class SegmentProgress
+{
+public:
+	SegmentProgress(ExportControl &ctl, int segments, int total) : mCtl(ctl), mDone(segments, 0), mTotal(total) {}
+
+	void report(int segment, int done)
+	{
+		QMutexLocker lock(&mMutex);
+		mDone[segment] = done;
+		int sum = 0;
+		for(int i = 0; i < mDone.count(); i++)
+		{
+			sum += mDone[i];
+		}
+		mCtl.progress(sum, mTotal);
+	}
+
+private:
+	QMutex mMutex;
+	ExportControl &mCtl;
+	QVector<int> mDone;
+	int mTotal;
+};
+
+class MovieSegmentJob : public QRunnable, public ExportControl
+{
+public:
+	MovieSegmentJob(const ExportSettings &settings, const LabelSnapshot &labels, FrameReader *reader, CvVideoWriter *writer,
+		const QAtomicInt *cancel, SegmentProgress *progress, int segment, QThreadPool *stages, int renderers)
+		: ExportControl(cancel), ok(false), mSettings(settings), mLabels(labels), mReader(reader),
+		mWriter(writer), mProgress(progress), mSegment(segment), mStages(stages), mRenderers(renderers)
+	{
+		setAutoDelete(false);
+	}
+
+	virtual void run()
+	{
+		ok = Exporter::exportMovie(mSettings, mLabels, mReader, mWriter, *this, mStages, mRenderers);
+	}
+
+	virtual void progress(int done, int total)
+	{
+		Q_UNUSED(total);
+		mProgress->report(mSegment, done);
+	}
+
+	bool ok;
+
+private:
+	ExportSettings mSettings;
+	LabelSnapshot mLabels;
+	FrameReader *mReader;
+	CvVideoWriter *mWriter;
+	SegmentProgress *mProgress;
+	int mSegment;
+	QThreadPool *mStages;
+	int mRenderers;
+};
+
+//Mask id of every label row, 0 is the background. Instance masks number the
+//labels in row order, semantic masks number the distinct names in sorted
+//order. The legend lists the ids for the text file written with the masks.
+static QVector<quint16> maskIds(const ExportSettings &settings, const LabelSnapshot &labels, QStringList &legend, int &maxId)
+{
+	QVector<quint16> ids(labels.count());
+	maxId = 0;
+	if(settings.format == ExportSemanticMasks)
+	{
+		QStringList names;
+		for(int i = 0; i < labels.count(); i++)
+		{
+			if(!names.contains(labels[i].name))
+				names << labels[i].name;
+		}
+		names.sort();
+		for(int i = 0; i < labels.count(); i++)
+		{
+			ids[i] = (quint16)qMin(names.indexOf(labels[i].name) + 1, 0xffff);
+		}
+		for(int i = 0; i < names.count(); i++)
+		{
+			legend << QString("%1 %2").arg(i + 1).arg(names[i]);
+		}
+		maxId = names.count();
+	}
+	else
+	{
+		for(int i = 0; i < labels.count(); i++)
+		{
+			ids[i] = (quint16)qMin(i + 1, 0xffff);
+			legend << QString("%1 %2 %3").arg(i + 1).arg(labels[i].number).arg(labels[i].name);
+		}
+		maxId = labels.count();
+	}
+	return ids;
+}
+
+//Rasterizes and saves a run of consecutive mask frames. The raster and its
+//fill buffers are allocated once per job instead of once per frame.
+class MaskFrameJob : public QRunnable
+{
+public:
+	MaskFrameJob(const ExportSettings &settings, const LabelSnapshot &labels, const QVector<quint16> &ids,
+		const QString &fileBase, bool depth16, const QList<QList<int> > &rows, int first, TarWriter *archive, FrameCompletion *completion)
+		: mSettings(settings), mLabels(labels), mIds(ids), mFileBase(fileBase), mDepth16(depth16),
+		mRows(rows), mFirst(first), mArchive(archive), mCompletion(completion)
+	{
+	}
+
+	virtual void run()
+	{
+		QSize origSz = mSettings.imageSize;
+		QSize dispSz = mSettings.displaySize;
+		double kx = (double)origSz.width()/dispSz.width();
+		double ky = (double)origSz.height()/dispSz.height();
+
+		QByteArray format;
+		int quality, compression;
+		imageWriterOptions(ImagePngFast, format, quality, compression);
+
+		LabelMask mask(origSz.width(), origSz.height());
+		for(int i = 0; i < mRows.count(); i++)
+		{
+			int t = mFirst + i;
+			mask.clear();
+			for(int a = 0; a < mRows[i].count(); a++)
+			{
+				int row = mRows[i][a];
+				const Label &lb = mLabels[row];
+				if(lb.shape == Rect)
+				{
+					const ViaPoint *bx = lb.findBoxByFrame(t);
+					if(bx != NULL)
+						mask.fillBox(*bx, kx, ky, mIds[row]);
+				}
+				else if(lb.shape == Polyg)
+				{
+					const ViaPointPolygon *polyg = lb.findPolygonByFrame(t);
+					if(polyg != NULL)
+						mask.fillPolygon(polyg->pl, kx, ky, mIds[row]);
+				}
+			}
+
+			QString sv;
+			sv = mFileBase + sv.sprintf("%05d", t) + (mDepth16 ? ".pgm" : ".png");
+			QByteArray data;
+			QBuffer buf(&data);
+			QFile file(sv);
+			QIODevice *dev = mArchive != NULL ? (QIODevice*)&buf : (QIODevice*)&file;
+			bool ok = dev->open(QIODevice::WriteOnly);
+			if(ok && mDepth16)
+			{
+				ok = mask.writePgm16(dev);
+			}
+			else if(ok)
+			{
+				QImageWriter writer(dev, format);
+				writer.setQuality(quality);
+				ok = writer.write(mask.toImage8());
+			}
+			dev->close();
+
+			if(mArchive != NULL)
+				ok = ok && mArchive->addFile(QFileInfo(sv).fileName(), data);
+			else
+				ok = ok && file.error() == QFile::NoError;
+			mCompletion->finish(t, ok);
+		}
+	}
+
+private:
+	ExportSettings mSettings;
+	LabelSnapshot mLabels;
+	QVector<quint16> mIds;
+	QString mFileBase;
+	bool mDepth16;
+	QList<QList<int> > mRows;	//labels present in each frame of the run
+	int mFirst;
+	TarWriter *mArchive;
+	FrameCompletion *mCompletion;
+};
+
+Exporter::Exporter(QObject *parent)
+	: QObject(parent)
+{
+	mPool.setMaxThreadCount(1);
+	mRunning = false;
+}
+
+Exporter::~Exporter()
+{
+	cancel();
+	mPool.waitForDone();
+}
+
+bool Exporter::start(const ExportSettings &settings, const LabelSnapshot &labels, QSharedPointer<FrameReader> reader)
+{
+	if(mRunning)
+		return false;
+
+	//every avi segment reads its part of the range through its own capture,
+	//so the segments don't wait for each other and don't seek back and forth
+	QList<CvVideoWriter*> writers;
+	QList<QSharedPointer<FrameReader> > readers;
+	readers << reader;
+	if(settings.saveAsAvi && (settings.format == ExportBlackBackground || settings.format == ExportOriginalImages))
+	{
+		int n = segmentCount(settings);
+		for(int i = 0; i < n; i++)
+		{
+			writers << createVideoWriter(settings, n > 1 ? segmentFile(settings.saveFile, i) : settings.saveFile);
+			if(i > 0 && settings.format == ExportOriginalImages && !reader.isNull())
+				readers << QSharedPointer<FrameReader>(new FrameReader(reader->fileName()));
+		}
+	}
+
+	mToken = CancelToken(new QAtomicInt(0));
+	mRunning = true;
+	mTimer.start();
+	mPool.start(new ExportJob(this, mToken, settings, labels, readers, writers));
+	return true;
+}
+
+void Exporter::cancel()
+{
+	if(mToken)
+		mToken->fetchAndStoreOrdered(1);
+}
+
+void Exporter::onProgress(int done, int total)
+{
+	int ms = qMax(mTimer.elapsed(), 1);
+	emit progress(done, total, done*1000.0/ms);
+}
+
+void Exporter::onFinished(bool ok, QString message)
+{
+	mRunning = false;
+	mToken.clear();
+	emit finished(ok, message);
+}
+
+QString Exporter::imageExtension(ImageSequenceFormat format)
+{
+	switch(format)
+	{
+	case ImageTiff:
+		return ".tif";
+	case ImageBmp:
+		return ".bmp";
+	default:
+		return ".png";
+	}
+}
+
+bool Exporter::writesFilePerFrame(ExportFormat format, bool saveAsAvi)
+{
+	if(format == ExportBlackBackground || format == ExportOriginalImages)
+		return !saveAsAvi;
+	return format == ExportLabelMeXML || format == ExportInstanceMasks || format == ExportSemanticMasks;
+}
+
+FrameRangeSet Exporter::framesToWrite(const ExportSettings &settings)
+{
+	if(settings.changedOnly && writesFilePerFrame(settings.format, settings.saveAsAvi))
+		return settings.changedFrames.intersected(settings.firstFrame, settings.lastFrame);
+	return FrameRangeSet(settings.firstFrame, settings.lastFrame);
+}
+
+QString Exporter::archiveFile(const ExportSettings &settings)
+{
+	QString path, fname, prefix, ext;
+	int index;
+	CommonFunctions::splitPath(settings.saveFile, path, fname, prefix, (uint)5, index, ext);
+	return path + prefix + ".tar";
+}
+
+bool Exporter::countsFrames(ExportFormat format)
+{
+	return format == ExportBlackBackground || format == ExportOriginalImages || format == ExportLabelMeXML ||
+		format == ExportInstanceMasks || format == ExportSemanticMasks;
+}
+
+CvVideoWriter *Exporter::createVideoWriter(const ExportSettings &settings, const QString &file)
+{
+	CvSize sz = cvSize(settings.imageSize.width(), settings.imageSize.height());
+	int fourcc = CV_FOURCC_DEFAULT;
+	QByteArray c = settings.codec.toAscii();
+	if(c.length() == 4)
+		fourcc = CV_FOURCC(c[0], c[1], c[2], c[3]);
+	return cvCreateVideoWriter(file.toAscii(), fourcc, settings.fps, sz);
+}
+
+QString Exporter::segmentFile(const QString &saveFile, int segment)
+{
+	QFileInfo fi(saveFile);
+	QString part;
+	part.sprintf(".part%02d.", segment);
+	return fi.path() + "/" + fi.completeBaseName() + part + fi.suffix();
+}
+
+bool Exporter::run(const ExportSettings &settings, const LabelSnapshot &labels, const QList<FrameReader*> &readers, QList<CvVideoWriter*> &writers, ExportControl &ctl)
+{
+	switch(settings.format)
+	{
+	case ExportBlackBackground:
+	case ExportOriginalImages:
+		if(writers.count() > 1)
+			return exportMovieSegments(settings, labels, readers, writers, ctl);
+		return exportMovie(settings, labels, readers.value(0, NULL), writers.value(0, NULL), ctl);
+	case ExportMatlabStruct:
+		return exportMatlabStruct(settings, labels, ctl);
+	case ExportSimpleLabelXML:
+		return exportSimpleLabelXML(settings, labels, ctl);
+	case ExportLabelMeXML:
+		return exportLabelMeXML(settings, labels, ctl);
+	case ExportInstanceMasks:
+	case ExportSemanticMasks:
+		return exportMasks(settings, labels, ctl);
+	case ExportNumpy:
+		return exportNumpy(settings, labels, ctl);
+	default:
+		break;
+	}
+	return false;
+}
+
+bool Exporter::exportMovie(const ExportSettings &settings, const LabelSnapshot &labels, FrameReader *reader, CvVideoWriter *writer, ExportControl &ctl)
+{
+	//frames are decoded in order on one thread, drawn and saved as images on
+	//the others, avi frames are encoded in order on this one
+	int renderers = qMax(QThread::idealThreadCount() - 2, 1);
+	QThreadPool stages;
+	stages.setMaxThreadCount(renderers + 1);
+	return exportMovie(settings, labels, reader, writer, ctl, &stages, renderers);
+}
+
+bool Exporter::exportMovie(const ExportSettings &settings, const LabelSnapshot &labels, FrameReader *reader, CvVideoWriter *writer,
+	ExportControl &ctl, QThreadPool *stages, int renderers)
+{
+	bool origBkgrd = settings.format == ExportOriginalImages;
+	QSize origSz = settings.imageSize;
+
+	if(labels.count() == 0)
+		return true;
+
+	if(settings.saveAsAvi && writer == NULL)
+	{
+		ctl.error = "Failed to create " + settings.saveFile;
+		return false;
+	}
+	if(origBkgrd && reader == NULL)
+	{
+		ctl.error = "The original images are not available.";
+		return false;
+	}
+
+	FrameRangeSet frames = framesToWrite(settings);
+	TarWriter tar;
+	if(!openArchive(settings, tar, frames, ctl))
+		return false;
+	TarWriter *archive = tar.isOpen() ? &tar : NULL;
+
+	LabelSpanIndex spans;
+	spans.rebuild(labels.labels());
+
+	int depth = (renderers + 2) * MOVIE_FRAMES_PER_THREAD;
+	MoviePipeline pipe(depth);
+	stages->start(new MovieDecodeJob(&pipe, settings, frames, &spans, reader));
+	for(int r = 0; r < renderers; r++)
+	{
+		stages->start(new MovieRenderJob(&pipe, settings, labels, archive));
+	}
+
+	bool ok = true;
+	int total = settings.lastFrame - settings.firstFrame + 1;
+	int written = frames.frameCount();
+	qint64 bytes = 0;
+	QTime timer;
+	timer.start();
+	QMap<int, MovieFrame> pending;	//rendered frames waiting for their turn
+	IplImage* ipl = cvCreateImage(cvSize(origSz.width(), origSz.height()), IPL_DEPTH_8U, 3);
+	for(int t = settings.firstFrame; t <= settings.lastFrame && !ctl.isCancelled(); t++)
+	{
+		//the image files of the frames that didn't change are up to date
+		if(!frames.contains(t))
+		{
+			ctl.progress(t - settings.firstFrame + 1, total);
+			continue;
+		}
+
+		MovieFrame f;
+		while(!pending.contains(t) && pipe.rendered.pop(f))
+		{
+			pending.insert(f.frame, f);
+		}
+
+		f = pending.take(t);
+		if(f.frame != t || !f.error.isEmpty())
+		{
+			ctl.error = f.error.isEmpty() ? QString("Failed to read frame %1.").arg(t) : f.error;
+			ok = false;
+			break;
+		}
+
+		if(settings.saveAsAvi)
+		{
+			Monitor::convertARGB2RGB(&f.image, ipl);
+			cvWriteFrame(writer, ipl);
+		}
+		bytes += f.bytes;
+		pipe.room.release();
+		ctl.progress(t - settings.firstFrame + 1, total);
+	}
+	cvReleaseImage(&ipl);
+
+	if(ok && !ctl.isCancelled())
+	{
+		double sec = qMax(timer.elapsed(), 1) / 1000.0;
+		ctl.summary = QString("Exported %1 frames in %2 s, %3 frames/s").arg(written).arg(sec, 0, 'f', 1).arg(written / sec, 0, 'f', 1);
+		if(!settings.saveAsAvi)
+			ctl.summary += QString(", %1 MB/s").arg(bytes / (1024.0 * 1024.0) / sec, 0, 'f', 1);
+		if(written < total)
+			ctl.summary += QString(", the other %1 were up to date").arg(total - written);
+	}
+
+	//stop the other stages if the export ended early
+	pipe.stop.fetchAndStoreOrdered(1);
+	pipe.decoded.abort();
+	pipe.rendered.abort();
+	pipe.room.release(depth);
+	pipe.done.acquire(renderers + 1);
+
+	return finishArchive(tar, ctl) && ok;
+}
+
+bool Exporter::exportMovieSegments(const ExportSettings &settings, const LabelSnapshot &labels, const QList<FrameReader*> &readers,
+	QList<CvVideoWriter*> &writers, ExportControl &ctl)
+{
+	int n = writers.count();
+	int total = settings.lastFrame - settings.firstFrame + 1;
+	QTime timer;
+	timer.start();
+
+	//The segments share one pool for their decoders and renderers, together
+	//they use about as many threads as a single export. It has a thread for
+	//every stage, so a segment never waits for the stages of another one.
+	int renderers = qMax((QThread::idealThreadCount() - 2) / n, 1);
+	QThreadPool stages;
+	stages.setMaxThreadCount(n * (renderers + 1));
+
+	//every segment is a complete avi of its own part of the range
+	SegmentProgress progress(ctl, n, total);
+	QList<MovieSegmentJob*> jobs;
+	QStringList files;
+	QThreadPool pool;
+	pool.setMaxThreadCount(n);
+	for(int i = 0; i < n; i++)
+	{
+		ExportSettings seg = settings;
+		seg.firstFrame = settings.firstFrame + (int)((qint64)total * i / n);
+		seg.lastFrame = settings.firstFrame + (int)((qint64)total * (i + 1) / n) - 1;
+		files << segmentFile(settings.saveFile, i);
+		jobs << new MovieSegmentJob(seg, labels, readers.value(i, NULL), writers[i], ctl.cancelToken(), &progress, i, &stages, renderers);
+		pool.start(jobs.last());
+	}
+	pool.waitForDone();
+
+	bool ok = true;
+	for(int i = 0; i < n; i++)
+	{
+		if(ok && !jobs[i]->ok)
+		{
+			ctl.error = jobs[i]->error;
+			ok = false;
+		}
+		delete jobs[i];
+		//the segment files are complete once their writers are released
+		if(writers[i])
+			cvReleaseVideoWriter(&writers[i]);
+	}
+
+	if(!ok || ctl.isCancelled())
+	{
+		for(int i = 0; i < files.count(); i++)
+		{
+			QFile::remove(files[i]);
+		}
+		return ok;
+	}
+
+	if(!concatSegments(files, settings.saveFile, ctl))
+		return false;
+
+	double sec = qMax(timer.elapsed(), 1) / 1000.0;
+	ctl.summary = QString("Exported %1 frames in %2 segments in %3 s, %4 frames/s").arg(total).arg(n)
+		.arg(sec, 0, 'f', 1).arg(total / sec, 0, 'f', 1);
+	return true;
+}
+
+bool Exporter::concatSegments(const QStringList &files, const QString &saveFile, ExportControl &ctl)
+{
+	//ffmpeg's concat demuxer joins the segments without encoding them again
+	QString listFile = saveFile + ".segments.txt";
+	QFile fd(listFile);
+	if(!fd.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+	{
+		ctl.error = "Failed to write " + listFile;
+		return false;
+	}
+	QTextStream out(&fd);
+	for(int i = 0; i < files.count(); i++)
+	{
+		out << "file '" << QFileInfo(files[i]).absoluteFilePath().replace("'", "'\\''") << "'" << endl;
+	}
+	fd.close();
+
+	QStringList args;
+	args << "-y" << "-loglevel" << "error" << "-f" << "concat" << "-safe" << "0" << "-i" << listFile << "-c" << "copy" << saveFile;
+	QProcess ffmpeg;
+	ffmpeg.start(FFMPEG_EXECUTABLE, args);
+	bool started = ffmpeg.waitForStarted();
+	while(started && ffmpeg.state() != QProcess::NotRunning && !ffmpeg.waitForFinished(EXPORT_PROGRESS_INTERVAL))
+	{
+		if(ctl.isCancelled())
+		{
+			ffmpeg.kill();
+			ffmpeg.waitForFinished(-1);
+		}
+	}
+
+	//a cancelled join leaves a partial file, the segments are removed with it
+	if(ctl.isCancelled())
+	{
+		QFile::remove(saveFile);
+		QFile::remove(listFile);
+		for(int i = 0; i < files.count(); i++)
+		{
+			QFile::remove(files[i]);
+		}
+		return false;
+	}
+
+	//the segments are only removed once ffmpeg reported success and wrote the file
+	if(!started || ffmpeg.exitStatus() != QProcess::NormalExit || ffmpeg.exitCode() != 0 || QFileInfo(saveFile).size() <= 0)
+	{
+		ctl.error = "Failed to join the segments with " FFMPEG_EXECUTABLE ", they are kept next to " + saveFile + ". " +
+			QString::fromLocal8Bit(ffmpeg.readAllStandardError()).trimmed();
+		return false;
+	}
+
+	QFile::remove(listFile);
+	for(int i = 0; i < files.count(); i++)
+	{
+		QFile::remove(files[i]);
+	}
+	return true;
+}
+
+bool Exporter::exportMatlabStruct(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl)
+{
+	if(settings.saveFile.endsWith(".mat", Qt::CaseInsensitive))
+		return exportMatFile(settings, labels, ctl);
+	return exportMatlabScript(settings, labels, ctl);
+}
+
+//polygon as a vertices x 2 matrix
+static QByteArray matPolygon(const SmallPolygon &pl)
+{
+	QVector<double> m(pl.count()*2);
+	for(int j = 0; j < pl.count(); j++)
+	{
+		m[j] = pl[j].x();
+		m[pl.count() + j] = pl[j].y();
+	}
+	return MatWriter::doubleMatrix(m, pl.count(), 2);
+}
+
+//The same structure as the one of the Matlab function, as numeric arrays
+bool Exporter::exportMatFile(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl)
+{
+	QSize origSz = settings.imageSize;
+	QSize dispSz = settings.displaySize;
+
+	QFile fd(settings.saveFile);
+	if(!fd.open(QFile::WriteOnly | QFile::Truncate))
+	{
+		ctl.error = "Failed to write " + settings.saveFile;
+		return false;
+	}
+
+	QStringList fields;
+	fields << "number" << "desc" << "name" << "startFrame" << "endFrame" << "boxes" << "pivots" << "polygons" << "pivotsPolyg";
+	QStringList pivotFields;
+	pivotFields << "frame" << "box";
+	QStringList polygonFields;
+	polygonFields << "polygon";
+	QStringList pivotPolygFields;
+	pivotPolygFields << "frame" << "polygon";
+
+	MatWriter mat(&fd);
+	mat.writeHeader("Platform: SimpleLabel " APP_VERSION);
+	mat.beginStructArray(settings.structName, fields, labels.count());
+	for(int i = 0; i < labels.count() && !ctl.isCancelled(); i++)
+	{
+		const Label &lb = labels[i];
+		QList<ViaPoint> viaPoints = lb.boxViaPoints();
+		BlockList<ViaPointPolygon> polygons = lb.polygonTrack();
+		QVector<ViaPointPolygon> viaPointsPoly = lb.polygonViaPoints();
+
+		mat.writeValue(MatWriter::scalar(lb.number));
+		mat.writeValue(MatWriter::charArray(QString(lb.desc).replace("\n", "")));
+		mat.writeValue(MatWriter::charArray(lb.name));
+		//an empty label has empty start and end frames
+		int first, last;
+		bool hasFrames = lb.frameRange(first, last);
+		mat.writeValue(hasFrames ? MatWriter::scalar(first) : MatWriter::doubleMatrix(QVector<double>(), 0, 0));
+		mat.writeValue(hasFrames ? MatWriter::scalar(last) : MatWriter::doubleMatrix(QVector<double>(), 0, 0));
+
+		BoxTrack boxes(lb.boxTrack());
+		boxes.scale(dispSz.width(), dispSz.height(), origSz.width(), origSz.height());
+		int n = boxes.count();
+		QVector<double> m(n*4);
+		for(int k = 0; k < n; k++)
+		{
+			m[k] = boxes.x[k];
+			m[n + k] = boxes.y[k];
+			m[2*n + k] = boxes.w[k];
+			m[3*n + k] = boxes.h[k];
+		}
+		mat.writeValue(MatWriter::doubleMatrix(m, n, 4));
+
+		BoxTrack pivots(viaPoints);
+		pivots.scale(dispSz.width(), dispSz.height(), origSz.width(), origSz.height());
+		QList<QByteArray> values;
+		for(int k = 0; k < pivots.count(); k++)
+		{
+			values << MatWriter::scalar(pivots.frame[k]);
+			values << MatWriter::doubleMatrix(QVector<double>() << pivots.x[k] << pivots.y[k] << pivots.w[k] << pivots.h[k], 1, 4);
+		}
+		mat.writeValue(MatWriter::structArray(pivotFields, pivots.count(), values));
+
+		values.clear();
+		for(int k = 0; k < polygons.count(); k++)
+		{
+			values << matPolygon(CommonFunctions::imageToImage(dispSz.width(), dispSz.height(), polygons[k].pl, origSz.width(), origSz.height()));
+		}
+		mat.writeValue(MatWriter::structArray(polygonFields, polygons.count(), values));
+
+		values.clear();
+		for(int k = 0; k < viaPointsPoly.count(); k++)
+		{
+			values << MatWriter::scalar(viaPointsPoly[k].frame);
+			values << matPolygon(CommonFunctions::imageToImage(dispSz.width(), dispSz.height(), viaPointsPoly[k].pl, origSz.width(), origSz.height()));
+		}
+		mat.writeValue(MatWriter::structArray(pivotPolygFields, viaPointsPoly.count(), values));
+
+		ctl.progress(i + 1, labels.count());
+	}
+
+	if(ctl.isCancelled())
+	{
+		fd.remove();
+		return false;
+	}
+
+	bool ok = mat.endStructArray();
+	fd.close();
+	if(!ok)
+	{
+		ctl.error = "Failed to write " + settings.saveFile + ": " + mat.errorString();
+		fd.remove();
+		return false;
+	}
+	return true;
+}
+
+bool Exporter::exportMatlabScript(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl)
+{
+	QSize origSz = settings.imageSize;
+	QSize dispSz = settings.displaySize;
+	int i, k, j;
+	QString filename = settings.structName;
+
+	QFile fd(settings.saveFile);
+	if(!fd.open(QFile::WriteOnly | QFile::Truncate))
+	{
+		ctl.error = "Failed to write " + settings.saveFile;
+		return false;
+	}
+
+	QTextStream out(&fd);
+	out << "function " << filename << " = " << filename + "_lbl" << endl;
+	for(i = 0; i < labels.count() && !ctl.isCancelled(); i++)
+	{
+		const Label &lb = labels[i];
+		//both shapes are exported, the one the label doesn't have is derived
+		QList<ViaPoint> viaPoints = lb.boxViaPoints();
+		BlockList<ViaPointPolygon> polygons = lb.polygonTrack();
+		QVector<ViaPointPolygon> viaPointsPoly = lb.polygonViaPoints();
+
+		out << filename << "(" << i +1 << ").number = " << lb.number << ";" << endl;
+		out << filename << "(" << i +1 << ").desc = '" << QString(lb.desc).replace("\n", "") << "';" << endl;
+		out << filename << "(" << i +1 << ").name = '" << lb.name << "';" << endl;
+		int first, last;
+		bool hasFrames = lb.frameRange(first, last);
+		out << filename << "(" << i +1 << ").startFrame = " << (hasFrames ? QString::number(first) : QString("[]")) << ";" << endl;
+		out << filename << "(" << i +1 << ").endFrame = " << (hasFrames ? QString::number(last) : QString("[]")) << ";" << endl;
+
+		out << filename << "(" << i +1 << ").boxes = [";
+		BoxTrack boxes(lb.boxTrack());
+		boxes.scale(dispSz.width(), dispSz.height(), origSz.width(), origSz.height());
+		for(k = 0; k < boxes.count(); k++)
+		{
+			out << boxes.x[k] << "," << boxes.y[k] << "," << boxes.w[k] << "," << boxes.h[k];
+			if(k != boxes.count() - 1)
+				out << ";";
+		}
+		out << "];" << endl;
+
+		BoxTrack pivots(viaPoints);
+		pivots.scale(dispSz.width(), dispSz.height(), origSz.width(), origSz.height());
+		for(k = 0; k < pivots.count(); k++)
+		{
+			out << filename << "(" << i +1 << ").pivots(" << k + 1 << ").frame = " <<  pivots.frame[k] << ";" << endl;
+			out << filename << "(" << i +1 << ").pivots(" << k + 1 << ").box = [";
+			out << pivots.x[k] << "," << pivots.y[k] << "," << pivots.w[k] << "," << pivots.h[k] << "];" << endl;
+		}
+
+		for(k = 0; k < polygons.count(); k++)
+		{
+			out << filename << "(" << i +1 << ").polygons(" << k + 1 << ").polygon=[";
+			SmallPolygon pl = CommonFunctions::imageToImage(dispSz.width(), dispSz.height(), polygons[k].pl, origSz.width(), origSz.height());
+			for(j = 0; j < pl.count(); j++)
+			{
+				QPoint pt = pl.point(j);
+				out << pt.x() << "," << pt.y();
+				if(j != pl.count() - 1)
+					out << ";";
+			}
+			out << "];" << endl;
+		}
+
+		for(k = 0; k < viaPointsPoly.count(); k++)
+		{
+			SmallPolygon pl = CommonFunctions::imageToImage(dispSz.width(), dispSz.height(), viaPointsPoly[k].pl, origSz.width(), origSz.height());
+
+			out << filename << "(" << i +1 << ").pivotsPolyg(" << k + 1 << ").frame = " <<  viaPointsPoly[k].frame << ";" << endl;
+			out << filename << "(" << i +1 << ").pivotsPolyg(" << k + 1 << ").polygon = [";
+			for(j = 0; j < pl.count(); j++)
+			{
+				QPoint pt = pl.point(j);
+				out << pt.x() << "," << pt.y();
+				if(j != pl.count() - 1)
+					out << ";";
+			}
+		}
+		ctl.progress(i + 1, labels.count());
+	}
+	out << "];" << endl;
+	fd.close();
+
+	return true;
+}
+
+bool Exporter::exportSimpleLabelXML(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl)
+{
+	int i, k, j;
+	QSize origSz = settings.imageSize;
+	QSize dispSz = settings.displaySize;
+
+	QFile fd(settings.saveFile);
+	if(!fd.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		ctl.error = "Failed to write " + settings.saveFile;
+		return false;
+	}
+
+	//the labels are streamed straight to the file, the output is the same as
+	//saving a QDomDocument of the whole project
+	DomStreamWriter xml(&fd);
+	xml.writeDocType("Labels");
+	xml.writeStartElement("root");
+
+	//save image properties
+	xml.writeStartElement("image");
+	xml.writeAttribute("name", settings.fileName);
+	xml.writeAttribute("width", origSz.width());
+	xml.writeAttribute("height", origSz.height());
+	xml.writeEndElement();
+
+	//save labels
+	for(i = 0; i < labels.count() && !ctl.isCancelled(); i++)
+	{
+		const Label &lb = labels[i];
+		xml.writeStartElement("label");
+		xml.writeAttribute("name", lb.name);
+		xml.writeAttribute("number", lb.number);
+		xml.writeAttribute("desc", lb.desc);
+		xml.writeAttribute("shape", lb.shape);
+		xml.writeAttribute("interpolation", lb.intr);
+
+		if(lb.shape == Rect)
+		{
+			//bounding rectangles
+			xml.writeStartElement("boxes");
+			BoxTrack bt(lb.boxes);
+			bt.scale(dispSz.width(), dispSz.height(), origSz.width(), origSz.height());
+			for(k = 0; k < bt.count(); k++)
+			{
+				xml.writeStartElement("box");
+				xml.writeAttribute("frame", bt.frame[k]);
+				xml.writeAttribute("left", bt.x[k]);
+				xml.writeAttribute("top", bt.y[k]);
+				xml.writeAttribute("right", bt.x[k] + bt.w[k] - 1);
+				xml.writeAttribute("bottom", bt.y[k] + bt.h[k] - 1);
+				xml.writeAttribute("angle", bt.angle[k]);
+				xml.writeEndElement();
+			}
+			xml.writeEndElement();
+
+			//bounding rectangle via points
+			xml.writeStartElement("pivots");
+			BoxTrack pt(lb.viaPoints);
+			pt.scale(dispSz.width(), dispSz.height(), origSz.width(), origSz.height());
+			for(k = 0; k < pt.count(); k++)
+			{
+				xml.writeStartElement("pivot");
+				xml.writeAttribute("frame", pt.frame[k]);
+				xml.writeAttribute("left", pt.x[k]);
+				xml.writeAttribute("top", pt.y[k]);
+				xml.writeAttribute("right", pt.x[k] + pt.w[k] - 1);
+				xml.writeAttribute("bottom", pt.y[k] + pt.h[k] - 1);
+				xml.writeAttribute("angle", pt.angle[k]);
+				xml.writeEndElement();
+			}
+			xml.writeEndElement();
+		}
+		else if(lb.shape == Polyg)
+		{
+			//polygons
+			xml.writeStartElement("polygons");
+			for(k = 0; k < lb.polygons.count(); k++)
+			{
+				xml.writeStartElement("polygon");
+				xml.writeAttribute("frame", lb.polygons[k].frame);
+				for(j = 0; j < lb.polygons[k].pl.count(); j++)
+				{
+					QPoint p = CommonFunctions::imageToImage(dispSz.width(), dispSz.height(), lb.polygons[k].pl.point(j), origSz.width(), origSz.height());
+					xml.writeStartElement("vertex");
+					xml.writeAttribute("x", p.x());
+					xml.writeAttribute("y", p.y());
+					xml.writeEndElement();
+				}
+				xml.writeEndElement();
+			}
+			xml.writeEndElement();
+
+			//polygon via points
+			xml.writeStartElement("polygonPivots");
+			for(k = 0; k < lb.viaPointsPoly.count(); k++)
+			{
+				xml.writeStartElement("polygonPivot");
+				xml.writeAttribute("frame", lb.viaPointsPoly[k].frame);
+				for(j = 0; j < lb.viaPointsPoly[k].pl.count(); j++)
+				{
+					QPoint p = CommonFunctions::imageToImage(dispSz.width(), dispSz.height(), lb.viaPointsPoly[k].pl.point(j), origSz.width(), origSz.height());
+					xml.writeStartElement("vertex");
+					xml.writeAttribute("x", p.x());
+					xml.writeAttribute("y", p.y());
+					xml.writeEndElement();
+				}
+				xml.writeEndElement();
+			}
+			xml.writeEndElement();
+		}
+		xml.writeEndElement();
+		ctl.progress(i + 1, labels.count());
+	}
+
+	if(ctl.isCancelled())
+	{
+		//don't leave a truncated project behind
+		fd.remove();
+		return false;
+	}
+
+	bool ok = xml.finish();
+	fd.close();
+	if(!ok)
+	{
+		ctl.error = "Failed to write " + settings.saveFile;
+	}
+	return ok;
+}
+
+bool Exporter::exportLabelMeXML(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl)
+{
+	QString path, fname, ext;
+	CommonFunctions::splitPath(settings.saveFile, path, fname, ext);
+
+	LabelSpanIndex spans;
+	spans.rebuild(labels.labels());
+
+	//the frames are written in parallel, only a few per thread are queued at a
+	//time so the memory doesn't grow with the length of the sequence
+	QThreadPool pool;
+	int maxInFlight = pool.maxThreadCount() * LABELME_FRAMES_PER_THREAD;
+	int total = settings.lastFrame - settings.firstFrame + 1;
+	FrameRangeSet frames = framesToWrite(settings);
+	TarWriter tar;
+	if(!openArchive(settings, tar, frames, ctl))
+		return false;
+	TarWriter *archive = tar.isOpen() ? &tar : NULL;
+	FrameCompletion completion(settings.firstFrame);
+
+	for(int i = settings.firstFrame; i <= settings.lastFrame && !ctl.isCancelled(); i++)
+	{
+		//the files of the frames that didn't change are up to date
+		if(!frames.contains(i))
+		{
+			int to = qMin(frames.nextFrame(i), settings.lastFrame + 1);
+			completion.skip(i, to - 1);
+			i = to - 1;
+			continue;
+		}
+
+		int next;
+		{
+			QMutexLocker lock(&completion.mutex);
+			while(completion.inFlight >= maxInFlight)
+			{
+				completion.changed.wait(&completion.mutex);
+			}
+			if(completion.failed >= 0)
+				break;
+			completion.inFlight++;
+			next = completion.next;
+		}
+		ctl.progress(next - settings.firstFrame, total);
+		pool.start(new LabelMeFrameJob(settings, labels, spans.labelsAt(i), path, i, archive, &completion));
+	}
+	pool.waitForDone();
+
+	if(completion.failed >= 0)
+	{
+		ctl.error = QString("Failed to write the annotation of frame %1.").arg(completion.failed);
+		finishArchive(tar, ctl);
+		return false;
+	}
+	if(!finishArchive(tar, ctl))
+		return false;
+	ctl.progress(completion.next - settings.firstFrame, total);
+	if(frames.frameCount() < total)
+		ctl.summary = QString("Rewrote %1 frames, the other %2 were up to date.").arg(frames.frameCount()).arg(total - frames.frameCount());
+	return true;
+}
+
+bool Exporter::exportMasks(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl)
+{
+	QString path, fname, prefix, ext;
+	int index;
+	CommonFunctions::splitPath(settings.saveFile, path, fname, prefix, (uint)5, index, ext);
+
+	QStringList legend;
+	int maxId;
+	QVector<quint16> ids = maskIds(settings, labels, legend, maxId);
+	if(maxId > 0xffff)
+	{
+		ctl.error = QString("%1 mask ids don't fit into 16 bit images.").arg(maxId);
+		return false;
+	}
+	bool depth16 = maxId > 255;
+
+	QString idText = "0 background\n";
+	for(int i = 0; i < legend.count(); i++)
+	{
+		idText += legend[i] + "\n";
+	}
+
+	//the masks already written are only up to date if the ids didn't change
+	QFile file(path + prefix + "ids.txt");
+	bool sameIds = false;
+	if(settings.changedOnly && file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		sameIds = QTextStream(&file).readAll() == idText;
+		file.close();
+	}
+	if(!sameIds)
+	{
+		if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		{
+			ctl.error = "Failed to write " + file.fileName();
+			return false;
+		}
+		QTextStream out(&file);
+		out << idText;
+		file.close();
+	}
+
+	LabelSpanIndex spans;
+	spans.rebuild(labels.labels());
+
+	//runs of frames are rasterized in parallel, like the LabelMe export only a
+	//few runs per thread are queued at a time
+	QThreadPool pool;
+	int maxInFlight = pool.maxThreadCount() * MASK_FRAMES_PER_JOB * 2;
+	int total = settings.lastFrame - settings.firstFrame + 1;
+	FrameRangeSet frames = sameIds ? framesToWrite(settings) : FrameRangeSet(settings.firstFrame, settings.lastFrame);
+	TarWriter tar;
+	if(!openArchive(settings, tar, frames, ctl))
+		return false;
+	TarWriter *archive = tar.isOpen() ? &tar : NULL;
+	int written = frames.frameCount();
+	FrameCompletion completion(settings.firstFrame);
+	QTime timer;
+	timer.start();
+
+	int n;
+	for(int i = settings.firstFrame; i <= settings.lastFrame && !ctl.isCancelled(); i += n)
+	{
+		//the masks of the frames that didn't change are up to date
+		if(!frames.contains(i))
+		{
+			n = qMin(frames.nextFrame(i), settings.lastFrame + 1) - i;
+			completion.skip(i, i + n - 1);
+			continue;
+		}
+
+		//a job doesn't run past the end of the changed frames
+		n = qMin(MASK_FRAMES_PER_JOB, frames.runEnd(i) - i + 1);
+		int next;
+		{
+			QMutexLocker lock(&completion.mutex);
+			while(completion.inFlight + n > maxInFlight)
+			{
+				completion.changed.wait(&completion.mutex);
+			}
+			if(completion.failed >= 0)
+				break;
+			completion.inFlight += n;
+			next = completion.next;
+		}
+		ctl.progress(next - settings.firstFrame, total);
+
+		QList<QList<int> > rows;
+		for(int t = i; t < i + n; t++)
+		{
+			rows << spans.labelsAt(t);
+		}
+		pool.start(new MaskFrameJob(settings, labels, ids, path + prefix, depth16, rows, i, archive, &completion));
+	}
+	pool.waitForDone();
+
+	if(completion.failed >= 0)
+	{
+		ctl.error = QString("Failed to write the mask of frame %1.").arg(completion.failed);
+		finishArchive(tar, ctl);
+		return false;
+	}
+	if(!finishArchive(tar, ctl))
+		return false;
+	ctl.progress(completion.next - settings.firstFrame, total);
+
+	if(!ctl.isCancelled())
+	{
+		double sec = qMax(timer.elapsed(), 1) / 1000.0;
+		ctl.summary = QString("Exported %1 %2 masks in %3 s, %4 frames/s").arg(written).arg(depth16 ? "16 bit pgm" : "8 bit png")
+			.arg(sec, 0, 'f', 1).arg(written / sec, 0, 'f', 1);
+		if(written < total)
+			ctl.summary += QString(", the other %1 were up to date").arg(total - written);
+	}
+	return true;
+}
+
+//numpy types of the arrays written by the NumPy export
+#define NPY_INT32		"'<i4'"
+#define NPY_LABELS		"[('number', '<i4'), ('shape', '<i4'), ('start', '<i4'), ('end', '<i4')]"
+#define NPY_BOXES		"[('frame', '<i4'), ('x', '<i4'), ('y', '<i4'), ('w', '<i4'), ('h', '<i4'), ('angle', '<f4')]"
+
+static void appendInt32(QByteArray &buf, qint32 v)
+{
+	uchar b[4];
+	qToLittleEndian(v, b);
+	buf.append((const char*)b, 4);
+}
+
+static void appendFloat32(QByteArray &buf, float v)
+{
+	quint32 bits;
+	memcpy(&bits, &v, 4);
+	uchar b[4];
+	qToLittleEndian(bits, b);
+	buf.append((const char*)b, 4);
+}
+
+//The archive holds a "labels" table and "names" with one row per label, and per
+//label (numbered from 1 like the Matlab structure) the dense boxes and, for
+//polygon labels, the polygon track in compressed row form: the vertices of
+//polygon k are points[offsets[k]:offsets[k+1]].
+bool Exporter::exportNumpy(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl)
+{
+	QSize origSz = settings.imageSize;
+	QSize dispSz = settings.displaySize;
+
+	QFile file(settings.saveFile);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		ctl.error = "Failed to write " + settings.saveFile;
+		return false;
+	}
+	NpzWriter npz(&file);
+
+	QByteArray table;
+	int nameLength = 1;
+	for(int i = 0; i < labels.count(); i++)
+	{
+		const Label &lb = labels[i];
+		BlockList<ViaPoint> track = lb.boxTrack();
+		appendInt32(table, lb.number);
+		appendInt32(table, lb.shape);
+		appendInt32(table, track.isEmpty() ? -1 : track.first().frame);
+		appendInt32(table, track.isEmpty() ? -1 : track.last().frame);
+		nameLength = qMax(nameLength, lb.name.toUcs4().count());
+	}
+	QByteArray names;
+	for(int i = 0; i < labels.count(); i++)
+	{
+		QVector<uint> ucs = labels[i].name.toUcs4();
+		ucs.resize(nameLength);
+		for(int k = 0; k < nameLength; k++)
+		{
+			appendInt32(names, ucs[k]);
+		}
+	}
+	npz.addArray("labels", NPY_LABELS, QList<int>() << labels.count(), table);
+	npz.addArray("names", QString("'<U%1'").arg(nameLength), QList<int>() << labels.count(), names);
+
+	for(int i = 0; i < labels.count() && !ctl.isCancelled(); i++)
+	{
+		const Label &lb = labels[i];
+		QString prefix;
+		prefix.sprintf("label%05d_", i + 1);
+
+		BoxTrack boxes(lb.boxTrack());
+		boxes.scale(dispSz.width(), dispSz.height(), origSz.width(), origSz.height());
+		QByteArray data;
+		data.reserve(boxes.count() * 24);
+		for(int k = 0; k < boxes.count(); k++)
+		{
+			appendInt32(data, boxes.frame[k]);
+			appendInt32(data, boxes.x[k]);
+			appendInt32(data, boxes.y[k]);
+			appendInt32(data, boxes.w[k]);
+			appendInt32(data, boxes.h[k]);
+			appendFloat32(data, boxes.angle[k]);
+		}
+		npz.addArray(prefix + "boxes", NPY_BOXES, QList<int>() << boxes.count(), data);
+
+		if(lb.shape == Polyg)
+		{
+			QByteArray frames, offsets, points;
+			int n = 0;
+			for(int k = 0; k < lb.polygons.count(); k++)
+			{
+				SmallPolygon pl = CommonFunctions::imageToImage(dispSz.width(), dispSz.height(), lb.polygons[k].pl, origSz.width(), origSz.height());
+				appendInt32(frames, lb.polygons[k].frame);
+				appendInt32(offsets, n);
+				for(int j = 0; j < pl.count(); j++)
+				{
+					appendInt32(points, pl[j].x());
+					appendInt32(points, pl[j].y());
+				}
+				n += pl.count();
+			}
+			appendInt32(offsets, n);
+			npz.addArray(prefix + "polygon_frames", NPY_INT32, QList<int>() << lb.polygons.count(), frames);
+			npz.addArray(prefix + "polygon_offsets", NPY_INT32, QList<int>() << lb.polygons.count() + 1, offsets);
+			npz.addArray(prefix + "polygon_points", NPY_INT32, QList<int>() << n << 2, points);
+		}
+		ctl.progress(i + 1, labels.count());
+	}
+
+	bool ok = npz.finish();
+	file.close();
+	if(ctl.isCancelled())
+	{
+		file.remove();
+		return false;
+	}
+	if(!ok)
+	{
+		ctl.error = "Failed to write " + settings.saveFile + ": " + npz.errorString();
+		file.remove();
+		return false;
+	}
+	return true;
+}
+
+bool Exporter::exportFrameToLabelMeXMLWebTool(const ExportSettings &settings, const LabelSnapshot &labels, QString path, int frame)
+{
+	QSize origSz = settings.imageSize;
+
+	QDomDocument doc("");
+	QDomElement root = doc.createElement("annotation");
+	doc.appendChild(root);
+
+	//filename
+	QDomElement tmp = doc.createElement("filename");
+	QDomText txt = doc.createTextNode(settings.fileName);
+	tmp.appendChild(txt);
+	root.appendChild(tmp);
+
+	//folder
+	tmp = doc.createElement("folder");
+	txt = doc.createTextNode(settings.path);
+	tmp.appendChild(txt);
+	root.appendChild(tmp);
+
+	//frame
+	tmp = doc.createElement("frame");
+	txt = doc.createTextNode(QString("%1").arg(frame));
+	tmp.appendChild(txt);
+	root.appendChild(tmp);
+
+	//source
+	QDomElement src = doc.createElement("source");
+	//sourceImage
+	tmp = doc.createElement("sourceImage");
+	txt = doc.createTextNode("");
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//sourceAnnotation
+	tmp = doc.createElement("sourceAnnotation");
+	txt = doc.createTextNode("SimpleLabel");
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//numberFrames
+	tmp = doc.createElement("numberFrames");
+	txt = doc.createTextNode(QString::number(settings.frameCount));
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+
+	root.appendChild(src);
+
+	//imagesize
+	src = doc.createElement("imagesize");
+	//rows
+	tmp = doc.createElement("rows");
+	txt = doc.createTextNode(QString::number(origSz.height()));
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//columns
+	tmp = doc.createElement("columns");
+	txt = doc.createTextNode(QString::number(origSz.width()));
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//channels
+	tmp = doc.createElement("channels");
+	txt = doc.createTextNode(QString::number(3));
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	root.appendChild(src);
+
+
+	QDomElement obj;
+	QList<Label>::const_iterator lb;
+	
+	for(lb = labels.labels().begin(); lb != labels.labels().end(); lb++)
+	{
+		if(lb->boxes.isEmpty() && lb->polygons.isEmpty())
+			continue;
+
+		QDomElement pt;
+		QDomElement x;
+		QDomElement y;
+
+		//object
+		obj = doc.createElement("object");
+
+		//name
+		QDomElement name = doc.createElement("name");
+		//deleted
+		QDomElement deleted = doc.createElement("deleted");
+		//verified
+		QDomElement verified = doc.createElement("verified");
+		//date
+		QDomElement date = doc.createElement("date");
+		//id
+		QDomElement tgtID = doc.createElement("id");
+
+		//bbox
+		QDomElement bbox = doc.createElement("bbox");
+		//polygon
+		QDomElement polygon = doc.createElement("polygon");
+
+		ViaPoint box;
+		SmallPolygon shape;
+		if(lb->boxAt(frame, box) && lb->polygonAt(frame, shape))
+		{
+			QRect b = CommonFunctions::imageToImage(settings.displaySize.width(), settings.displaySize.height(), box.rc, origSz.width(), origSz.height());
+			
+			txt = doc.createTextNode(lb->name);
+			name.appendChild(txt);
+
+			txt = doc.createTextNode(QDateTime::currentDateTime().toString("d-MMM-yyy h:mm:ss"));
+			date.appendChild(txt);
+
+			txt = doc.createTextNode(QString::number(lb->number));
+			tgtID.appendChild(txt);
+
+			//polygon
+			if(lb->shape == Rect)
+			{
+				pt = doc.createElement("pt");
+				x = doc.createElement("x");
+				y = doc.createElement("y");
+
+				txt = doc.createTextNode(QString::number(b.left()));
+				x.appendChild(txt);
+				txt = doc.createTextNode(QString::number(b.top()));
+				y.appendChild(txt);
+				pt.appendChild(x);
+				pt.appendChild(y);
+				polygon.appendChild(pt);
+			}
+			else if(lb->shape == Polyg)
+			{
+				SmallPolygon pl = CommonFunctions::imageToImage(settings.displaySize.width(), settings.displaySize.height(), shape, origSz.width(), origSz.height());
+				for(int pi = 0; pi < pl.count(); pi++)
+				{
+					pt = doc.createElement("pt");
+					x = doc.createElement("x");
+					y = doc.createElement("y");
+
+					QPoint pl_pt = pl.point(pi);
+					txt = doc.createTextNode(QString::number(pl_pt.x()));
+					x.appendChild(txt);
+					txt = doc.createTextNode(QString::number(pl_pt.y()));
+					y.appendChild(txt);
+					pt.appendChild(x);
+					pt.appendChild(y);
+					polygon.appendChild(pt);
+				}
+			}
+		}
+		else
+		{
+			txt = doc.createTextNode("");
+			bbox.appendChild(txt);
+			txt = doc.createTextNode("");
+			name.appendChild(txt);
+			txt = doc.createTextNode("");
+			tgtID.appendChild(txt);
+			txt = doc.createTextNode("");
+			polygon.appendChild(txt);
+		}
+
+		//deleted
+		txt = doc.createTextNode("0");
+		deleted.appendChild(txt);
+
+		//verified
+		txt = doc.createTextNode("1");
+		verified.appendChild(txt);
+
+		obj.appendChild(bbox);
+		obj.appendChild(name);
+		obj.appendChild(tgtID);
+		obj.appendChild(polygon);
+		obj.appendChild(deleted);
+		obj.appendChild(verified);
+
+		root.appendChild(obj);
+	}
+
+
+
+	QString num;
+	num.sprintf("%05d",frame);
+	QString fname = path + "/" + settings.fileNamePrefix + num + ".xml";
+	QFile fd(fname);
+	if(!fd.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+
+	QTextStream out(&fd);
+	out << doc;
+	fd.close();
+	return true;
+}
+
+bool Exporter::exportFrameToLabelMeXML(const ExportSettings &settings, const LabelSnapshot &labels, const QList<int> &rows, QString path, int frame, TarWriter *archive)
+{
+	QSize origSz = settings.imageSize;
+
+	QDomDocument doc("");
+	QDomElement root = doc.createElement("annotation");
+	doc.appendChild(root);
+
+	//filename
+	QDomElement tmp = doc.createElement("filename");
+	QDomText txt = doc.createTextNode(settings.fileName);
+	tmp.appendChild(txt);
+	root.appendChild(tmp);
+
+	//folder
+	tmp = doc.createElement("folder");
+	txt = doc.createTextNode(settings.path);
+	tmp.appendChild(txt);
+	root.appendChild(tmp);
+
+	//frame
+	tmp = doc.createElement("frame");
+	txt = doc.createTextNode(QString("%1").arg(frame));
+	tmp.appendChild(txt);
+	root.appendChild(tmp);
+
+	//source
+	QDomElement src = doc.createElement("source");
+	//sourceImage
+	tmp = doc.createElement("sourceImage");
+	txt = doc.createTextNode("");
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//sourceAnnotation
+	tmp = doc.createElement("sourceAnnotation");
+	txt = doc.createTextNode("");
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//sensor
+	tmp = doc.createElement("sensor");
+	txt = doc.createTextNode("");
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//sensorType
+	tmp = doc.createElement("sensorType");
+	txt = doc.createTextNode("");
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//scenario
+	tmp = doc.createElement("scenario");
+	txt = doc.createTextNode("");
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//day
+	tmp = doc.createElement("day");
+	txt = doc.createTextNode("");
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//clip
+	tmp = doc.createElement("clip");
+	txt = doc.createTextNode("");
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//sampleSet
+	tmp = doc.createElement("sampleSet");
+	txt = doc.createTextNode("");
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//numberFrames
+	tmp = doc.createElement("numberFrames");
+	txt = doc.createTextNode(QString::number(settings.frameCount));
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//duration
+	tmp = doc.createElement("duration");
+	txt = doc.createTextNode("");
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//FrameRate
+	tmp = doc.createElement("FrameRate");
+	txt = doc.createTextNode("");
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+
+	root.appendChild(src);
+
+
+	//imagesize
+	src = doc.createElement("imagesize");
+	//rows
+	tmp = doc.createElement("rows");
+	txt = doc.createTextNode(QString::number(origSz.height()));
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//columns
+	tmp = doc.createElement("columns");
+	txt = doc.createTextNode(QString::number(origSz.width()));
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	//channels
+	tmp = doc.createElement("channels");
+	txt = doc.createTextNode(QString::number(3));
+	tmp.appendChild(txt);
+	src.appendChild(tmp);
+	root.appendChild(src);
+
+
+	QDomElement obj;
+	const Label *lb;
+	for(int a = 0; a < rows.count(); a++)
+	{
+		lb = &labels[rows[a]];
+		if(lb->boxes.isEmpty() && lb->polygons.isEmpty())
+			continue;
+
+		//object
+		obj = doc.createElement("object");
+
+		//bbox
+		QDomElement bbox = doc.createElement("bbox");
+		//center
+		QDomElement center = doc.createElement("center");
+		//size
+		QDomElement size = doc.createElement("size");
+		//obscuration
+		QDomElement obscuration = doc.createElement("obscuration");
+		//view
+		QDomElement view = doc.createElement("view");
+		//name
+		QDomElement name = doc.createElement("name");
+		//tgtID
+		QDomElement tgtID = doc.createElement("tgtID");
+		//polygon
+		QDomElement polygon = doc.createElement("polygon");
+		//eccentricity
+		QDomElement eccentricity = doc.createElement("eccentricity");
+		//deleted
+		QDomElement deleted = doc.createElement("deleted");
+		//verified
+		QDomElement verified = doc.createElement("verified");
+
+		ViaPoint box;
+		SmallPolygon shape;
+		if(lb->boxAt(frame, box) && lb->polygonAt(frame, shape))
+		{
+			QRect b = CommonFunctions::imageToImage(settings.displaySize.width(), settings.displaySize.height(), box.rc, origSz.width(), origSz.height());
+			
+			QDomElement pt = doc.createElement("pt");
+			QDomElement x = doc.createElement("x");
+			QDomElement y = doc.createElement("y");
+
+			//top left
+			txt = doc.createTextNode(QString::number(b.left()));
+			x.appendChild(txt);
+			txt = doc.createTextNode(QString::number(b.top()));
+			y.appendChild(txt);
+			pt.appendChild(x);
+			pt.appendChild(y);
+			bbox.appendChild(pt);
+
+			//top right
+			pt = doc.createElement("pt");
+			x = doc.createElement("x");
+			y = doc.createElement("y");
+
+			txt = doc.createTextNode(QString::number(b.right()));
+			x.appendChild(txt);
+			txt = doc.createTextNode(QString::number(b.top()));
+			y.appendChild(txt);
+			pt.appendChild(x);
+			pt.appendChild(y);
+			bbox.appendChild(pt);
+
+			//bottom right
+			pt = doc.createElement("pt");
+			x = doc.createElement("x");
+			y = doc.createElement("y");
+
+			txt = doc.createTextNode(QString::number(b.right()));
+			x.appendChild(txt);
+			txt = doc.createTextNode(QString::number(b.bottom()));
+			y.appendChild(txt);
+			pt.appendChild(x);
+			pt.appendChild(y);
+			bbox.appendChild(pt);
+
+			//bottom left
+			pt = doc.createElement("pt");
+			x = doc.createElement("x");
+			y = doc.createElement("y");
+
+			txt = doc.createTextNode(QString::number(b.left()));
+			x.appendChild(txt);
+			txt = doc.createTextNode(QString::number(b.bottom()));
+			y.appendChild(txt);
+			pt.appendChild(x);
+			pt.appendChild(y);
+			bbox.appendChild(pt);
+
+			//top left
+			pt = doc.createElement("pt");
+			x = doc.createElement("x");
+			y = doc.createElement("y");
+
+			txt = doc.createTextNode(QString::number(b.left()));
+			x.appendChild(txt);
+			txt = doc.createTextNode(QString::number(b.top()));
+			y.appendChild(txt);
+			pt.appendChild(x);
+			pt.appendChild(y);
+			bbox.appendChild(pt);
+
+			//center
+			x = doc.createElement("x");
+			y = doc.createElement("y");
+
+			txt = doc.createTextNode(QString::number((b.left() + b.right())/2));
+			x.appendChild(txt);
+			txt = doc.createTextNode(QString::number((b.top() + b.bottom())/2));
+			y.appendChild(txt);
+
+			center.appendChild(x);
+			center.appendChild(y);
+
+			//size
+			x = doc.createElement("x");
+			y = doc.createElement("y");
+
+			txt = doc.createTextNode(QString::number(b.width()));
+			x.appendChild(txt);
+			txt = doc.createTextNode(QString::number(b.height()));
+			y.appendChild(txt);
+
+			size.appendChild(x);
+			size.appendChild(y);
+
+			//obscuration
+			txt = doc.createTextNode("unobscured");
+			obscuration.appendChild(txt);
+			
+			//view
+			txt = doc.createTextNode("");
+			view.appendChild(txt);
+
+			//name
+			txt = doc.createTextNode(lb->name);
+			name.appendChild(txt);
+
+			//tgtID
+			txt = doc.createTextNode(QString::number(lb->number));
+			tgtID.appendChild(txt);
+
+			//polygon
+			if(lb->shape == Rect)
+			{
+				pt = doc.createElement("pt");
+				x = doc.createElement("x");
+				y = doc.createElement("y");
+
+				txt = doc.createTextNode(QString::number(b.left()));
+				x.appendChild(txt);
+				txt = doc.createTextNode(QString::number(b.top()));
+				y.appendChild(txt);
+				pt.appendChild(x);
+				pt.appendChild(y);
+				polygon.appendChild(pt);
+			}
+			else if(lb->shape == Polyg)
+			{
+				SmallPolygon pl = CommonFunctions::imageToImage(settings.displaySize.width(), settings.displaySize.height(), shape, origSz.width(), origSz.height());
+				for(int pi = 0; pi < pl.count(); pi++)
+				{
+					pt = doc.createElement("pt");
+					x = doc.createElement("x");
+					y = doc.createElement("y");
+
+					QPoint pl_pt = pl.point(pi);
+					txt = doc.createTextNode(QString::number(pl_pt.x()));
+					x.appendChild(txt);
+					txt = doc.createTextNode(QString::number(pl_pt.y()));
+					y.appendChild(txt);
+					pt.appendChild(x);
+					pt.appendChild(y);
+					polygon.appendChild(pt);
+				}
+			}
+			
+
+			//eccentricity
+			float sm = qMin(b.width(), b.height());
+			float bg = qMax(b.width(), b.height());
+			txt = doc.createTextNode(QString::number(bg/sm));
+			eccentricity.appendChild(txt);
+		}
+		else
+		{
+			txt = doc.createTextNode("");
+			bbox.appendChild(txt);
+			txt = doc.createTextNode("");
+			center.appendChild(txt);
+			txt = doc.createTextNode("");
+			size.appendChild(txt);
+			txt = doc.createTextNode("");
+			obscuration.appendChild(txt);
+			txt = doc.createTextNode("");
+			name.appendChild(txt);
+			txt = doc.createTextNode("");
+			tgtID.appendChild(txt);
+			txt = doc.createTextNode("");
+			polygon.appendChild(txt);
+			txt = doc.createTextNode("");
+			eccentricity.appendChild(txt);
+		}
+
+		//deleted
+		txt = doc.createTextNode("0");
+		deleted.appendChild(txt);
+
+		//verified
+		txt = doc.createTextNode("1");
+		verified.appendChild(txt);
+
+		obj.appendChild(bbox);
+		obj.appendChild(center);
+		obj.appendChild(size);
+		obj.appendChild(obscuration);
+		obj.appendChild(view);
+		obj.appendChild(name);
+		obj.appendChild(tgtID);
+		obj.appendChild(polygon);
+		obj.appendChild(eccentricity);
+		obj.appendChild(deleted);
+		obj.appendChild(verified);
+
+		root.appendChild(obj);
+	}
+
+
+
+	QString num;
+	num.sprintf("%05d",frame);
+	QString name = settings.fileNamePrefix + num + ".xml";
+	if(archive != NULL)
+	{
+		QByteArray data;
+		QTextStream out(&data, QIODevice::WriteOnly);
+		out << doc;
+		out.flush();
+		return archive->addFile(name, data);
+	}
+
+	QFile fd(path + "/" + name);
+	if(!fd.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+
+	QTextStream out(&fd);
+	out << doc;
+	fd.close();
+	return true;
+}
@@ -0,0 +1,195 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QTime>
+#include <opencv\cv.h>
+#include <opencv\highgui.h>
+#include "Constants.h"
+#include "LabelStore.h"
+#include "FrameReader.h"
+#include "FrameRangeSet.h"
+#include "TarWriter.h"
+
+//minimal time between two progress reports of a running export, in ms
+#define EXPORT_PROGRESS_INTERVAL	100
+//LabelMe frames queued per thread of the export pool
+#define LABELME_FRAMES_PER_THREAD	4
+//movie frames in the export pipeline per thread working on it
+#define MOVIE_FRAMES_PER_THREAD		2
+//mask frames rasterized by one job of the mask export, they share one raster
+#define MASK_FRAMES_PER_JOB			8
+//joins the segments of segmented avi exports
+#define FFMPEG_EXECUTABLE			"ffmpeg"
+
+enum ExportFormat
+{
+	ExportBlackBackground,
+	ExportOriginalImages,
+	ExportMatlabStruct,
+	ExportSimpleLabelXML,
+	ExportLabelMeXML,
+	ExportInstanceMasks,	//one id per label
+	ExportSemanticMasks,	//one id per label name
+	ExportNumpy
+};
+
+//file format of the image sequences written by the movie exports, in the
+//order of the save dialog's list
+enum ImageSequenceFormat
+{
+	ImagePngFast,		//lowest zlib level
+	ImagePngSmall,		//highest zlib level
+	ImageTiff,			//LZW compressed
+	ImageBmp
+};
+
+//everything an export needs besides the labels, filled in from the save dialog
+struct ExportSettings
+{
+	ExportSettings() : format(ExportSimpleLabelXML), saveAsAvi(false), imageFormat(ImagePngFast), segments(1), firstFrame(0), lastFrame(-1), frameCount(0), fps(30), changedOnly(false), archive(false) {}
+
+	ExportFormat format;
+	bool saveAsAvi;		//movie exports write an avi instead of an image sequence
+	ImageSequenceFormat imageFormat;
+	QString codec;		//fourcc of the avi codec, empty for the default one
+	int segments;		//avi parts encoded in parallel and joined at the end
+	QString saveFile;
+	QString structName;	//name of the matlab structure
+	int firstFrame;
+	int lastFrame;
+	int frameCount;		//frames in the labeled sequence
+	int fps;
+	QSize displaySize;	//size of the image the labels are defined in
+	QSize imageSize;	//size of the original images
+	QString fileName;	//labeled sequence
+	QString path;
+	QString fileNamePrefix;
+	bool changedOnly;	//per frame exports only rewrite changedFrames, the other files are up to date
+	FrameRangeSet changedFrames;
+	bool archive;		//per frame files go into the tar archive of archiveFile()
+};
+
+//Cancellation and progress of a running export. The default implementation
+//ignores the progress, so the export functions can also be called directly.
+class ExportControl
+{
+public:
+	ExportControl(const QAtomicInt *cancel = NULL) : mCancel(cancel) {}
+	virtual ~ExportControl() {}
+
+	bool isCancelled() const { return mCancel != NULL && *mCancel != 0; }
+	const QAtomicInt *cancelToken() const { return mCancel; }
+	virtual void progress(int done, int total) { Q_UNUSED(done); Q_UNUSED(total); }
+
+	QString error;
+	QString summary;	//reported instead of the default message when the export succeeds
+
+private:
+	const QAtomicInt *mCancel;
+};
+
+//Runs exports on a worker thread over a snapshot of the labels, so labeling
+//can go on while an export is running. Only one export runs at a time.
+class Exporter : public QObject
+{
+	Q_OBJECT
+
+public:
+	Exporter(QObject *parent = NULL);
+	virtual ~Exporter();
+
+	//Must be called from the GUI thread, the avi writers and the frame readers
+	//of the avi segments are created here. Returns false if an export is
+	//already running.
+	bool start(const ExportSettings &settings, const LabelSnapshot &labels, QSharedPointer<FrameReader> reader);
+	bool isRunning() const { return mRunning; }
+
+	//movie, mask and LabelMe exports count frames, the others count labels
+	static bool countsFrames(ExportFormat format);
+	static QString imageExtension(ImageSequenceFormat format);
+	//exports writing a file per frame can rewrite only the changed frames and
+	//can write into an archive
+	static bool writesFilePerFrame(ExportFormat format, bool saveAsAvi);
+	static FrameRangeSet framesToWrite(const ExportSettings &settings);
+	//the prefix of the save file with .tar, the index is next to it
+	static QString archiveFile(const ExportSettings &settings);
+	//avi writer with the codec of the settings, NULL if it can't be created
+	static CvVideoWriter *createVideoWriter(const ExportSettings &settings, const QString &file);
+	static QString segmentFile(const QString &saveFile, int segment);
+
+	//Runs the export in the calling thread, returns false on failure or cancellation.
+	//Avi exports get one writer and one reader per segment, the released
+	//writers are set to NULL.
+	static bool run(const ExportSettings &settings, const LabelSnapshot &labels, const QList<FrameReader*> &readers, QList<CvVideoWriter*> &writers, ExportControl &ctl);
+	static bool exportMovie(const ExportSettings &settings, const LabelSnapshot &labels, FrameReader *reader, CvVideoWriter *writer, ExportControl &ctl);
+	//runs the decoder and the renderers on the stages pool, which may be shared by several exports
+	static bool exportMovie(const ExportSettings &settings, const LabelSnapshot &labels, FrameReader *reader, CvVideoWriter *writer,
+		ExportControl &ctl, QThreadPool *stages, int renderers);
+	static bool exportMovieSegments(const ExportSettings &settings, const LabelSnapshot &labels, const QList<FrameReader*> &readers,
+		QList<CvVideoWriter*> &writers, ExportControl &ctl);
+	//joins the segment files with ffmpeg, a cancelled join removes them
+	static bool concatSegments(const QStringList &files, const QString &saveFile, ExportControl &ctl);
+	//binary MAT-file for .mat files, a function returning the structure otherwise
+	static bool exportMatlabStruct(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl);
+	static bool exportMatlabScript(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl);
+	static bool exportMatFile(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl);
+	static bool exportSimpleLabelXML(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl);
+	static bool exportLabelMeXML(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl);
+	//Label id images, 8 bit png if the ids fit, 16 bit pgm otherwise. The ids
+	//are listed in a text file next to the images.
+	static bool exportMasks(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl);
+	static bool exportNumpy(const ExportSettings &settings, const LabelSnapshot &labels, ExportControl &ctl);
+	//the file goes into the archive instead of path if one is given
+	static bool exportFrameToLabelMeXML(const ExportSettings &settings, const LabelSnapshot &labels, const QList<int> &rows, QString path, int frame, TarWriter *archive = NULL);
+	static bool exportFrameToLabelMeXMLWebTool(const ExportSettings &settings, const LabelSnapshot &labels, QString path, int frame);
+
+public slots:
+	void cancel();
+
+signals:
+	//rate is the number of frames or labels exported per second
+	void progress(int done, int total, double rate);
+	void finished(bool ok, QString message);
+
+private slots:
+	void onProgress(int done, int total);
+	void onFinished(bool ok, QString message);
+
+private:
+	friend class ExportJob;
+	typedef QSharedPointer<QAtomicInt> CancelToken;
+
+	QThreadPool mPool;
+	CancelToken mToken;
+	QTime mTimer;
+	bool mRunning;
+};
+
+#endif
@@ -0,0 +1,66 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "FileSync.h"
+#include <QFileInfo>
+#include <QDir>
+#ifdef Q_OS_WIN
+#include <io.h>
+#include <windows.h>
+#else
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool FileSync::sync(QFile &fd)
+{
+	if(!fd.flush())
+		return false;
+#if defined(Q_OS_WIN)
+	return _commit(fd.handle()) == 0;
+#elif defined(Q_OS_LINUX)
+	return fdatasync(fd.handle()) == 0;
+#else
+	return fsync(fd.handle()) == 0;
+#endif
+}
+
+bool FileSync::replace(const QString &from, const QString &to)
+{
+#if defined(Q_OS_WIN)
+	return MoveFileExW((const wchar_t*)QDir::toNativeSeparators(from).utf16(), (const wchar_t*)QDir::toNativeSeparators(to).utf16(),
+		MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	if(::rename(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) != 0)
+		return false;
+	//the rename is only durable once the directory is synced as well
+	int dir = ::open(QFile::encodeName(QFileInfo(to).absolutePath()).constData(), O_RDONLY);
+	if(dir >= 0)
+	{
+		fsync(dir);
+		::close(dir);
+	}
+	return true;
+#endif
+}
@@ -0,0 +1,43 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef FILESYNC_H
+#define FILESYNC_H
+
+#include <QFile>
+#include <QString>
+
+//Durable file updates shared by the project file, the edit journal and the
+//tar index. A file is written next to its target, synced and then renamed
+//over the target, so a crash leaves either the old or the new file.
+class FileSync
+{
+public:
+	//flushes the file and waits until the data is on the disk
+	static bool sync(QFile &fd);
+	//Replaces the target with the file in one step and waits until the
+	//rename is on the disk. The file has to be synced already.
+	static bool replace(const QString &from, const QString &to);
+};
+
+#endif
@@ -0,0 +1,198 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "FrameRangeSet.h"
+
+void FrameRangeSet::add(int first, int last)
+{
+	if(first > last)
+		return;
+
+	//a run starting before first may overlap or touch the new one
+	QMap<int, int>::iterator it = mRuns.upperBound(first);
+	if(it != mRuns.begin())
+	{
+		QMap<int, int>::iterator prev = it - 1;
+		if(prev.value() >= first - 1)
+		{
+			first = prev.key();
+			last = qMax(last, prev.value());
+			it = mRuns.erase(prev);
+		}
+	}
+	//runs starting inside the new one or right after it are swallowed
+	while(it != mRuns.end() && it.key() <= last + 1)
+	{
+		last = qMax(last, it.value());
+		it = mRuns.erase(it);
+	}
+	mRuns.insert(first, last);
+}
+
+void FrameRangeSet::add(const FrameRangeSet &other)
+{
+	for(QMap<int, int>::const_iterator it = other.mRuns.constBegin(); it != other.mRuns.constEnd(); ++it)
+	{
+		add(it.key(), it.value());
+	}
+}
+
+bool FrameRangeSet::contains(int frame) const
+{
+	return runEnd(frame) >= 0;
+}
+
+int FrameRangeSet::nextFrame(int frame) const
+{
+	QMap<int, int>::const_iterator it = mRuns.upperBound(frame);
+	if(it != mRuns.constBegin() && (it - 1).value() >= frame)
+		return frame;
+	return it == mRuns.constEnd() ? INT_MAX : it.key();
+}
+
+int FrameRangeSet::runEnd(int frame) const
+{
+	QMap<int, int>::const_iterator it = mRuns.upperBound(frame);
+	if(it == mRuns.constBegin())
+		return -1;
+	--it;
+	return it.value() >= frame ? it.value() : -1;
+}
+
+int FrameRangeSet::frameCount() const
+{
+	int n = 0;
+	for(QMap<int, int>::const_iterator it = mRuns.constBegin(); it != mRuns.constEnd(); ++it)
+	{
+		n += it.value() - it.key() + 1;
+	}
+	return n;
+}
+
+FrameRangeSet FrameRangeSet::intersected(int first, int last) const
+{
+	FrameRangeSet res;
+	for(QMap<int, int>::const_iterator it = mRuns.constBegin(); it != mRuns.constEnd(); ++it)
+	{
+		res.add(qMax(it.key(), first), qMin(it.value(), last));
+	}
+	return res;
+}
+
+static bool sameItem(const ViaPoint &a, const ViaPoint &b)
+{
+	return a.frame == b.frame && a.angle == b.angle && a.rc == b.rc;
+}
+
+static bool sameItem(const ViaPointPolygon &a, const ViaPointPolygon &b)
+{
+	return a.frame == b.frame && a.pl == b.pl;
+}
+
+//all frames of a dense track
+template<class List>
+static void addTrack(FrameRangeSet &set, const List &track)
+{
+	if(!track.isEmpty())
+		set.add(track.first().frame, track.last().frame);
+}
+
+//frames where two dense tracks differ, a frame only one of them covers differs too
+template<class T>
+static void addChangedTrack(FrameRangeSet &set, const BlockList<T> &a, const BlockList<T> &b)
+{
+	if(a.isEmpty() || b.isEmpty())
+	{
+		addTrack(set, a);
+		addTrack(set, b);
+		return;
+	}
+
+	int a0 = a.first().frame;
+	int b0 = b.first().frame;
+	int first = qMin(a0, b0);
+	int last = qMax(a.last().frame, b.last().frame);
+	int run = -1;
+	for(int t = first; t <= last; t++)
+	{
+		int i = t - a0;
+		int k = t - b0;
+		bool inA = i >= 0 && i < a.count();
+		bool inB = k >= 0 && k < b.count();
+
+		//segments that weren't rebuilt are still shared and skipped as a whole
+		int ba = inA && inB ? a.blockAt(i) : -1;
+		int bb = ba >= 0 ? b.blockAt(k) : -1;
+		if(bb >= 0 && a.block(ba).constData() == b.block(bb).constData())
+		{
+			if(run >= 0)
+				set.add(run, t - 1);
+			run = -1;
+			t += a.block(ba).count() - 1;
+			continue;
+		}
+
+		bool same = inA == inB && (!inA || sameItem(a[i], b[k]));
+		if(!same && run < 0)
+		{
+			run = t;
+		}
+		else if(same && run >= 0)
+		{
+			set.add(run, t - 1);
+			run = -1;
+		}
+	}
+	if(run >= 0)
+		set.add(run, last);
+}
+
+FrameRangeSet FrameRangeSet::changedFrames(const QList<Label> &a, const QList<Label> &b)
+{
+	FrameRangeSet set;
+	int n = qMax(a.count(), b.count());
+	for(int i = 0; i < n; i++)
+	{
+		if(i >= b.count() || i >= a.count())
+		{
+			const Label &lb = i < a.count() ? a[i] : b[i];
+			addTrack(set, lb.boxes);
+			addTrack(set, lb.polygons);
+			continue;
+		}
+
+		const Label &x = a[i];
+		const Label &y = b[i];
+		if(x.number != y.number || x.name != y.name || x.desc != y.desc || x.shape != y.shape)
+		{
+			addTrack(set, x.boxes);
+			addTrack(set, x.polygons);
+			addTrack(set, y.boxes);
+			addTrack(set, y.polygons);
+			continue;
+		}
+		addChangedTrack(set, x.boxes, y.boxes);
+		addChangedTrack(set, x.polygons, y.polygons);
+	}
+	return set;
+}
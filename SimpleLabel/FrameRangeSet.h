@@ -0,0 +1,67 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef FRAMERANGESET_H
+#define FRAMERANGESET_H
+
+#include <QMap>
+#include <QList>
+#include <limits.h>
+#include "Constants.h"
+
+//Set of frames kept as sorted, disjoint runs of consecutive frames, so long
+//spans cost as little as single frames. Used to find the frames whose
+//exported files are out of date.
+class FrameRangeSet
+{
+public:
+	FrameRangeSet() {}
+	FrameRangeSet(int first, int last) { add(first, last); }
+
+	//adds the frames first..last, runs that touch are merged
+	void add(int first, int last);
+	void add(const FrameRangeSet &other);
+	void clear() { mRuns.clear(); }
+
+	bool isEmpty() const { return mRuns.isEmpty(); }
+	bool contains(int frame) const;
+	//first frame of the set that is not before frame, INT_MAX if there is none
+	int nextFrame(int frame) const;
+	//last frame of the run holding frame, -1 if the frame isn't in the set
+	int runEnd(int frame) const;
+	int runCount() const { return mRuns.count(); }
+	int frameCount() const;
+	FrameRangeSet intersected(int first, int last) const;
+
+	//Frames whose labels differ between the two label lists, compared row by
+	//row. Labels that share their tracks are skipped without looking at them,
+	//for the others only the frames where the dense tracks differ are added,
+	//which is the span between the neighbours of an edited via point. A label
+	//that was renamed or changed its shape adds all of its frames.
+	static FrameRangeSet changedFrames(const QList<Label> &a, const QList<Label> &b);
+
+private:
+	QMap<int, int> mRuns;	//first frame of every run to its last frame
+};
+
+#endif
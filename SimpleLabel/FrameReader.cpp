@@ -0,0 +1,172 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "FrameReader.h"
+
+FrameReader::FrameReader(QString fileName)
+{
+	QString name;
+	mCvCapture = NULL;
+	mInputType = None;
+	mNextFrame = -1;
+	mFileName = fileName;
+
+	CommonFunctions::splitPath(fileName, mPath, name, mFileNamePrefix, (uint)5, mFirstFrameNumber, mExtention);
+
+	if(mExtention == ".avi")
+	{
+		mFirstFrameNumber = 0;
+		mCvCapture = cvCaptureFromFile(fileName.toAscii());
+		if(mCvCapture)
+		{
+			mInputType = AviFile;
+			mSize = QSize((int)cvGetCaptureProperty(mCvCapture, CV_CAP_PROP_FRAME_WIDTH),
+				(int)cvGetCaptureProperty(mCvCapture, CV_CAP_PROP_FRAME_HEIGHT));
+		}
+	}
+	else
+	{
+		QImage im(fileName);
+		if(!im.isNull())
+		{
+			mInputType = ImageSequence;
+			mSize = im.size();
+		}
+	}
+}
+
+FrameReader::~FrameReader()
+{
+	if(mCvCapture)
+	{
+		cvReleaseCapture(&mCvCapture);
+	}
+}
+
+QImage FrameReader::read(int frame)
+{
+	QImage res;
+
+	if(mInputType == AviFile)
+	{
+		QMutexLocker lock(&mCaptureMutex);
+		IplImage *im = queryFrame(frame);
+		if(im)
+		{
+			res = QImage(im->width, im->height, QImage::Format_ARGB32);
+			for(int y = 0; y < im->height; y++)
+			{
+				const uchar *data = (const uchar*)im->imageData + y*im->widthStep;
+				uchar *line = res.scanLine(y);
+				for(int x = 0; x < im->width; x++)
+				{
+					memcpy(line, data, 3*sizeof(uchar));
+					line[3] = 255;
+
+					data += im->nChannels;
+					line += 4;
+				}
+			}
+		}
+	}
+	else if(mInputType == ImageSequence)
+	{
+		if(mFirstFrameNumber < 0)
+		{
+			res.load(mFileName);
+		}
+		else
+		{
+			res.load(mPath + mFileNamePrefix + QString("%1").arg(frame, 5, 10, QChar('0')) + mExtention);
+		}
+	}
+
+	return res;
+}
+
+GrayImage FrameReader::readGray(int frame, QSize sz)
+{
+	if(mInputType != AviFile)
+		return GrayImage(read(frame), sz);
+
+	GrayImage res;
+	QMutexLocker lock(&mCaptureMutex);
+	IplImage *im = queryFrame(frame);
+	if(im == NULL || sz.isEmpty())
+		return res;
+
+	//nearest neighbour sampling of the bgr frame, as the scaling of GrayImage
+	res.width = sz.width();
+	res.height = sz.height();
+	res.px.resize(res.width*res.height);
+	uchar *dst = res.px.data();
+	for(int y = 0; y < res.height; y++)
+	{
+		const uchar *line = (const uchar*)im->imageData + (y*im->height/res.height)*im->widthStep;
+		for(int x = 0; x < res.width; x++)
+		{
+			const uchar *p = line + (x*im->width/res.width)*im->nChannels;
+			*dst++ = (uchar)qGray(p[2], p[1], p[0]);
+		}
+	}
+	return res;
+}
+
+//the capture lock is held by the caller
+IplImage *FrameReader::queryFrame(int frame)
+{
+	if(frame != mNextFrame)
+		cvSetCaptureProperty(mCvCapture, CV_CAP_PROP_POS_FRAMES, frame);
+	IplImage *im = cvQueryFrame(mCvCapture);
+	mNextFrame = im ? frame + 1 : -1;
+	return im;
+}
+
+FrameReaderPool::FrameReaderPool(const QString &fileName, int count)
+{
+	for(int i = 0; i < qMax(count, 1); i++)
+	{
+		mReaders << new FrameReader(fileName);
+	}
+	mFree = mReaders;
+	mAvailable.release(mReaders.count());
+}
+
+FrameReaderPool::~FrameReaderPool()
+{
+	qDeleteAll(mReaders);
+}
+
+FrameReader *FrameReaderPool::acquire()
+{
+	mAvailable.acquire();
+	QMutexLocker lock(&mMutex);
+	return mFree.takeLast();
+}
+
+void FrameReaderPool::release(FrameReader *reader)
+{
+	QMutexLocker lock(&mMutex);
+	mFree << reader;
+	mAvailable.release();
+}
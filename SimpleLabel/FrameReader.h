@@ -0,0 +1,97 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef FRAMEREADER_H
+#define FRAMEREADER_H
+
+#include <QImage>
+#include <QMutex>
+#include <QSemaphore>
+#include <QList>
+#include <QString>
+#include <opencv\cv.h>
+#include <opencv\highgui.h>
+#include "Constants.h"
+#include "GrayImage.h"
+
+//Reads frames of the opened avi file or image sequence independently of the
+//Monitor, so that worker threads can fetch frames while the GUI keeps
+//displaying its own. Must be created in the GUI thread because opencv can't
+//open a capture from a child thread; read() may be called from any thread.
+//
+//The reads of an avi file go through the one capture of the reader, one at a
+//time. Reading the frames in order decodes them without seeking.
+class FrameReader
+{
+public:
+	FrameReader(QString fileName);
+	~FrameReader();
+
+	bool isValid() const { return mInputType != None; }
+	QString fileName() const { return mFileName; }
+	int firstFrame() const { return mFirstFrameNumber; }
+	QSize imageSize() const { return mSize; }
+
+	QImage read(int frame);
+	//grayscale copy of the frame scaled to sz, without the full size color copy
+	GrayImage readGray(int frame, QSize sz);
+
+private:
+	Q_DISABLE_COPY(FrameReader)
+
+	IplImage *queryFrame(int frame);
+
+	InputType mInputType;
+	CvCapture *mCvCapture;
+	QMutex mCaptureMutex;
+	int mNextFrame;	//frame the capture decodes next without seeking
+	QString mFileName;
+	QString mPath;
+	QString mFileNamePrefix;
+	QString mExtention;
+	int mFirstFrameNumber;
+	QSize mSize;
+};
+
+//Readers of one file for the worker threads of a pool, so every job decodes
+//through a capture of its own. Created in the GUI thread like the readers.
+class FrameReaderPool
+{
+public:
+	FrameReaderPool(const QString &fileName, int count);
+	~FrameReaderPool();
+
+	//waits until a reader is free
+	FrameReader *acquire();
+	void release(FrameReader *reader);
+
+private:
+	Q_DISABLE_COPY(FrameReaderPool)
+
+	QList<FrameReader*> mReaders;
+	QList<FrameReader*> mFree;
+	QMutex mMutex;
+	QSemaphore mAvailable;
+};
+
+#endif
@@ -0,0 +1,97 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "GrayImage.h"
+
+GrayImage::GrayImage(const QImage &im, QSize sz)
+{
+	width = 0;
+	height = 0;
+	if(im.isNull() || sz.isEmpty())
+		return;
+
+	QImage tmp = im.scaled(sz, Qt::IgnoreAspectRatio, Qt::FastTransformation).convertToFormat(QImage::Format_RGB32);
+	width = tmp.width();
+	height = tmp.height();
+	px.resize(width*height);
+
+	uchar *dst = px.data();
+	for(int y = 0; y < height; y++)
+	{
+		const QRgb *line = (const QRgb*)tmp.constScanLine(y);
+		for(int x = 0; x < width; x++)
+		{
+			*dst++ = (uchar)qGray(line[x]);
+		}
+	}
+}
+
+void GrayImage::samplePatch(double cx, double cy, double bw, double bh, int *out) const
+{
+	int sum = 0;
+	const uchar *data = px.constData();
+
+	for(int j = 0; j < PATCH_GRID; j++)
+	{
+		int y = qBound(0, (int)(cy - bh/2 + (j + 0.5)*bh/PATCH_GRID), height - 1);
+		const uchar *line = data + y*width;
+		for(int i = 0; i < PATCH_GRID; i++)
+		{
+			int x = qBound(0, (int)(cx - bw/2 + (i + 0.5)*bw/PATCH_GRID), width - 1);
+			out[j*PATCH_GRID + i] = line[x];
+			sum += line[x];
+		}
+	}
+
+	int mean = sum/PATCH_SIZE;
+	for(int i = 0; i < PATCH_SIZE; i++)
+	{
+		out[i] -= mean;
+	}
+}
+
+//the loops below have fixed trip counts and no branches so the compiler can vectorize them
+int GrayImage::patchDistance(const int *a, const int *b)
+{
+	int res = 0;
+	for(int i = 0; i < PATCH_SIZE; i++)
+	{
+		res += qAbs(a[i] - b[i]);
+	}
+	return res;
+}
+
+double GrayImage::patchSimilarity(const int *a, const int *b)
+{
+	int energy = 0;
+	for(int i = 0; i < PATCH_SIZE; i++)
+	{
+		energy += qAbs(a[i]) + qAbs(b[i]);
+	}
+	//two flat patches look the same
+	if(energy == 0)
+		return 1.0;
+
+	//the distance never exceeds the summed energy of both patches
+	return 1.0 - (double)patchDistance(a, b)/energy;
+}
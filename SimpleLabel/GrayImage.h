@@ -0,0 +1,56 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef GRAYIMAGE_H
+#define GRAYIMAGE_H
+
+#include <QImage>
+#include <QVector>
+
+//number of samples along each side of the compared patches
+#define PATCH_GRID	16
+#define PATCH_SIZE	(PATCH_GRID*PATCH_GRID)
+
+//Grayscale copy of a frame at a reduced resolution, used for cheap patch
+//comparisons by the motion tracker and the drift analyzer.
+struct GrayImage
+{
+	int width;
+	int height;
+	QVector<uchar> px;
+
+	GrayImage() : width(0), height(0) {}
+	GrayImage(const QImage &im, QSize sz);
+
+	bool isNull() const { return px.isEmpty(); }
+
+	//samples the box centred at (cx, cy) on a PATCH_GRID x PATCH_GRID grid and removes the mean
+	void samplePatch(double cx, double cy, double bw, double bh, int *out) const;
+
+	//sum of absolute differences of two sampled patches
+	static int patchDistance(const int *a, const int *b);
+	//1 for identical patches, 0 for unrelated ones
+	static double patchSimilarity(const int *a, const int *b);
+};
+
+#endif
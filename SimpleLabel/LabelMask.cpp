@@ -0,0 +1,241 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "LabelMask.h"
+#include <QFile>
+#include <QtEndian>
+#include <QtAlgorithms>
+#include <QTransform>
+#include <QVarLengthArray>
+#include <math.h>
+
+//first row or column whose pixel centre is at or after v
+static inline int firstCentreAt(double v)
+{
+	return (int)ceil(v - 0.5);
+}
+
+LabelMask::LabelMask(int width, int height)
+	: mWidth(qMax(width, 0)), mHeight(qMax(height, 0))
+{
+	mPx.fill(0, mWidth*mHeight);
+	//reserved buffers keep their memory when they are resized to 0
+	mEdges.reserve(2*SMALL_POLYGON_SIZE);
+	mActive.reserve(2*SMALL_POLYGON_SIZE);
+	mCrossings.reserve(2*SMALL_POLYGON_SIZE);
+}
+
+void LabelMask::clear()
+{
+	mPx.fill(0);
+}
+
+void LabelMask::fillRect(int x0, int y0, int x1, int y1, quint16 id)
+{
+	x0 = qMax(x0, 0);
+	y0 = qMax(y0, 0);
+	x1 = qMin(x1, mWidth);
+	y1 = qMin(y1, mHeight);
+	if(x0 >= x1)
+		return;
+
+	for(int y = y0; y < y1; y++)
+	{
+		quint16 *line = mPx.data() + y*mWidth;
+		qFill(line + x0, line + x1, id);
+	}
+}
+
+bool LabelMask::edgeStartsBefore(const Edge &a, const Edge &b)
+{
+	return a.yStart < b.yStart;
+}
+
+void LabelMask::fillPolygon(const QPointF *pts, int n, quint16 id)
+{
+	if(n < 3 || isNull())
+		return;
+
+	//edge table, horizontal edges and edges between two row centres are dropped
+	mEdges.resize(0);
+	int yMin = mHeight, yMax = 0;
+	for(int i = 0; i < n; i++)
+	{
+		QPointF a = pts[i];
+		QPointF b = pts[(i + 1) % n];
+		if(a.y() > b.y())
+			qSwap(a, b);
+
+		Edge e;
+		e.yStart = qMax(firstCentreAt(a.y()), 0);
+		e.yEnd = qMin(firstCentreAt(b.y()), mHeight);
+		if(e.yStart >= e.yEnd)
+			continue;
+		e.dxdy = (b.x() - a.x())/(b.y() - a.y());
+		e.x = a.x() + (e.yStart + 0.5 - a.y())*e.dxdy;
+		mEdges << e;
+		yMin = qMin(yMin, e.yStart);
+		yMax = qMax(yMax, e.yEnd);
+	}
+	if(mEdges.isEmpty())
+		return;
+	qSort(mEdges.begin(), mEdges.end(), edgeStartsBefore);
+
+	//active edge list, the edges enter it in the order they start
+	int next = 0;
+	mActive.resize(0);
+	for(int y = yMin; y < yMax; y++)
+	{
+		while(next < mEdges.count() && mEdges[next].yStart == y)
+		{
+			mActive << mEdges[next++];
+		}
+
+		//collect the crossings of this row and drop the edges that ended above it
+		mCrossings.resize(0);
+		int kept = 0;
+		for(int i = 0; i < mActive.count(); i++)
+		{
+			Edge &e = mActive[i];
+			if(e.yEnd <= y)
+				continue;
+			mCrossings << e.x;
+			e.x += e.dxdy;
+			mActive[kept++] = e;
+		}
+		mActive.resize(kept);
+
+		//few crossings per row, insertion sort beats the general one
+		for(int i = 1; i < mCrossings.count(); i++)
+		{
+			double v = mCrossings[i];
+			int k = i;
+			for(; k > 0 && mCrossings[k - 1] > v; k--)
+			{
+				mCrossings[k] = mCrossings[k - 1];
+			}
+			mCrossings[k] = v;
+		}
+
+		quint16 *line = mPx.data() + y*mWidth;
+		for(int i = 0; i + 1 < mCrossings.count(); i += 2)
+		{
+			int x0 = qMax(firstCentreAt(mCrossings[i]), 0);
+			int x1 = qMin(firstCentreAt(mCrossings[i + 1]), mWidth);
+			if(x0 < x1)
+				qFill(line + x0, line + x1, id);
+		}
+	}
+}
+
+void LabelMask::fillBox(const ViaPoint &box, double kx, double ky, quint16 id)
+{
+	//the box covers the pixels of its rectangle, not the rectangle between the pixel centres
+	QRectF rc(box.rc.left(), box.rc.top(), box.rc.width(), box.rc.height());
+	if(box.angle == 0)
+	{
+		fillRect(firstCentreAt(rc.left()*kx), firstCentreAt(rc.top()*ky),
+			firstCentreAt(rc.right()*kx), firstCentreAt(rc.bottom()*ky), id);
+		return;
+	}
+
+	//rotated the same way as ViaPointPolygon::fromBox, then scaled, so the
+	//corners stay right when the two axes are scaled differently
+	QTransform tr;
+	tr.translate(rc.center().x(), rc.center().y());
+	tr.rotate(-box.angle);
+	tr.translate(-rc.center().x(), -rc.center().y());
+
+	QPointF pts[4];
+	pts[0] = tr.map(rc.topLeft());
+	pts[1] = tr.map(rc.topRight());
+	pts[2] = tr.map(rc.bottomRight());
+	pts[3] = tr.map(rc.bottomLeft());
+	for(int i = 0; i < 4; i++)
+	{
+		pts[i] = QPointF(pts[i].x()*kx, pts[i].y()*ky);
+	}
+	fillPolygon(pts, 4, id);
+}
+
+void LabelMask::fillPolygon(const SmallPolygon &pl, double kx, double ky, quint16 id)
+{
+	QVarLengthArray<QPointF, SMALL_POLYGON_SIZE> pts(pl.count());
+	for(int i = 0; i < pl.count(); i++)
+	{
+		pts[i] = QPointF(pl[i].x()*kx, pl[i].y()*ky);
+	}
+	fillPolygon(pts.constData(), pts.size(), id);
+}
+
+QImage LabelMask::toImage8() const
+{
+	QImage im(mWidth, mHeight, QImage::Format_Indexed8);
+	QVector<QRgb> colors(256);
+	for(int i = 0; i < 256; i++)
+	{
+		colors[i] = qRgb(i, i, i);
+	}
+	im.setColorTable(colors);
+
+	for(int y = 0; y < mHeight; y++)
+	{
+		const quint16 *src = scanLine(y);
+		uchar *dst = im.scanLine(y);
+		for(int x = 0; x < mWidth; x++)
+		{
+			dst[x] = (uchar)qMin(src[x], (quint16)255);
+		}
+	}
+	return im;
+}
+
+bool LabelMask::savePgm16(const QString &file) const
+{
+	QFile f(file);
+	if(!f.open(QIODevice::WriteOnly))
+		return false;
+
+	bool ok = writePgm16(&f);
+	f.close();
+	return ok && f.error() == QFile::NoError;
+}
+
+bool LabelMask::writePgm16(QIODevice *dev) const
+{
+	QByteArray header = QString("P5\n%1 %2\n65535\n").arg(mWidth).arg(mHeight).toAscii();
+	bool ok = dev->write(header) == header.size();
+
+	QByteArray line(mWidth*2, 0);
+	for(int y = 0; y < mHeight && ok; y++)
+	{
+		const quint16 *src = scanLine(y);
+		uchar *dst = (uchar*)line.data();
+		for(int x = 0; x < mWidth; x++)
+		{
+			qToBigEndian(src[x], dst + 2*x);
+		}
+		ok = dev->write(line) == line.size();
+	}
+	return ok;
+}
@@ -0,0 +1,86 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef LABELMASK_H
+#define LABELMASK_H
+
+#include <QVector>
+#include <QPointF>
+#include <QImage>
+#include <QString>
+#include <QIODevice>
+#include "Constants.h"
+
+//Label ID raster of one frame, 0 is the background. Labels are rasterized
+//with the pixel centre rule: a pixel belongs to a shape if its centre lies
+//inside, so shapes sharing an edge don't overlap and an unrotated box covers
+//exactly the pixels of its rectangle. Later fills overwrite earlier ones.
+class LabelMask
+{
+public:
+	LabelMask() : mWidth(0), mHeight(0) {}
+	LabelMask(int width, int height);
+
+	int width() const { return mWidth; }
+	int height() const { return mHeight; }
+	bool isNull() const { return mPx.isEmpty(); }
+	quint16 at(int x, int y) const { return mPx[y*mWidth + x]; }
+	const quint16 *scanLine(int y) const { return mPx.constData() + y*mWidth; }
+
+	void clear();
+	//fills the pixels [x0, x1) x [y0, y1), clipped to the mask
+	void fillRect(int x0, int y0, int x1, int y1, quint16 id);
+	//even-odd scanline fill, the points are in mask coordinates
+	void fillPolygon(const QPointF *pts, int n, quint16 id);
+
+	//the shapes are given in label coordinates and scaled by kx, ky
+	void fillBox(const ViaPoint &box, double kx, double ky, quint16 id);
+	void fillPolygon(const SmallPolygon &pl, double kx, double ky, quint16 id);
+
+	//grayscale 8 bit image, ids above 255 are clipped
+	QImage toImage8() const;
+	//binary 16 bit PGM with big-endian samples
+	bool savePgm16(const QString &file) const;
+	bool writePgm16(QIODevice *dev) const;
+
+private:
+	//edge of the polygon being filled, x is the crossing at the current row
+	struct Edge
+	{
+		int yStart;
+		int yEnd;		//first row below the edge
+		double x;
+		double dxdy;
+	};
+	static bool edgeStartsBefore(const Edge &a, const Edge &b);
+
+	int mWidth;
+	int mHeight;
+	QVector<quint16> mPx;
+	//kept between fills to avoid reallocating
+	QVector<Edge> mEdges;
+	QVector<Edge> mActive;
+	QVector<double> mCrossings;
+};
+
+#endif
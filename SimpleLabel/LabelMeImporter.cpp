@@ -0,0 +1,429 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "LabelMeImporter.h"
+#include <QFile>
+#include <QTime>
+#include <QXmlStreamReader>
+#include <QHash>
+
+static QPoint readPoint(QXmlStreamReader &xml)
+{
+	float x = 0, y = 0;
+	while(xml.readNextStartElement())
+	{
+		if(xml.name() == "x")
+			x = xml.readElementText().trimmed().toFloat();
+		else if(xml.name() == "y")
+			y = xml.readElementText().trimmed().toFloat();
+		else
+			xml.skipCurrentElement();
+	}
+	return QPoint(qRound(x), qRound(y));
+}
+
+static QList<QPoint> readPoints(QXmlStreamReader &xml)
+{
+	QList<QPoint> pts;
+	while(xml.readNextStartElement())
+	{
+		if(xml.name() == "pt")
+			pts << readPoint(xml);
+		else
+			xml.skipCurrentElement();
+	}
+	return pts;
+}
+
+static void readObject(QXmlStreamReader &xml, LabelMeObject &obj)
+{
+	while(xml.readNextStartElement())
+	{
+		if(xml.name() == "name" && obj.name.isNull())
+		{
+			obj.name = xml.readElementText();
+		}
+		else if(xml.name() == "tgtID" && obj.id.isNull())
+		{
+			obj.id = xml.readElementText().trimmed();
+		}
+		else if(xml.name() == "bbox")
+		{
+			QList<QPoint> pts = readPoints(xml);
+			if(!pts.isEmpty())
+			{
+				while(pts.count() < 4)
+				{
+					pts << QPoint(0, 0);
+				}
+				//top left, top right, bottom right and bottom left corner
+				obj.box.setTopLeft(pts[0]);
+				obj.box.setTopRight(pts[1]);
+				obj.box.setBottomRight(pts[2]);
+				obj.box.setBottomLeft(pts[3]);
+				obj.hasBox = true;
+			}
+		}
+		else if(xml.name() == "polygon")
+		{
+			QList<QPoint> pts = readPoints(xml);
+			obj.polygon.clear();
+			for(int i = 0; i < pts.count(); i++)
+			{
+				obj.polygon << pts[i];
+			}
+		}
+		else
+		{
+			xml.skipCurrentElement();
+		}
+	}
+}
+
+class LabelMeParseJob : public QRunnable
+{
+public:
+	LabelMeParseJob(const QString &file, LabelMeFrame *frame, QSize imageSize, QSize displaySize, const QAtomicInt *cancel, QAtomicInt *done)
+		: mFile(file), mFrame(frame), mImageSize(imageSize), mDisplaySize(displaySize), mCancel(cancel), mDone(done)
+	{
+	}
+
+	virtual void run()
+	{
+		if(*mCancel == 0)
+		{
+			QFile fd(mFile);
+			if(!fd.open(QIODevice::ReadOnly))
+				mFrame->error = "Cannot open file";
+			else if(LabelMeImporter::parseFrame(&fd, *mFrame, mFrame->error))
+				LabelMeImporter::scaleFrame(*mFrame, mImageSize, mDisplaySize);
+		}
+		mDone->fetchAndAddRelaxed(1);
+	}
+
+private:
+	QString mFile;
+	LabelMeFrame *mFrame;
+	QSize mImageSize;
+	QSize mDisplaySize;
+	const QAtomicInt *mCancel;
+	QAtomicInt *mDone;
+};
+
+class LabelMeImportJob : public QRunnable
+{
+public:
+	LabelMeImportJob(LabelMeImporter *importer, LabelMeImporter::CancelToken token, const QString &firstFile, QSize displaySize)
+		: mImporter(importer), mToken(token), mFirstFile(firstFile), mDisplaySize(displaySize)
+	{
+	}
+
+	virtual void run()
+	{
+		QList<Label> labels;
+		QString msg;
+		bool ok = import(labels, msg);
+		if(*mToken != 0)
+		{
+			ok = false;
+			msg = "Import cancelled.";
+		}
+		QMetaObject::invokeMethod(mImporter, "onFinished", Qt::QueuedConnection,
+			Q_ARG(bool, ok), Q_ARG(QString, msg), Q_ARG(QList<Label>, labels));
+	}
+
+private:
+	bool import(QList<Label> &labels, QString &msg)
+	{
+		QTime timer;
+		timer.start();
+
+		//the first file holds the image size and the length of the sequence
+		LabelMeFrame header;
+		QString err;
+		QFile fd(mFirstFile);
+		if(!fd.open(QIODevice::ReadOnly))
+		{
+			msg = "Cannot open file " + mFirstFile;
+			return false;
+		}
+		if(!LabelMeImporter::parseFrame(&fd, header, err))
+		{
+			msg = "Failed to parse XML file " + mFirstFile + "\n" + err;
+			return false;
+		}
+		fd.close();
+
+		QStringList files;
+		if(header.frame < header.frameCount)
+			files = LabelMeImporter::sequenceFiles(mFirstFile, header.frameCount - header.frame + 1);
+
+		//parse phase, every job fills in its own frame
+		QVector<LabelMeFrame> frames(files.count());
+		LabelMeFrame *pf = frames.data();
+		QAtomicInt done(0);
+		QThreadPool pool;
+		for(int i = 0; i < files.count(); i++)
+		{
+			pool.start(new LabelMeParseJob(files[i], pf + i, header.imageSize, mDisplaySize, mToken.data(), &done));
+		}
+		while(!pool.waitForDone(IMPORT_PROGRESS_INTERVAL))
+		{
+			QMetaObject::invokeMethod(mImporter, "onProgress", Qt::QueuedConnection, Q_ARG(int, (int)done), Q_ARG(int, files.count()));
+		}
+		if(*mToken != 0)
+			return false;
+
+		for(int i = 0; i < frames.count(); i++)
+		{
+			if(!frames[i].parsed)
+			{
+				msg = "Failed to parse XML file " + files[i] + "\n" + frames[i].error;
+				return false;
+			}
+		}
+
+		//merge phase
+		labels = LabelMeImporter::merge(frames, header.frameCount);
+		msg = QString("Imported %1 file(s) in %2 s").arg(files.count()).arg(timer.elapsed() / 1000.0, 0, 'f', 2);
+		return true;
+	}
+
+	LabelMeImporter *mImporter;
+	LabelMeImporter::CancelToken mToken;
+	QString mFirstFile;
+	QSize mDisplaySize;
+};
+
+LabelMeImporter::LabelMeImporter(QObject *parent)
+	: QObject(parent)
+{
+	qRegisterMetaType<QList<Label> >("QList<Label>");
+	mPool.setMaxThreadCount(1);
+	mRunning = false;
+}
+
+LabelMeImporter::~LabelMeImporter()
+{
+	cancel();
+	mPool.waitForDone();
+}
+
+bool LabelMeImporter::start(const QString &firstFile, const QSize &displaySize)
+{
+	if(mRunning)
+		return false;
+
+	mToken = CancelToken(new QAtomicInt(0));
+	mRunning = true;
+	mPool.start(new LabelMeImportJob(this, mToken, firstFile, displaySize));
+	return true;
+}
+
+void LabelMeImporter::cancel()
+{
+	if(mToken)
+		mToken->fetchAndStoreOrdered(1);
+}
+
+void LabelMeImporter::onProgress(int done, int total)
+{
+	if(mRunning)
+		emit progress(done, total);
+}
+
+void LabelMeImporter::onFinished(bool ok, QString message, QList<Label> labels)
+{
+	mRunning = false;
+	mToken.clear();
+	if(ok)
+		mLabels = labels;
+	emit finished(ok, message);
+}
+
+QStringList LabelMeImporter::sequenceFiles(const QString &firstFile, int count)
+{
+	QString path, filename, prefix, ext, num;
+	int index;
+	CommonFunctions::splitPath(firstFile, path, filename, prefix, (uint)5, index, ext);
+
+	QStringList files;
+	QString s = firstFile;
+	while(files.count() < count && QFile::exists(s))
+	{
+		files << s;
+		index++;
+		num.sprintf("%05d", index);
+		s = path + prefix + num + ext;
+	}
+	return files;
+}
+
+bool LabelMeImporter::parseFrame(QIODevice *device, LabelMeFrame &frame, QString &error)
+{
+	QXmlStreamReader xml(device);
+	if(xml.readNextStartElement())
+	{
+		while(xml.readNextStartElement())
+		{
+			if(xml.name() == "frame")
+			{
+				frame.frame = xml.readElementText().trimmed().toInt();
+			}
+			else if(xml.name() == "source")
+			{
+				while(xml.readNextStartElement())
+				{
+					if(xml.name() == "numberFrames")
+						frame.frameCount = xml.readElementText().trimmed().toInt();
+					else
+						xml.skipCurrentElement();
+				}
+			}
+			else if(xml.name() == "imagesize")
+			{
+				while(xml.readNextStartElement())
+				{
+					if(xml.name() == "rows")
+						frame.imageSize.setHeight(xml.readElementText().trimmed().toInt());
+					else if(xml.name() == "columns")
+						frame.imageSize.setWidth(xml.readElementText().trimmed().toInt());
+					else
+						xml.skipCurrentElement();
+				}
+			}
+			else if(xml.name() == "object")
+			{
+				LabelMeObject obj;
+				readObject(xml, obj);
+				if(!obj.id.isEmpty())
+					frame.objects << obj;
+			}
+			else
+			{
+				xml.skipCurrentElement();
+			}
+		}
+	}
+
+	if(xml.hasError())
+	{
+		error = QString("Line %1, column %2: %3").arg(xml.lineNumber()).arg(xml.columnNumber()).arg(xml.errorString());
+		return false;
+	}
+	frame.parsed = true;
+	return true;
+}
+
+void LabelMeImporter::scaleFrame(LabelMeFrame &frame, const QSize &imageSize, const QSize &displaySize)
+{
+	int w = imageSize.width();
+	int h = imageSize.height();
+	for(int i = 0; i < frame.objects.count(); i++)
+	{
+		LabelMeObject &obj = frame.objects[i];
+		if(obj.hasBox)
+			obj.box = CommonFunctions::imageToImage(w, h, obj.box, displaySize.width(), displaySize.height());
+		obj.polygon = CommonFunctions::imageToImage(w, h, obj.polygon, displaySize.width(), displaySize.height());
+	}
+}
+
+QList<Label> LabelMeImporter::merge(const QVector<LabelMeFrame> &frames, int frameCount)
+{
+	QList<Label> labels;
+	QHash<int, int> rows;	//tgtID to row, labels are added in order of their first appearance
+
+	for(int f = 0; f < frames.count(); f++)
+	{
+		const LabelMeFrame &fr = frames[f];
+		for(int i = 0; i < fr.objects.count(); i++)
+		{
+			const LabelMeObject &obj = fr.objects[i];
+			int id = obj.id.toInt();
+			QHash<int, int>::iterator it = rows.find(id);
+			if(it == rows.end())
+			{
+				Label lb;
+				lb.number = id;
+				lb.name = obj.name;
+				it = rows.insert(id, labels.count());
+				labels.append(lb);
+			}
+			Label &lb = labels[it.value()];
+
+			if(obj.hasBox)
+			{
+				ViaPoint vp;
+				vp.frame = fr.frame;
+				vp.rc = obj.box;
+				lb.boxes.append(vp);
+				lb.viaPoints.append(vp);
+			}
+
+			//only adding polygon if it is at least a triangle
+			if(obj.polygon.count() > 2)
+			{
+				ViaPointPolygon polyg;
+				polyg.frame = fr.frame;
+				polyg.pl = obj.polygon;
+				lb.shape = Polyg;
+				lb.polygons << polyg;
+				lb.viaPointsPoly << polyg;
+			}
+		}
+
+		//the sequence ends with the first file at or after the last frame
+		if(fr.frame >= frameCount)
+			break;
+	}
+
+	//LabelMe stores a bounding box next to every polygon, polygon labels derive it when needed.
+	//Frames of a polygon label that only have the bounding box keep it as a polygon.
+	for(int row = 0; row < labels.count(); row++)
+	{
+		Label &lb = labels[row];
+		if(lb.shape != Polyg)
+			continue;
+
+		QVector<ViaPointPolygon> polygons;
+		int p = 0;
+		for(int b = 0; b < lb.viaPoints.count(); b++)
+		{
+			const ViaPoint &vp = lb.viaPoints.at(b);
+			while(p < lb.viaPointsPoly.count() && lb.viaPointsPoly[p].frame < vp.frame)
+				polygons << lb.viaPointsPoly[p++];
+			if(p >= lb.viaPointsPoly.count() || lb.viaPointsPoly[p].frame != vp.frame)
+				polygons << ViaPointPolygon::fromBox(vp);
+		}
+		while(p < lb.viaPointsPoly.count())
+			polygons << lb.viaPointsPoly[p++];
+
+		lb.viaPointsPoly = polygons;
+		lb.polygons.clear();
+		for(int i = 0; i < polygons.count(); i++)
+			lb.polygons << polygons[i];
+		lb.boxes.clear();
+		lb.viaPoints.clear();
+	}
+	return labels;
+}
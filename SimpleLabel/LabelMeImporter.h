@@ -0,0 +1,110 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef LABELMEIMPORTER_H
+#define LABELMEIMPORTER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QStringList>
+#include <QVector>
+#include "Constants.h"
+
+//minimal time between two progress reports of a running import, in ms
+#define IMPORT_PROGRESS_INTERVAL	100
+
+//object of a LabelMe frame file, coordinates are in the original image
+struct LabelMeObject
+{
+	LabelMeObject() : hasBox(false) {}
+
+	QString id;			//tgtID, objects without one are ignored
+	QString name;
+	bool hasBox;
+	QRect box;
+	SmallPolygon polygon;
+};
+
+//contents of one LabelMe frame file
+struct LabelMeFrame
+{
+	LabelMeFrame() : parsed(false), frame(0), frameCount(0) {}
+
+	bool parsed;
+	QString error;		//why the file couldn't be parsed
+	int frame;
+	int frameCount;		//numberFrames of the source
+	QSize imageSize;
+	QList<LabelMeObject> objects;
+};
+
+//Imports a sequence of LabelMe per-frame XML files. The files are parsed in
+//parallel, one job per file, and the labels are then assembled by tgtID in
+//file order on the worker thread, so the result doesn't depend on which job
+//finished first and the GUI stays responsive.
+class LabelMeImporter : public QObject
+{
+	Q_OBJECT
+
+public:
+	LabelMeImporter(QObject *parent = NULL);
+	virtual ~LabelMeImporter();
+
+	//imports the sequence starting with firstFile, the labels are scaled to displaySize.
+	//Returns false if an import is already running.
+	bool start(const QString &firstFile, const QSize &displaySize);
+	bool isRunning() const { return mRunning; }
+	//labels of the last successful import
+	const QList<Label> &labels() const { return mLabels; }
+
+	//files of the sequence that follow firstFile and exist, at most count of them
+	static QStringList sequenceFiles(const QString &firstFile, int count);
+	static bool parseFrame(QIODevice *device, LabelMeFrame &frame, QString &error);
+	static void scaleFrame(LabelMeFrame &frame, const QSize &imageSize, const QSize &displaySize);
+	//assembles the labels of the frames in order, up to the first frame at or after frameCount
+	static QList<Label> merge(const QVector<LabelMeFrame> &frames, int frameCount);
+
+public slots:
+	void cancel();
+
+signals:
+	void progress(int done, int total);
+	void finished(bool ok, QString message);
+
+private slots:
+	void onProgress(int done, int total);
+	void onFinished(bool ok, QString message, QList<Label> labels);
+
+private:
+	friend class LabelMeImportJob;
+	typedef QSharedPointer<QAtomicInt> CancelToken;
+
+	QThreadPool mPool;
+	CancelToken mToken;
+	QList<Label> mLabels;
+	bool mRunning;
+};
+
+#endif
@@ -0,0 +1,168 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "LabelSpanIndex.h"
+#include <QtAlgorithms>
+
+LabelSpanIndex::LabelSpanIndex()
+{
+}
+
+void LabelSpanIndex::clear()
+{
+	mSpans.clear();
+	mBuckets.clear();
+}
+
+void LabelSpanIndex::rebuild(const QList<Label> &labels)
+{
+	clear();
+	for(int i = 0; i < labels.count(); i++)
+	{
+		update(i, labels.at(i));
+	}
+}
+
+bool LabelSpanIndex::spanOf(const Label &lb, int &first, int &last)
+{
+	bool res = false;
+	first = 0;
+	last = -1;
+
+	if(lb.boxes.count() > 0)
+	{
+		first = lb.boxes.first().frame;
+		last = lb.boxes.last().frame;
+		res = true;
+	}
+
+	if(lb.polygons.count() > 0)
+	{
+		if(res)
+		{
+			first = qMin(first, lb.polygons.first().frame);
+			last = qMax(last, lb.polygons.last().frame);
+		}
+		else
+		{
+			first = lb.polygons.first().frame;
+			last = lb.polygons.last().frame;
+		}
+		res = true;
+	}
+
+	return res;
+}
+
+void LabelSpanIndex::update(int row, const Label &lb)
+{
+	if(row < 0)
+		return;
+
+	if(row >= mSpans.count())
+	{
+		Span empty;
+		empty.first = 0;
+		empty.last = -1;
+		int n = mSpans.count();
+		mSpans.resize(row + 1);
+		for(int i = n; i < mSpans.count(); i++)
+			mSpans[i] = empty;
+	}
+
+	Span sp;
+	spanOf(lb, sp.first, sp.last);
+	if(sp.first == mSpans[row].first && sp.last == mSpans[row].last)
+		return;
+
+	eraseSpan(row);
+	mSpans[row] = sp;
+	insertSpan(row);
+}
+
+void LabelSpanIndex::removeRow(int row)
+{
+	if(row < 0 || row >= mSpans.count())
+		return;
+
+	//rows after the removed one shift, so the buckets are refilled
+	mSpans.remove(row);
+	mBuckets.clear();
+	for(int i = 0; i < mSpans.count(); i++)
+	{
+		insertSpan(i);
+	}
+}
+
+QList<int> LabelSpanIndex::labelsAt(int frame) const
+{
+	QList<int> res;
+	QHash<int, QVector<int> >::const_iterator b = mBuckets.constFind(bucketOf(frame));
+	if(b != mBuckets.constEnd())
+	{
+		const QVector<int> &rows = b.value();
+		for(int i = 0; i < rows.count(); i++)
+		{
+			const Span &sp = mSpans.at(rows.at(i));
+			if(frame >= sp.first && frame <= sp.last)
+				res << rows.at(i);
+		}
+	}
+
+	return res;
+}
+
+void LabelSpanIndex::insertSpan(int row)
+{
+	const Span &sp = mSpans.at(row);
+	if(sp.first > sp.last)
+		return;
+
+	for(int b = bucketOf(sp.first); b <= bucketOf(sp.last); b++)
+	{
+		//keep rows sorted so lookups return labels in list order
+		QVector<int> &rows = mBuckets[b];
+		rows.insert(qLowerBound(rows.begin(), rows.end(), row), row);
+	}
+}
+
+void LabelSpanIndex::eraseSpan(int row)
+{
+	const Span &sp = mSpans.at(row);
+	if(sp.first > sp.last)
+		return;
+
+	for(int b = bucketOf(sp.first); b <= bucketOf(sp.last); b++)
+	{
+		QHash<int, QVector<int> >::iterator it = mBuckets.find(b);
+		if(it == mBuckets.end())
+			continue;
+
+		QVector<int> &rows = it.value();
+		QVector<int>::iterator r = qBinaryFind(rows.begin(), rows.end(), row);
+		if(r != rows.end())
+			rows.erase(r);
+		if(rows.isEmpty())
+			mBuckets.erase(it);
+	}
+}
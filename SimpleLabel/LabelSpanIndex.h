@@ -0,0 +1,71 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef LABELSPANINDEX_H
+#define LABELSPANINDEX_H
+
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include "Constants.h"
+
+//Maps a frame to the labels (rows of the label list) that have a box or a
+//polygon in that frame. Label spans are registered in fixed size frame
+//buckets, so a lookup only looks at the labels whose span touches the bucket
+//of the requested frame instead of scanning the whole label list.
+class LabelSpanIndex
+{
+public:
+	LabelSpanIndex();
+
+	void clear();
+	void rebuild(const QList<Label> &labels);
+
+	//call whenever the tracks of the label in the given row change
+	void update(int row, const Label &lb);
+	//call after the label in the given row was removed from the list
+	void removeRow(int row);
+
+	//rows of the labels present in the frame, in ascending order
+	QList<int> labelsAt(int frame) const;
+
+	static bool spanOf(const Label &lb, int &first, int &last);
+
+private:
+	struct Span
+	{
+		int first;
+		int last;
+	};
+
+	void insertSpan(int row);
+	void eraseSpan(int row);
+	static int bucketOf(int frame) { return frame >> BUCKET_BITS; }
+
+	enum { BUCKET_BITS = 6 };
+
+	QVector<Span> mSpans;
+	QHash<int, QVector<int> > mBuckets;
+};
+
+#endif
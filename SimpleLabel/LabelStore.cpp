@@ -0,0 +1,47 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "LabelStore.h"
+
+LabelStore::LabelStore()
+{
+}
+
+int LabelStore::publish(const QList<Label> &labels)
+{
+	QMutexLocker lock(&mMutex);
+	mCurrent = LabelSnapshot(mCurrent.version() + 1, labels);
+	return mCurrent.version();
+}
+
+LabelSnapshot LabelStore::snapshot() const
+{
+	QMutexLocker lock(&mMutex);
+	return mCurrent;
+}
+
+int LabelStore::version() const
+{
+	QMutexLocker lock(&mMutex);
+	return mCurrent.version();
+}
@@ -0,0 +1,68 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef LABELSTORE_H
+#define LABELSTORE_H
+
+#include <QList>
+#include <QMutex>
+#include "Constants.h"
+
+//An immutable version of the label list. Copying it is cheap and it never
+//changes, so it can be handed to other threads.
+class LabelSnapshot
+{
+public:
+	LabelSnapshot() : mVersion(0) {}
+	LabelSnapshot(int version, const QList<Label> &labels) : mVersion(version), mLabels(labels) {}
+
+	int version() const { return mVersion; }
+	const QList<Label> &labels() const { return mLabels; }
+	int count() const { return mLabels.count(); }
+	const Label &operator[](int row) const { return mLabels[row]; }
+
+private:
+	int mVersion;
+	QList<Label> mLabels;
+};
+
+//Holds the published version of the labels for background readers. The GUI
+//keeps editing its own label list and publishes it after every edit. The
+//lists are implicitly shared, so publishing and taking a snapshot only swap
+//a reference under the lock and never copy tracks.
+class LabelStore
+{
+public:
+	LabelStore();
+
+	//makes the labels the current version, returns the new version number
+	int publish(const QList<Label> &labels);
+	LabelSnapshot snapshot() const;
+	int version() const;
+
+private:
+	mutable QMutex mMutex;
+	LabelSnapshot mCurrent;
+};
+
+#endif
@@ -0,0 +1,264 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "LabelXmlReader.h"
+#include "Track.h"
+#include <QTime>
+
+static int intAttribute(const QXmlStreamAttributes &attr, const QString &name, int def)
+{
+	return attr.hasAttribute(name) ? attr.value(name).toString().toInt() : def;
+}
+
+static QString stringAttribute(const QXmlStreamAttributes &attr, const QString &name, const QString &def)
+{
+	return attr.hasAttribute(name) ? attr.value(name).toString() : def;
+}
+
+LabelXmlReader::LabelXmlReader()
+{
+	mElapsed = 0;
+	mBytes = 0;
+	mNeedsDense = false;
+}
+
+bool LabelXmlReader::read(QIODevice *device, const QSize &imageSize, const QSize &displaySize)
+{
+	QTime timer;
+	timer.start();
+
+	mImageSize = imageSize;
+	mError.clear();
+	bool ok = parse(device, false);
+	if(ok && mNeedsDense)
+	{
+		//a label without via points only has its per-frame shapes, read them all
+		mImageSize = imageSize;
+		ok = device->reset() && parse(device, true);
+	}
+
+	if(ok)
+	{
+		for(int i = 0; i < mLabels.count(); i++)
+		{
+			scaleLabel(mLabels[i], displaySize);
+		}
+	}
+	else
+	{
+		mLabels.clear();
+	}
+
+	mBytes = device->size();
+	mElapsed = timer.elapsed();
+	return ok;
+}
+
+bool LabelXmlReader::parse(QIODevice *device, bool dense)
+{
+	QXmlStreamReader xml(device);
+
+	mLabels.clear();
+	mNeedsDense = false;
+	if(xml.readNextStartElement())
+	{
+		while(xml.readNextStartElement())
+		{
+			if(xml.name() == "image")
+			{
+				mImageSize.setWidth(intAttribute(xml.attributes(), "width", -1));
+				mImageSize.setHeight(intAttribute(xml.attributes(), "height", -1));
+				xml.skipCurrentElement();
+			}
+			else if(xml.name() == "label")
+			{
+				Label lb;
+				if(!readLabel(xml, dense, lb))
+					mNeedsDense = true;
+				mLabels.append(lb);
+			}
+			else
+			{
+				xml.skipCurrentElement();
+			}
+		}
+	}
+
+	if(xml.hasError())
+	{
+		mError = QString("Line %1, column %2: %3").arg(xml.lineNumber()).arg(xml.columnNumber()).arg(xml.errorString());
+		return false;
+	}
+	return true;
+}
+
+//returns false if a skipped per-frame section is needed because the label has no via points
+bool LabelXmlReader::readLabel(QXmlStreamReader &xml, bool dense, Label &lb)
+{
+	QXmlStreamAttributes attr = xml.attributes();
+	lb.name = stringAttribute(attr, "name", "-1");
+	lb.desc = stringAttribute(attr, "desc", "-1");
+	lb.number = intAttribute(attr, "number", -1);
+	lb.shape = (LabelShape)intAttribute(attr, "shape", -1);
+	lb.intr = (InterpolationMethod)intAttribute(attr, "interpolation", 0);
+
+	//motion tracked boxes can't be recalculated from the via points
+	bool readBoxFrames = dense || lb.intr == Motion;
+	bool skipped = false;
+
+	while(xml.readNextStartElement())
+	{
+		//older files store both shapes, only the label's own one is kept
+		if(lb.shape == Rect && xml.name() == "boxes" && readBoxFrames)
+		{
+			readBoxes(xml, lb.boxes, lb.viaPoints);
+		}
+		else if(lb.shape == Rect && xml.name() == "pivots")
+		{
+			readBoxes(xml, lb.boxes, lb.viaPoints);
+		}
+		else if(lb.shape == Polyg && xml.name() == "polygons" && dense)
+		{
+			readPolygons(xml, lb.polygons, lb.viaPointsPoly);
+		}
+		else if(lb.shape == Polyg && xml.name() == "polygonPivots")
+		{
+			readPolygons(xml, lb.polygons, lb.viaPointsPoly);
+		}
+		else
+		{
+			if((lb.shape == Rect && xml.name() == "boxes") || (lb.shape == Polyg && xml.name() == "polygons"))
+				skipped = true;
+			xml.skipCurrentElement();
+		}
+	}
+
+	return !skipped || !(lb.shape == Rect ? lb.viaPoints.isEmpty() : lb.viaPointsPoly.isEmpty());
+}
+
+void LabelXmlReader::readBoxes(QXmlStreamReader &xml, BlockList<ViaPoint> &boxes, QList<ViaPoint> &pivots)
+{
+	while(xml.readNextStartElement())
+	{
+		QXmlStreamAttributes attr = xml.attributes();
+		ViaPoint pt;
+		pt.frame = intAttribute(attr, "frame", -1);
+		pt.rc.setLeft(intAttribute(attr, "left", -1));
+		pt.rc.setTop(intAttribute(attr, "top", -1));
+		pt.rc.setRight(intAttribute(attr, "right", -1));
+		pt.rc.setBottom(intAttribute(attr, "bottom", -1));
+		pt.angle = attr.hasAttribute("angle") ? attr.value("angle").toString().toFloat() : 0.0f;
+
+		if(xml.name() == "box")
+			boxes.append(pt);
+		else if(xml.name() == "pivot")
+			pivots.append(pt);
+		xml.skipCurrentElement();
+	}
+}
+
+void LabelXmlReader::readPolygons(QXmlStreamReader &xml, BlockList<ViaPointPolygon> &polygons, QVector<ViaPointPolygon> &pivots)
+{
+	while(xml.readNextStartElement())
+	{
+		ViaPointPolygon pl;
+		pl.frame = intAttribute(xml.attributes(), "frame", -1);
+		bool isPolygon = xml.name() == "polygon";
+		bool isPivot = xml.name() == "polygonPivot";
+
+		while(xml.readNextStartElement())
+		{
+			QXmlStreamAttributes attr = xml.attributes();
+			pl.pl << QPoint(intAttribute(attr, "x", -1), intAttribute(attr, "y", -1));
+			xml.skipCurrentElement();
+		}
+
+		if(isPolygon)
+			polygons.append(pl);
+		else if(isPivot)
+			pivots.append(pl);
+	}
+}
+
+//converts the coordinates to the screen image size and regenerates skipped shapes
+void LabelXmlReader::scaleLabel(Label &lb, const QSize &displaySize)
+{
+	int w = mImageSize.width();
+	int h = mImageSize.height();
+	int dw = displaySize.width();
+	int dh = displaySize.height();
+
+	if(lb.shape == Rect)
+	{
+		for(int k = 0; k < lb.viaPoints.count(); k++)
+		{
+			lb.viaPoints[k].rc = CommonFunctions::imageToImage(w, h, lb.viaPoints[k].rc, dw, dh);
+		}
+
+		if(lb.boxes.isEmpty())
+		{
+			Track<RectShape>(lb).rebuild();
+			return;
+		}
+
+		for(int k = 0; k < lb.boxes.count(); k++)
+		{
+			ViaPoint bx = lb.boxes.at(k);
+			bx.rc = CommonFunctions::imageToImage(w, h, bx.rc, dw, dh);
+			lb.boxes.replace(k, bx);
+		}
+		//keep the via points on the stored track
+		for(int k = 0; k < lb.viaPoints.count(); k++)
+		{
+			const ViaPoint *bx = lb.findBoxByFrame(lb.viaPoints[k].frame);
+			if(bx != NULL)
+				lb.viaPoints[k].rc = bx->rc;
+		}
+	}
+	else if(lb.shape == Polyg)
+	{
+		for(int k = 0; k < lb.viaPointsPoly.count(); k++)
+		{
+			lb.viaPointsPoly[k].pl = CommonFunctions::imageToImage(w, h, lb.viaPointsPoly[k].pl, dw, dh);
+		}
+
+		if(lb.polygons.isEmpty())
+		{
+			Track<PolygonShape>(lb).rebuild();
+			return;
+		}
+
+		for(int k = 0; k < lb.polygons.count(); k++)
+		{
+			ViaPointPolygon pl = lb.polygons.at(k);
+			pl.pl = CommonFunctions::imageToImage(w, h, pl.pl, dw, dh);
+			lb.polygons.replace(k, pl);
+		}
+		for(int k = 0; k < lb.viaPointsPoly.count(); k++)
+		{
+			const ViaPointPolygon *pl = lb.findPolygonByFrame(lb.viaPointsPoly[k].frame);
+			if(pl != NULL)
+				lb.viaPointsPoly[k].pl = pl->pl;
+		}
+	}
+}
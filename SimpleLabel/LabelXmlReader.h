@@ -0,0 +1,66 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef LABELXMLREADER_H
+#define LABELXMLREADER_H
+
+#include <QList>
+#include <QSize>
+#include <QXmlStreamReader>
+#include "Constants.h"
+
+//Pull parser for SimpleLabel XML projects. The labels are built while the file
+//is read instead of walking a QDomDocument of the whole project. The per-frame
+//<boxes> and <polygons> sections are skipped whenever they can be regenerated
+//from the via points; only motion tracked boxes are read from the file.
+class LabelXmlReader
+{
+public:
+	LabelXmlReader();
+
+	//reads the project, imageSize is used when the file doesn't store the
+	//image size, the labels are scaled to displaySize
+	bool read(QIODevice *device, const QSize &imageSize, const QSize &displaySize);
+
+	const QList<Label> &labels() const { return mLabels; }
+	QString errorString() const { return mError; }
+	//load time in milliseconds and size of the file
+	int elapsed() const { return mElapsed; }
+	qint64 bytesRead() const { return mBytes; }
+
+private:
+	bool parse(QIODevice *device, bool dense);
+	bool readLabel(QXmlStreamReader &xml, bool dense, Label &lb);
+	void readBoxes(QXmlStreamReader &xml, BlockList<ViaPoint> &boxes, QList<ViaPoint> &pivots);
+	void readPolygons(QXmlStreamReader &xml, BlockList<ViaPointPolygon> &polygons, QVector<ViaPointPolygon> &pivots);
+	void scaleLabel(Label &lb, const QSize &displaySize);
+
+	QList<Label> mLabels;
+	QSize mImageSize;
+	QString mError;
+	bool mNeedsDense;
+	int mElapsed;
+	qint64 mBytes;
+};
+
+#endif
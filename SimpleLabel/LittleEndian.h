@@ -0,0 +1,84 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef LITTLEENDIAN_H
+#define LITTLEENDIAN_H
+
+#include <QByteArray>
+#include <QtEndian>
+#include <string.h>
+
+//Little-endian fields of the binary formats: MAT-files, zip and npy, and the
+//project file.
+inline void putU16(QByteArray &buf, quint16 v)
+{
+	uchar b[2];
+	qToLittleEndian(v, b);
+	buf.append((const char*)b, 2);
+}
+
+inline void putU32(QByteArray &buf, quint32 v)
+{
+	uchar b[4];
+	qToLittleEndian(v, b);
+	buf.append((const char*)b, 4);
+}
+
+inline void putU64(QByteArray &buf, quint64 v)
+{
+	uchar b[8];
+	qToLittleEndian(v, b);
+	buf.append((const char*)b, 8);
+}
+
+inline void putF32(QByteArray &buf, float v)
+{
+	quint32 bits;
+	memcpy(&bits, &v, 4);
+	putU32(buf, bits);
+}
+
+inline quint32 getU32(const uchar *p)
+{
+	return qFromLittleEndian<quint32>(p);
+}
+
+inline qint32 getI32(const uchar *p)
+{
+	return (qint32)qFromLittleEndian<quint32>(p);
+}
+
+inline quint64 getU64(const uchar *p)
+{
+	return qFromLittleEndian<quint64>(p);
+}
+
+inline float getF32(const uchar *p)
+{
+	quint32 bits = qFromLittleEndian<quint32>(p);
+	float v;
+	memcpy(&v, &bits, 4);
+	return v;
+}
+
+#endif
@@ -0,0 +1,197 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "MatWriter.h"
+#include "LittleEndian.h"
+#include <QDateTime>
+#include <string.h>
+
+//data types
+#define MI_INT8		1
+#define MI_UINT16	4
+#define MI_INT32	5
+#define MI_UINT32	6
+#define MI_DOUBLE	9
+#define MI_MATRIX	14
+//array classes
+#define MX_STRUCT_CLASS	2
+#define MX_CHAR_CLASS	4
+#define MX_DOUBLE_CLASS	6
+
+#define MAT_HEADER_TEXT_LENGTH	116
+
+MatWriter::MatWriter(QIODevice *device)
+	: mDevice(device), mArrayStart(-1)
+{
+}
+
+bool MatWriter::write(const QByteArray &data)
+{
+	if(mDevice->write(data) != data.size())
+	{
+		if(mError.isEmpty())
+			mError = mDevice->errorString();
+		return false;
+	}
+	return true;
+}
+
+bool MatWriter::writeHeader(const QString &description)
+{
+	QByteArray header = QString("MATLAB 5.0 MAT-file, %1, Created on: %2")
+		.arg(description).arg(QDateTime::currentDateTime().toString("ddd MMM d hh:mm:ss yyyy")).toAscii();
+	header = header.left(MAT_HEADER_TEXT_LENGTH);
+	header += QByteArray(MAT_HEADER_TEXT_LENGTH - header.size(), ' ');
+	header += QByteArray(8, '\0');	//no subsystem data
+	putU16(header, 0x0100);
+	//written as 'I', 'M' by a little-endian writer
+	putU16(header, ('M' << 8) | 'I');
+	return write(header);
+}
+
+QByteArray MatWriter::element(quint32 type, const QByteArray &data)
+{
+	QByteArray res;
+	putU32(res, type);
+	putU32(res, data.size());
+	res += data;
+	//every element ends on a 64 bit boundary
+	res += QByteArray((8 - data.size() % 8) % 8, '\0');
+	return res;
+}
+
+QByteArray MatWriter::matrixHeader(quint32 cls, int rows, int cols, const QString &name)
+{
+	QByteArray flags, dims;
+	putU32(flags, cls);
+	putU32(flags, 0);
+	putU32(dims, rows);
+	putU32(dims, cols);
+	return element(MI_UINT32, flags) + element(MI_INT32, dims) + element(MI_INT8, name.toAscii());
+}
+
+QByteArray MatWriter::matrix(const QByteArray &header, const QByteArray &body)
+{
+	QByteArray res;
+	putU32(res, MI_MATRIX);
+	putU32(res, header.size() + body.size());
+	return res + header + body;
+}
+
+QByteArray MatWriter::fieldNames(const QStringList &fields)
+{
+	QByteArray res;
+	//the field name length is a small data element, tag and value share 8 bytes
+	putU32(res, (4 << 16) | MI_INT32);
+	putU32(res, MAT_FIELD_NAME_LENGTH);
+
+	QByteArray names;
+	for(int i = 0; i < fields.count(); i++)
+	{
+		QByteArray f = fields[i].toAscii().left(MAT_FIELD_NAME_LENGTH - 1);
+		names += f + QByteArray(MAT_FIELD_NAME_LENGTH - f.size(), '\0');
+	}
+	return res + element(MI_INT8, names);
+}
+
+QByteArray MatWriter::doubleMatrix(const QVector<double> &data, int rows, int cols, const QString &name)
+{
+	if(data.isEmpty())
+		rows = cols = 0;
+
+	QByteArray real;
+	real.reserve(data.count()*8);
+	for(int i = 0; i < data.count(); i++)
+	{
+		quint64 bits;
+		memcpy(&bits, &data[i], 8);
+		uchar b[8];
+		qToLittleEndian(bits, b);
+		real.append((const char*)b, 8);
+	}
+	return matrix(matrixHeader(MX_DOUBLE_CLASS, rows, cols, name), element(MI_DOUBLE, real));
+}
+
+QByteArray MatWriter::scalar(double value)
+{
+	return doubleMatrix(QVector<double>() << value, 1, 1);
+}
+
+QByteArray MatWriter::charArray(const QString &text)
+{
+	QByteArray chars;
+	for(int i = 0; i < text.length(); i++)
+	{
+		putU16(chars, text[i].unicode());
+	}
+	int n = text.length();
+	return matrix(matrixHeader(MX_CHAR_CLASS, n > 0 ? 1 : 0, n, ""), element(MI_UINT16, chars));
+}
+
+QByteArray MatWriter::structArray(const QStringList &fields, int count, const QList<QByteArray> &values)
+{
+	if(count == 0)
+		return doubleMatrix(QVector<double>(), 0, 0);
+
+	QByteArray body = fieldNames(fields);
+	for(int i = 0; i < values.count(); i++)
+	{
+		body += values[i];
+	}
+	return matrix(matrixHeader(MX_STRUCT_CLASS, 1, count, ""), body);
+}
+
+bool MatWriter::beginStructArray(const QString &name, const QStringList &fields, int count)
+{
+	mArrayStart = mDevice->pos();
+	QByteArray tag;
+	putU32(tag, MI_MATRIX);
+	putU32(tag, 0);		//patched by endStructArray
+	return write(tag + matrixHeader(MX_STRUCT_CLASS, 1, count, name) + fieldNames(fields));
+}
+
+bool MatWriter::writeValue(const QByteArray &value)
+{
+	return write(value);
+}
+
+bool MatWriter::endStructArray()
+{
+	if(!mError.isEmpty() || mArrayStart < 0)
+		return false;
+
+	qint64 end = mDevice->pos();
+	if(end - mArrayStart - 8 > Q_INT64_C(0xffffffff))
+	{
+		mError = "The structure is larger than 4 GB.";
+		return false;
+	}
+
+	QByteArray size;
+	putU32(size, (quint32)(end - mArrayStart - 8));
+	bool ok = mDevice->seek(mArrayStart + 4) && write(size) && mDevice->seek(end);
+	if(!ok && mError.isEmpty())
+		mError = mDevice->errorString();
+	mArrayStart = -1;
+	return ok;
+}
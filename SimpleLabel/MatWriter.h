@@ -0,0 +1,70 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef MATWRITER_H
+#define MATWRITER_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+//length reserved for every struct field name, MATLAB reads up to 31 characters
+#define MAT_FIELD_NAME_LENGTH	32
+
+//Writes a level 5 MAT-file. Values are built as complete matrix elements by
+//the static functions and nested as needed. The top level struct array is
+//streamed: its elements are written one after the other and the size of the
+//array is patched in at the end, so the device has to be seekable.
+class MatWriter
+{
+public:
+	MatWriter(QIODevice *device);
+
+	bool writeHeader(const QString &description);
+	//the values of the elements follow in order, all fields of the first element first
+	bool beginStructArray(const QString &name, const QStringList &fields, int count);
+	bool writeValue(const QByteArray &value);
+	bool endStructArray();
+	QString errorString() const { return mError; }
+
+	//column-major rows x cols matrix, empty data gives []
+	static QByteArray doubleMatrix(const QVector<double> &data, int rows, int cols, const QString &name = "");
+	static QByteArray scalar(double value);
+	static QByteArray charArray(const QString &text);
+	//1 x count struct array, values as for the streamed one; no elements give []
+	static QByteArray structArray(const QStringList &fields, int count, const QList<QByteArray> &values);
+
+private:
+	static QByteArray element(quint32 type, const QByteArray &data);
+	static QByteArray matrixHeader(quint32 cls, int rows, int cols, const QString &name);
+	static QByteArray fieldNames(const QStringList &fields);
+	static QByteArray matrix(const QByteArray &header, const QByteArray &body);
+	bool write(const QByteArray &data);
+
+	QIODevice *mDevice;
+	qint64 mArrayStart;		//position of the streamed struct array
+	QString mError;
+};
+
+#endif
@@ -56,7 +56,7 @@ public:
 	void stop();
 	void moveToFrame(int f);
 	
-	void convertARGB2RGB(QImage *dataIn, IplImage *dataOut);
+	static void convertARGB2RGB(QImage *dataIn, IplImage *dataOut);
 
 	bool isInitialized() {return mInitialized;}
 
@@ -0,0 +1,308 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "MotionTracker.h"
+#include "BoxTrack.h"
+#include <QMetaType>
+
+//search radius around the predicted position, in tracking image pixels
+#define MOTION_SEARCH_RAD	8
+//tracking is done on images downscaled by this factor from the display image
+#define MOTION_DOWNSCALE	2
+
+//finds the position around pred where the box content is closest to the template
+static QPointF searchPatch(const GrayImage &im, const int *tpl, QPointF pred, double bw, double bh)
+{
+	int patch[PATCH_SIZE];
+	QPointF best = pred;
+	int bestDist = -1;
+
+	for(int dy = -MOTION_SEARCH_RAD; dy <= MOTION_SEARCH_RAD; dy++)
+	{
+		for(int dx = -MOTION_SEARCH_RAD; dx <= MOTION_SEARCH_RAD; dx++)
+		{
+			QPointF c(pred.x() + dx, pred.y() + dy);
+			im.samplePatch(c.x(), c.y(), bw, bh, patch);
+			int d = GrayImage::patchDistance(tpl, patch);
+			//prefer the prediction when the match is ambiguous
+			if(bestDist < 0 || d < bestDist || (d == bestDist && qAbs(dx) + qAbs(dy) == 0))
+			{
+				bestDist = d;
+				best = c;
+			}
+		}
+	}
+
+	return best;
+}
+
+static QPointF boxCenter(const QRect &rc)
+{
+	return QPointF(rc.left() + rc.width()/2.0, rc.top() + rc.height()/2.0);
+}
+
+class MotionSegmentJob : public QRunnable
+{
+public:
+	MotionSegmentJob(MotionTracker *tracker, QSharedPointer<FrameReaderPool> readers, MotionTracker::CancelToken token,
+		QSize displaySize, int row, QString key, ViaPoint b1, ViaPoint b2)
+		: mTracker(tracker), mReaders(readers), mToken(token), mDisplaySize(displaySize), mRow(row), mKey(key), mB1(b1), mB2(b2)
+	{
+	}
+
+	virtual void run()
+	{
+		QList<ViaPoint> boxes;
+		if(*mToken == 0)
+		{
+			FrameReader *reader = mReaders->acquire();
+			boxes = MotionTracker::trackSegment(reader, mDisplaySize, mB1, mB2, mToken.data());
+			mReaders->release(reader);
+		}
+
+		//always report back, even when cancelled, so the pending counter stays correct
+		QMetaObject::invokeMethod(mTracker, "onSegmentFinished", Qt::QueuedConnection,
+			Q_ARG(int, mRow), Q_ARG(QString, mKey), Q_ARG(QList<ViaPoint>, boxes));
+	}
+
+private:
+	MotionTracker *mTracker;
+	QSharedPointer<FrameReaderPool> mReaders;
+	MotionTracker::CancelToken mToken;
+	QSize mDisplaySize;
+	int mRow;
+	QString mKey;
+	ViaPoint mB1;
+	ViaPoint mB2;
+};
+
+MotionTracker::MotionTracker(QObject *parent)
+	: QObject(parent)
+{
+	qRegisterMetaType<QList<ViaPoint> >("QList<ViaPoint>");
+	mPending = 0;
+	mDisplaySize = QSize(W_DISPLAYIMAGE, H_DISPLAYIMAGE);
+}
+
+MotionTracker::~MotionTracker()
+{
+	cancelAll();
+	mPool.waitForDone();
+}
+
+void MotionTracker::setFrameReader(QSharedPointer<FrameReader> reader)
+{
+	cancelAll();
+	mReaders.clear();
+	if(!reader.isNull() && reader->isValid())
+		mReaders = QSharedPointer<FrameReaderPool>(new FrameReaderPool(reader->fileName(), mPool.maxThreadCount()));
+}
+
+QString MotionTracker::segmentKey(const ViaPoint &b1, const ViaPoint &b2)
+{
+	QString key;
+	key.sprintf("%d:%d,%d,%d,%d:%g|%d:%d,%d,%d,%d:%g",
+		b1.frame, b1.rc.left(), b1.rc.top(), b1.rc.width(), b1.rc.height(), b1.angle,
+		b2.frame, b2.rc.left(), b2.rc.top(), b2.rc.width(), b2.rc.height(), b2.angle);
+	return key;
+}
+
+void MotionTracker::cancel(int row)
+{
+	QHash<int, QHash<QString, CancelToken> >::iterator it = mJobs.find(row);
+	if(it != mJobs.end())
+	{
+		QHash<QString, CancelToken>::iterator j;
+		for(j = it.value().begin(); j != it.value().end(); ++j)
+		{
+			j.value()->fetchAndStoreRelaxed(1);
+		}
+		mJobs.erase(it);
+	}
+}
+
+void MotionTracker::cancelAll()
+{
+	QList<int> rows = mJobs.keys();
+	for(int i = 0; i < rows.count(); i++)
+	{
+		cancel(rows[i]);
+	}
+	mCache.clear();
+}
+
+void MotionTracker::track(int row, const QList<ViaPoint> &viaPoints, BlockList<ViaPoint> &boxes)
+{
+	if(mReaders.isNull() || viaPoints.count() < 2 || boxes.isEmpty())
+	{
+		cancel(row);
+		mCache.remove(row);
+		return;
+	}
+
+	QHash<QString, CancelToken> &jobs = mJobs[row];
+	QHash<QString, QList<ViaPoint> > &cache = mCache[row];
+	QHash<QString, CancelToken> keepJobs;
+	QHash<QString, QList<ViaPoint> > keepCache;
+	int first = boxes.first().frame;
+
+	for(int i = 0; i < viaPoints.count() - 1; i++)
+	{
+		const ViaPoint &b1 = viaPoints.at(i);
+		const ViaPoint &b2 = viaPoints.at(i + 1);
+		//nothing to track between neighbouring frames
+		if(b2.frame - b1.frame < 2)
+			continue;
+
+		QString key = segmentKey(b1, b2);
+		if(cache.contains(key))
+		{
+			const QList<ViaPoint> &seg = cache[key];
+			for(int k = 0; k < seg.count(); k++)
+			{
+				//boxes that are already in place keep their block shared
+				int idx = seg[k].frame - first;
+				if(idx >= 0 && idx < boxes.count() && boxes.at(idx) != seg[k])
+					boxes.replace(idx, seg[k]);
+			}
+			keepCache.insert(key, seg);
+		}
+		else if(jobs.contains(key))
+		{
+			keepJobs.insert(key, jobs.take(key));
+		}
+		else
+		{
+			CancelToken token(new QAtomicInt(0));
+			keepJobs.insert(key, token);
+			mPending++;
+			mPool.start(new MotionSegmentJob(this, mReaders, token, mDisplaySize, row, key, b1, b2));
+		}
+	}
+
+	//whatever is left belongs to segments that are not part of the track any more
+	QHash<QString, CancelToken>::iterator j;
+	for(j = jobs.begin(); j != jobs.end(); ++j)
+	{
+		j.value()->fetchAndStoreRelaxed(1);
+	}
+	jobs = keepJobs;
+	cache = keepCache;
+	emit pendingJobsChanged(mPending);
+}
+
+void MotionTracker::onSegmentFinished(int row, QString key, QList<ViaPoint> boxes)
+{
+	mPending--;
+
+	QHash<int, QHash<QString, CancelToken> >::iterator it = mJobs.find(row);
+	if(it != mJobs.end() && it.value().contains(key))
+	{
+		//a cancelled job reports an empty list
+		bool done = !boxes.isEmpty() && *it.value().value(key) == 0;
+		it.value().remove(key);
+		if(done)
+		{
+			mCache[row].insert(key, boxes);
+			emit segmentTracked(row, boxes);
+		}
+	}
+	emit pendingJobsChanged(mPending);
+}
+
+QList<ViaPoint> MotionTracker::trackSegment(FrameReader *reader, QSize displaySize, const ViaPoint &b1, const ViaPoint &b2, const QAtomicInt *cancel)
+{
+	QList<ViaPoint> res;
+	int n = b2.frame - b1.frame;
+	if(n < 1 || reader == NULL)
+		return res;
+
+	BoxTrack lin;
+	lin.interpolate(b1, b2);
+
+	QSize work(qMax(1, displaySize.width()/MOTION_DOWNSCALE), qMax(1, displaySize.height()/MOTION_DOWNSCALE));
+	double sx = (double)work.width()/displaySize.width();
+	double sy = (double)work.height()/displaySize.height();
+
+	QVector<QPointF> linC(n + 1);
+	for(int t = 0; t <= n; t++)
+	{
+		QPointF c = boxCenter(lin.rect(t));
+		linC[t] = QPointF(c.x()*sx, c.y()*sy);
+	}
+
+	//the frames are read in order so the capture never seeks, the downscaled
+	//copies are small enough to keep for both passes
+	QVector<GrayImage> frames(n + 1);
+	for(int t = 0; t <= n; t++)
+	{
+		if(cancel && *cancel != 0)
+			return QList<ViaPoint>();
+		frames[t] = reader->readGray(b1.frame + t, work);
+	}
+	if(frames[0].isNull() || frames[n].isNull())
+		return res;
+
+	int tpl[PATCH_SIZE];
+	QVector<QPointF> fwd(n + 1), bwd(n + 1);
+	fwd[0] = linC[0];
+	fwd[n] = linC[n];
+	bwd[0] = linC[0];
+	bwd[n] = linC[n];
+
+	//forward pass seeded from the first via point
+	frames[0].samplePatch(linC[0].x(), linC[0].y(), lin.w[0]*sx, lin.h[0]*sy, tpl);
+	for(int t = 1; t < n; t++)
+	{
+		if(cancel && *cancel != 0)
+			return QList<ViaPoint>();
+
+		QPointF pred = fwd[t - 1] + (linC[t] - linC[t - 1]);
+		fwd[t] = frames[t].isNull() ? pred : searchPatch(frames[t], tpl, pred, lin.w[t]*sx, lin.h[t]*sy);
+	}
+
+	//backward pass seeded from the second via point
+	frames[n].samplePatch(linC[n].x(), linC[n].y(), lin.w[n]*sx, lin.h[n]*sy, tpl);
+	for(int t = n - 1; t > 0; t--)
+	{
+		if(cancel && *cancel != 0)
+			return QList<ViaPoint>();
+
+		QPointF pred = bwd[t + 1] + (linC[t] - linC[t + 1]);
+		bwd[t] = frames[t].isNull() ? pred : searchPatch(frames[t], tpl, pred, lin.w[t]*sx, lin.h[t]*sy);
+	}
+
+	//blend both passes, trusting each one more the closer it is to its via point
+	res << b1;
+	for(int t = 1; t < n; t++)
+	{
+		double w = (double)t/n;
+		QPointF d = fwd[t]*(1.0 - w) + bwd[t]*w - linC[t];
+		ViaPoint v = lin.at(t);
+		v.rc.translate(qRound(d.x()/sx), qRound(d.y()/sy));
+		res << v;
+	}
+	res << b2;
+
+	return res;
+}
@@ -0,0 +1,93 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef MOTIONTRACKER_H
+#define MOTIONTRACKER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QHash>
+#include <QVector>
+#include "Constants.h"
+#include "FrameReader.h"
+#include "GrayImage.h"
+
+//Motion compensated interpolation of rectangle tracks. Every segment between
+//two via points is tracked forward from the first via point and backward from
+//the second one by matching the via point contents, and the two tracks are
+//blended by the distance to each via point. Box size and angle are still
+//interpolated linearly. Segments are tracked on a thread pool, every worker
+//reads through a capture of its own; results are cached by segment end points
+//so unchanged segments are not tracked again.
+class MotionTracker : public QObject
+{
+	Q_OBJECT
+
+public:
+	MotionTracker(QObject *parent = NULL);
+	virtual ~MotionTracker();
+
+	//drops all pending jobs and cached results and opens the file of the reader
+	//once for every worker thread
+	void setFrameReader(QSharedPointer<FrameReader> reader);
+	//size of the image the boxes are defined in
+	void setDisplaySize(QSize sz) { mDisplaySize = sz; }
+
+	//Patches the linearly interpolated boxes of the label in the given row with
+	//already tracked segments and schedules tracking of the remaining ones.
+	//Pending jobs of the row for segments that no longer exist are cancelled.
+	void track(int row, const QList<ViaPoint> &viaPoints, BlockList<ViaPoint> &boxes);
+	void cancel(int row);
+	void cancelAll();
+	int pendingJobs() const { return mPending; }
+
+	//decodes every frame of the segment once, in order, for both passes
+	static QList<ViaPoint> trackSegment(FrameReader *reader, QSize displaySize, const ViaPoint &b1, const ViaPoint &b2, const QAtomicInt *cancel = NULL);
+
+signals:
+	//emitted in the GUI thread for every finished segment, boxes include both via points
+	void segmentTracked(int row, QList<ViaPoint> boxes);
+	void pendingJobsChanged(int n);
+
+private slots:
+	void onSegmentFinished(int row, QString key, QList<ViaPoint> boxes);
+
+private:
+	friend class MotionSegmentJob;
+	typedef QSharedPointer<QAtomicInt> CancelToken;
+
+	static QString segmentKey(const ViaPoint &b1, const ViaPoint &b2);
+
+	QThreadPool mPool;
+	QSharedPointer<FrameReaderPool> mReaders;
+	QSize mDisplaySize;
+	//all members below are only touched from the GUI thread
+	QHash<int, QHash<QString, CancelToken> > mJobs;
+	QHash<int, QHash<QString, QList<ViaPoint> > > mCache;
+	int mPending;
+};
+
+#endif
@@ -0,0 +1,175 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "NpzWriter.h"
+#include "LittleEndian.h"
+#include <QDateTime>
+
+//zip record signatures
+#define ZIP_LOCAL_HEADER	0x04034b50
+#define ZIP_CENTRAL_HEADER	0x02014b50
+#define ZIP_END_OF_DIR		0x06054b50
+//extra field id used for alignment padding
+#define ZIP_ALIGN_FIELD		0xd935
+#define ZIP_LOCAL_HEADER_SIZE	30
+
+NpzWriter::NpzWriter(QIODevice *device)
+	: mDevice(device), mPos(0)
+{
+	QDateTime now = QDateTime::currentDateTime();
+	QDate d = now.date();
+	QTime t = now.time();
+	mDosTime = (quint16)((t.hour() << 11) | (t.minute() << 5) | (t.second() / 2));
+	mDosDate = (quint16)(((qMax(d.year(), 1980) - 1980) << 9) | (d.month() << 5) | d.day());
+}
+
+QByteArray NpzWriter::npyHeader(const QString &descr, const QList<int> &shape)
+{
+	QString dims;
+	for(int i = 0; i < shape.count(); i++)
+	{
+		dims += (i > 0 ? ", " : "") + QString::number(shape[i]);
+	}
+	if(shape.count() == 1)
+		dims += ",";
+
+	QByteArray dict = QString("{'descr': %1, 'fortran_order': False, 'shape': (%2), }").arg(descr).arg(dims).toAscii();
+
+	//magic, version and header length take 10 bytes, the dict ends with a newline
+	int len = dict.size() + 1;
+	int padded = (10 + len + NPY_ALIGNMENT - 1) / NPY_ALIGNMENT * NPY_ALIGNMENT - 10;
+
+	QByteArray res("\x93NUMPY\x01\x00", 8);
+	putU16(res, (quint16)padded);
+	res += dict;
+	res += QByteArray(padded - len, ' ');
+	res += '\n';
+	return res;
+}
+
+bool NpzWriter::write(const QByteArray &data)
+{
+	if(mDevice->write(data) != data.size())
+	{
+		if(mError.isEmpty())
+			mError = mDevice->errorString();
+		return false;
+	}
+	mPos += data.size();
+	return true;
+}
+
+bool NpzWriter::addArray(const QString &name, const QString &descr, const QList<int> &shape, const QByteArray &data)
+{
+	if(!mError.isEmpty())
+		return false;
+	if(mEntries.count() == 0xffff)
+	{
+		mError = "Too many arrays for one archive.";
+		return false;
+	}
+
+	QByteArray npy = npyHeader(descr, shape) + data;
+	QByteArray fileName = (name + ".npy").toUtf8();
+	if(mPos + ZIP_LOCAL_HEADER_SIZE + fileName.size() + NPY_ALIGNMENT + 4 + npy.size() > Q_INT64_C(0xffffffff))
+	{
+		mError = "The archive is larger than 4 GB.";
+		return false;
+	}
+
+	//the npy header is a multiple of NPY_ALIGNMENT long, so aligning the start
+	//of the entry data aligns the array; the padding extra field needs 4 bytes
+	int headerEnd = (int)((mPos + ZIP_LOCAL_HEADER_SIZE + fileName.size() + 4) % NPY_ALIGNMENT);
+	int padding = (NPY_ALIGNMENT - headerEnd) % NPY_ALIGNMENT;
+
+	Entry e;
+	e.name = fileName;
+	e.crc = crc32(npy);
+	e.size = npy.size();
+	e.offset = (quint32)mPos;
+
+	QByteArray header;
+	putU32(header, ZIP_LOCAL_HEADER);
+	putU16(header, 20);		//version needed
+	putU16(header, 0);		//flags
+	putU16(header, 0);		//stored
+	putU16(header, mDosTime);
+	putU16(header, mDosDate);
+	putU32(header, e.crc);
+	putU32(header, e.size);
+	putU32(header, e.size);
+	putU16(header, (quint16)fileName.size());
+	putU16(header, (quint16)(4 + padding));
+	header += fileName;
+	putU16(header, ZIP_ALIGN_FIELD);
+	putU16(header, (quint16)padding);
+	header += QByteArray(padding, '\0');
+
+	if(!write(header) || !write(npy))
+		return false;
+	mEntries << e;
+	return true;
+}
+
+bool NpzWriter::finish()
+{
+	if(!mError.isEmpty())
+		return false;
+
+	quint32 dirOffset = (quint32)mPos;
+	QByteArray dir;
+	for(int i = 0; i < mEntries.count(); i++)
+	{
+		const Entry &e = mEntries[i];
+		putU32(dir, ZIP_CENTRAL_HEADER);
+		putU16(dir, 20);	//version made by
+		putU16(dir, 20);	//version needed
+		putU16(dir, 0);		//flags
+		putU16(dir, 0);		//stored
+		putU16(dir, mDosTime);
+		putU16(dir, mDosDate);
+		putU32(dir, e.crc);
+		putU32(dir, e.size);
+		putU32(dir, e.size);
+		putU16(dir, (quint16)e.name.size());
+		putU16(dir, 0);		//extra field
+		putU16(dir, 0);		//comment
+		putU16(dir, 0);		//disk
+		putU16(dir, 0);		//internal attributes
+		putU32(dir, 0);		//external attributes
+		putU32(dir, e.offset);
+		dir += e.name;
+	}
+
+	quint32 dirSize = dir.size();
+	putU32(dir, ZIP_END_OF_DIR);
+	putU16(dir, 0);
+	putU16(dir, 0);
+	putU16(dir, (quint16)mEntries.count());
+	putU16(dir, (quint16)mEntries.count());
+	putU32(dir, dirSize);
+	putU32(dir, dirOffset);
+	putU16(dir, 0);
+
+	return write(dir);
+}
@@ -0,0 +1,77 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef NPZWRITER_H
+#define NPZWRITER_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QString>
+#include <QList>
+#include "Crc32.h"
+
+//alignment of the array data inside the archive, the same as numpy uses for its headers
+#define NPY_ALIGNMENT	64
+
+//Writes NumPy arrays into an uncompressed .npz archive (a zip of .npy files).
+//The entries are stored, so the data of every array is contiguous in the
+//archive, and padded so that it starts on an NPY_ALIGNMENT boundary. Loaders
+//can memory-map the arrays at their offsets without unpacking anything.
+//Archives are limited to 4 GB, zip64 isn't written.
+class NpzWriter
+{
+public:
+	NpzWriter(QIODevice *device);
+
+	//descr is the numpy type description, e.g. "'<i4'" or a list of fields for
+	//a structured array, data holds the items in C order
+	bool addArray(const QString &name, const QString &descr, const QList<int> &shape, const QByteArray &data);
+	//writes the zip central directory, returns false if any write failed
+	bool finish();
+	QString errorString() const { return mError; }
+
+	//version 1.0 .npy header padded to NPY_ALIGNMENT
+	static QByteArray npyHeader(const QString &descr, const QList<int> &shape);
+	quint32 crc32(const QByteArray &data, quint32 crc = 0) const { return mCrc.checksum(data, crc); }
+
+private:
+	bool write(const QByteArray &data);
+
+	struct Entry
+	{
+		QByteArray name;
+		quint32 crc;
+		quint32 size;
+		quint32 offset;
+	};
+
+	QIODevice *mDevice;
+	QList<Entry> mEntries;
+	qint64 mPos;
+	quint16 mDosTime;
+	quint16 mDosDate;
+	Crc32 mCrc;
+	QString mError;
+};
+
+#endif
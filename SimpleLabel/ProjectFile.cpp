@@ -0,0 +1,552 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "ProjectFile.h"
+#include "Track.h"
+#include "FileSync.h"
+#include "LittleEndian.h"
+#include <QTime>
+#include <QHash>
+#include <QStringList>
+#include <string.h>
+
+//block types
+#define BLOCK_BOXES		1
+#define BLOCK_POLYGONS	2
+#define BLOCK_HEADER_SIZE	16
+//size of a box in a box block
+#define BOX_SIZE		24
+
+static void padTo(QByteArray &buf, int alignment)
+{
+	buf.append(QByteArray((alignment - buf.size() % alignment) % alignment, '\0'));
+}
+
+ProjectFile::ProjectFile()
+	: mElapsed(0), mBlocksWritten(0), mBlocksKept(0), mBytesWritten(0)
+{
+}
+
+template<class List>
+ProjectFile::Block ProjectFile::makeBoxBlock(const List &boxes) const
+{
+	QByteArray payload;
+	payload.reserve(boxes.count()*BOX_SIZE);
+	for(int i = 0; i < boxes.count(); i++)
+	{
+		const ViaPoint &b = boxes.at(i);
+		putU32(payload, b.frame);
+		putU32(payload, b.rc.x());
+		putU32(payload, b.rc.y());
+		putU32(payload, b.rc.width());
+		putU32(payload, b.rc.height());
+		putF32(payload, b.angle);
+	}
+
+	Block res;
+	putU32(res.data, BLOCK_BOXES);
+	putU32(res.data, boxes.count());
+	putU32(res.data, payload.size());
+	putU32(res.data, mCrc.checksum(payload));
+	res.data += payload;
+	res.offset = -1;
+	return res;
+}
+
+template<class List>
+ProjectFile::Block ProjectFile::makePolygonBlock(const List &polygons) const
+{
+	QByteArray payload;
+	for(int i = 0; i < polygons.count(); i++)
+	{
+		const SmallPolygon &pl = polygons.at(i).pl;
+		putU32(payload, polygons.at(i).frame);
+		putU32(payload, pl.count());
+		for(int k = 0; k < pl.count(); k++)
+		{
+			putU32(payload, pl[k].x());
+			putU32(payload, pl[k].y());
+		}
+	}
+	padTo(payload, 8);
+
+	Block res;
+	putU32(res.data, BLOCK_POLYGONS);
+	putU32(res.data, polygons.count());
+	putU32(res.data, payload.size());
+	putU32(res.data, mCrc.checksum(payload));
+	res.data += payload;
+	res.offset = -1;
+	return res;
+}
+
+QByteArray ProjectFile::makeHeader(int labelCount, const QSize &displaySize, const QSize &imageSize, qint64 tableOffset, const QByteArray &table) const
+{
+	QByteArray res(PROJECT_MAGIC);
+	putU32(res, PROJECT_VERSION);
+	putU32(res, labelCount);
+	putU32(res, displaySize.width());
+	putU32(res, displaySize.height());
+	putU32(res, imageSize.width());
+	putU32(res, imageSize.height());
+	putU64(res, tableOffset);
+	putU32(res, table.size());
+	putU32(res, mCrc.checksum(table));
+	padTo(res, PROJECT_HEADER_SIZE);
+	res.chop(4);
+	putU32(res, mCrc.checksum(res));
+	return res;
+}
+
+bool ProjectFile::readHeader(const uchar *data, qint64 size, Mapping &map)
+{
+	if(size < PROJECT_HEADER_SIZE || memcmp(data, PROJECT_MAGIC, 8) != 0)
+	{
+		mError = "Not a SimpleLabel project.";
+		return false;
+	}
+	if(getU32(data + 8) != PROJECT_VERSION)
+	{
+		mError = QString("Unsupported project version %1.").arg(getU32(data + 8));
+		return false;
+	}
+	if(getU32(data + PROJECT_HEADER_SIZE - 4) != mCrc.checksum((const char*)data, PROJECT_HEADER_SIZE - 4))
+	{
+		mError = "The project header is damaged.";
+		return false;
+	}
+
+	map.data = data;
+	map.size = size;
+	map.labelCount = getU32(data + 12);
+	map.displaySize = QSize(getI32(data + 16), getI32(data + 20));
+	map.imageSize = QSize(getI32(data + 24), getI32(data + 28));
+	map.tableOffset = getU64(data + 32);
+	map.tableSize = getU32(data + 40);
+	if(map.tableOffset < PROJECT_HEADER_SIZE || map.tableOffset + map.tableSize > size ||
+		(qint64)map.labelCount*PROJECT_RECORD_SIZE + 4 > map.tableSize ||
+		getU32(data + 44) != mCrc.checksum((const char*)data + map.tableOffset, map.tableSize))
+	{
+		mError = "The label table of the project is damaged.";
+		map.data = NULL;
+		return false;
+	}
+	return true;
+}
+
+bool ProjectFile::readBlock(const Mapping &map, qint64 offset, quint32 type, const uchar *&payload, int &count, int &bytes)
+{
+	if(offset < PROJECT_HEADER_SIZE || offset + BLOCK_HEADER_SIZE > map.size)
+		return false;
+
+	const uchar *p = map.data + offset;
+	if(getU32(p) != type || offset + BLOCK_HEADER_SIZE + getU32(p + 8) > map.size)
+		return false;
+	count = getU32(p + 4);
+	bytes = getU32(p + 8);
+	payload = p + BLOCK_HEADER_SIZE;
+	return getU32(p + 12) == mCrc.checksum((const char*)payload, bytes);
+}
+
+template<class List>
+static bool decodeBoxes(const uchar *payload, int count, int bytes, List &boxes)
+{
+	if((qint64)count*BOX_SIZE > bytes)
+		return false;
+
+	for(int k = 0; k < count; k++)
+	{
+		const uchar *b = payload + k*BOX_SIZE;
+		boxes.append(ViaPoint(getI32(b), getF32(b + 20), QRect(getI32(b + 4), getI32(b + 8), getI32(b + 12), getI32(b + 16))));
+	}
+	return true;
+}
+
+template<class List>
+static bool decodePolygons(const uchar *payload, int count, int bytes, List &polygons)
+{
+	const uchar *p = payload;
+	const uchar *end = payload + bytes;
+	for(int k = 0; k < count; k++)
+	{
+		if(p + 8 > end || p + 8 + 8*(qint64)getU32(p + 4) > end)
+			return false;
+
+		ViaPointPolygon v;
+		v.frame = getI32(p);
+		int n = getU32(p + 4);
+		p += 8;
+		v.pl.reserve(n);
+		for(int j = 0; j < n; j++, p += 8)
+		{
+			v.pl << QPoint(getI32(p), getI32(p + 4));
+		}
+		polygons.append(v);
+	}
+	return true;
+}
+
+bool ProjectFile::open(const QString &file, const QSize &displaySize)
+{
+	QTime timer;
+	timer.start();
+	mLabels.clear();
+	mError.clear();
+
+	QFile fd(file);
+	if(!fd.open(QIODevice::ReadOnly))
+	{
+		mError = fd.errorString();
+		return false;
+	}
+	uchar *data = fd.map(0, fd.size());
+	if(data == NULL)
+	{
+		mError = fd.errorString();
+		return false;
+	}
+
+	Mapping map;
+	bool ok = readHeader(data, fd.size(), map) && decodeLabels(map, displaySize);
+	fd.unmap(data);
+	if(!ok)
+		mLabels.clear();
+	mImageSize = map.imageSize;
+	mElapsed = timer.elapsed();
+	return ok;
+}
+
+bool ProjectFile::decodeLabels(const Mapping &map, const QSize &displaySize)
+{
+	const uchar *table = map.data + map.tableOffset;
+	const uchar *end = table + map.tableSize;
+
+	//interned strings follow the label records
+	const uchar *p = table + map.labelCount*PROJECT_RECORD_SIZE;
+	int stringCount = getU32(p);
+	p += 4;
+	QStringList strings;
+	for(int i = 0; i < stringCount; i++)
+	{
+		if(end - p < 4 || (quint32)(end - p - 4) < getU32(p))
+		{
+			mError = "The string table of the project is damaged.";
+			return false;
+		}
+		int len = getU32(p);
+		strings << QString::fromUtf8((const char*)p + 4, len);
+		p += 4 + (len + 3)/4*4;
+	}
+
+	bool scale = map.displaySize != displaySize;
+
+	for(int i = 0; i < map.labelCount; i++)
+	{
+		const uchar *rec = table + i*PROJECT_RECORD_SIZE;
+		Label lb;
+		lb.number = getI32(rec);
+		lb.shape = (LabelShape)getI32(rec + 4);
+		lb.intr = (InterpolationMethod)getI32(rec + 8);
+		quint32 name = getU32(rec + 12);
+		quint32 desc = getU32(rec + 16);
+		qint64 keys = getU64(rec + 24);
+		qint64 dense = getU64(rec + 32);
+		if(name >= (quint32)strings.count() || desc >= (quint32)strings.count())
+		{
+			mError = QString("Label %1 of the project is damaged.").arg(i + 1);
+			return false;
+		}
+		lb.name = strings[name];
+		lb.desc = strings[desc];
+
+		const uchar *payload;
+		int count, bytes;
+		bool ok;
+		if(lb.shape == Polyg)
+		{
+			ok = readBlock(map, keys, BLOCK_POLYGONS, payload, count, bytes) && decodePolygons(payload, count, bytes, lb.viaPointsPoly) &&
+				(dense == 0 || (readBlock(map, dense, BLOCK_POLYGONS, payload, count, bytes) && decodePolygons(payload, count, bytes, lb.polygons)));
+		}
+		else
+		{
+			ok = readBlock(map, keys, BLOCK_BOXES, payload, count, bytes) && decodeBoxes(payload, count, bytes, lb.viaPoints) &&
+				(dense == 0 || (readBlock(map, dense, BLOCK_BOXES, payload, count, bytes) && decodeBoxes(payload, count, bytes, lb.boxes)));
+		}
+		if(!ok)
+		{
+			mError = QString("The track of label %1 of the project is damaged.").arg(i + 1);
+			return false;
+		}
+
+		if(scale)
+			scaleLabel(lb, map.displaySize, displaySize);
+
+		if(dense == 0)
+		{
+			if(lb.shape == Polyg)
+				Track<PolygonShape>(lb).rebuild();
+			else
+				Track<RectShape>(lb).rebuild();
+		}
+		mLabels.append(lb);
+	}
+	return true;
+}
+
+//converts the stored coordinates to another display size, the via points are
+//kept on the dense track since both are rounded separately
+void ProjectFile::scaleLabel(Label &lb, const QSize &from, const QSize &to)
+{
+	int sw = from.width(), sh = from.height();
+	int dw = to.width(), dh = to.height();
+
+	for(int k = 0; k < lb.boxes.count(); k++)
+	{
+		ViaPoint bx = lb.boxes.at(k);
+		bx.rc = CommonFunctions::imageToImage(sw, sh, bx.rc, dw, dh);
+		lb.boxes.replace(k, bx);
+	}
+	for(int k = 0; k < lb.viaPoints.count(); k++)
+	{
+		const ViaPoint *bx = lb.findBoxByFrame(lb.viaPoints[k].frame);
+		lb.viaPoints[k].rc = bx != NULL ? bx->rc : CommonFunctions::imageToImage(sw, sh, lb.viaPoints[k].rc, dw, dh);
+	}
+
+	for(int k = 0; k < lb.polygons.count(); k++)
+	{
+		ViaPointPolygon pl = lb.polygons.at(k);
+		pl.pl = CommonFunctions::imageToImage(sw, sh, pl.pl, dw, dh);
+		lb.polygons.replace(k, pl);
+	}
+	for(int k = 0; k < lb.viaPointsPoly.count(); k++)
+	{
+		const ViaPointPolygon *pl = lb.findPolygonByFrame(lb.viaPointsPoly[k].frame);
+		lb.viaPointsPoly[k].pl = pl != NULL ? pl->pl : CommonFunctions::imageToImage(sw, sh, lb.viaPointsPoly[k].pl, dw, dh);
+	}
+}
+
+qint64 ProjectFile::findBlock(const Mapping &map, const QMultiHash<quint32, qint64> &index, const QByteArray &block) const
+{
+	QList<qint64> offsets = index.values(getU32((const uchar*)block.constData() + 12));
+	for(int i = 0; i < offsets.count(); i++)
+	{
+		qint64 o = offsets[i];
+		if(o + block.size() <= map.size && memcmp(map.data + o, block.constData(), block.size()) == 0)
+			return o;
+	}
+	return -1;
+}
+
+bool ProjectFile::save(const QString &file, const QList<Label> &labels, const QSize &displaySize, const QSize &imageSize)
+{
+	QTime timer;
+	timer.start();
+	mError.clear();
+	mBlocksWritten = 0;
+	mBlocksKept = 0;
+	mBytesWritten = 0;
+
+	//every label has a via point block, motion tracked ones also a dense block
+	QList<Block> blocks;
+	QVector<int> keys(labels.count()), dense(labels.count(), -1);
+	for(int i = 0; i < labels.count(); i++)
+	{
+		const Label &lb = labels[i];
+		bool motion = lb.intr == Motion;
+		keys[i] = blocks.count();
+		if(lb.shape == Polyg)
+		{
+			blocks << makePolygonBlock(lb.viaPointsPoly);
+			if(motion)
+				blocks << makePolygonBlock(lb.polygons);
+		}
+		else
+		{
+			blocks << makeBoxBlock(lb.viaPoints);
+			if(motion)
+				blocks << makeBoxBlock(lb.boxes);
+		}
+		if(motion)
+			dense[i] = blocks.count() - 1;
+	}
+
+	QFile fd(file);
+	if(!fd.open(QIODevice::ReadWrite))
+	{
+		mError = fd.errorString();
+		return false;
+	}
+
+	//find the blocks that are already in the file, the header and a table
+	//of about the old size are in use after the save as well
+	qint64 fileSize = fd.size();
+	qint64 live = 0;
+	Mapping map;
+	uchar *data = fileSize >= PROJECT_HEADER_SIZE ? fd.map(0, fileSize) : NULL;
+	if(data != NULL && readHeader(data, fileSize, map))
+	{
+		QMultiHash<quint32, qint64> index;
+		for(int i = 0; i < map.labelCount; i++)
+		{
+			const uchar *rec = data + map.tableOffset + i*PROJECT_RECORD_SIZE;
+			for(int k = 0; k < 2; k++)
+			{
+				qint64 o = getU64(rec + 24 + 8*k);
+				if(o >= PROJECT_HEADER_SIZE && o + BLOCK_HEADER_SIZE <= fileSize)
+					index.insert(getU32(data + o + 12), o);
+			}
+		}
+		for(int i = 0; i < blocks.count(); i++)
+		{
+			blocks[i].offset = findBlock(map, index, blocks[i].data);
+			if(blocks[i].offset >= 0)
+				live += blocks[i].data.size();
+		}
+		if(live > 0)
+			live += PROJECT_HEADER_SIZE + map.tableSize;
+	}
+	mError.clear();
+	if(data != NULL)
+		fd.unmap(data);
+
+	qint64 appended = 0;
+	for(int i = 0; i < blocks.count(); i++)
+	{
+		if(blocks[i].offset < 0)
+			appended += blocks[i].data.size();
+	}
+
+	bool ok;
+	if(live > 0 && live + appended >= PROJECT_MIN_LIVE_RATIO*(fileSize + appended))
+	{
+		//append the changed blocks and a new table, the header is written last
+		ok = writeProject(fd, true, blocks, labels, keys, dense, displaySize, imageSize);
+		fd.close();
+	}
+	else
+	{
+		//the whole project goes to a new file that replaces the old one when it's complete
+		fd.close();
+		for(int i = 0; i < blocks.count(); i++)
+		{
+			blocks[i].offset = -1;
+		}
+
+		QFile tmp(file + ".tmp");
+		ok = tmp.open(QIODevice::WriteOnly | QIODevice::Truncate);
+		if(ok)
+		{
+			ok = writeProject(tmp, false, blocks, labels, keys, dense, displaySize, imageSize);
+			tmp.close();
+		}
+		else
+		{
+			mError = tmp.errorString();
+		}
+
+		if(ok)
+		{
+			ok = FileSync::replace(tmp.fileName(), file);
+			if(!ok)
+				mError = "Failed to replace " + file;
+		}
+		if(!ok)
+			tmp.remove();
+	}
+
+	mElapsed = timer.elapsed();
+	return ok;
+}
+
+bool ProjectFile::writeProject(QFile &fd, bool append, QList<Block> &blocks, const QList<Label> &labels, const QVector<int> &keys,
+	const QVector<int> &dense, const QSize &displaySize, const QSize &imageSize)
+{
+	//appended blocks start on an 8 byte boundary, a new file starts with the space for the header
+	qint64 start = append ? fd.size() : 0;
+	QByteArray out = append ? QByteArray((int)((8 - start % 8) % 8), '\0') : QByteArray(PROJECT_HEADER_SIZE, '\0');
+	if(!fd.seek(start))
+	{
+		mError = fd.errorString();
+		return false;
+	}
+
+	for(int i = 0; i < blocks.count(); i++)
+	{
+		if(blocks[i].offset >= 0)
+		{
+			mBlocksKept++;
+			continue;
+		}
+		blocks[i].offset = start + out.size();
+		out += blocks[i].data;
+		mBlocksWritten++;
+	}
+
+	//label records and interned strings
+	QByteArray table;
+	QHash<QString, int> stringIds;
+	QByteArray strings;
+	for(int i = 0; i < labels.count(); i++)
+	{
+		const Label &lb = labels[i];
+		int ids[2];
+		QString texts[2] = {lb.name, lb.desc};
+		for(int k = 0; k < 2; k++)
+		{
+			QHash<QString, int>::const_iterator it = stringIds.constFind(texts[k]);
+			if(it == stringIds.constEnd())
+			{
+				it = stringIds.insert(texts[k], stringIds.count());
+				QByteArray utf = texts[k].toUtf8();
+				putU32(strings, utf.size());
+				strings += utf;
+				padTo(strings, 4);
+			}
+			ids[k] = it.value();
+		}
+
+		putU32(table, lb.number);
+		putU32(table, lb.shape);
+		putU32(table, lb.intr);
+		putU32(table, ids[0]);
+		putU32(table, ids[1]);
+		putU32(table, 0);
+		putU64(table, blocks[keys[i]].offset);
+		putU64(table, dense[i] >= 0 ? blocks[dense[i]].offset : 0);
+	}
+	putU32(table, stringIds.count());
+	table += strings;
+	padTo(table, 8);
+
+	qint64 tableOffset = start + out.size();
+	out += table;
+
+	//the blocks and the table are on the disk before the header points to
+	//them, so a crash leaves the old header with the old table
+	QByteArray header = makeHeader(labels.count(), displaySize, imageSize, tableOffset, table);
+	bool ok = fd.write(out) == out.size() && FileSync::sync(fd) && fd.seek(0) && fd.write(header) == header.size() && FileSync::sync(fd);
+	if(!ok)
+		mError = fd.errorString();
+	mBytesWritten = out.size() + header.size();
+	return ok;
+}
@@ -0,0 +1,128 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef PROJECTFILE_H
+#define PROJECTFILE_H
+
+#include <QList>
+#include <QSize>
+#include <QString>
+#include <QByteArray>
+#include <QMultiHash>
+#include <QVector>
+#include <QFile>
+#include "Constants.h"
+#include "Crc32.h"
+
+#define PROJECT_MAGIC			"SLPROJ\r\n"
+#define PROJECT_VERSION			1
+#define PROJECT_HEADER_SIZE		64
+//size of a label record in the label table
+#define PROJECT_RECORD_SIZE		40
+//the file is rewritten from scratch when less than this part of it is in use
+#define PROJECT_MIN_LIVE_RATIO	0.5
+
+//Binary SimpleLabel project. The file is a header, blocks of via points and
+//dense tracks, and a label table with the interned label names at the end:
+//
+//	header		magic, version, label count, display and image size,
+//				offset, size and crc of the table, crc of the header
+//	blocks		type, item count, size and crc of the payload, the payload
+//	table		one record per label (number, shape, interpolation, name and
+//				description string ids, offsets of the via point block and of
+//				the dense block or 0), then the string table
+//
+//The coordinates are stored in display coordinates, so opening the project
+//with the same display size needs no scaling. Only motion tracked labels
+//store their dense track, the others are interpolated from the via points.
+//
+//Saving into the file a project was opened from or saved to keeps the blocks
+//that didn't change, appends the new ones and a new table, and rewrites the
+//header last, after the rest is synced to the disk; until then the file still
+//holds the previous version. A file with too little in use is written anew
+//next to the old one, which it replaces in one rename.
+class ProjectFile
+{
+public:
+	ProjectFile();
+
+	//the file is memory-mapped and the labels are decoded straight from it,
+	//they are scaled to displaySize if it differs from the stored one
+	bool open(const QString &file, const QSize &displaySize);
+	//labels are in displaySize coordinates
+	bool save(const QString &file, const QList<Label> &labels, const QSize &displaySize, const QSize &imageSize);
+
+	const QList<Label> &labels() const { return mLabels; }
+	QSize imageSize() const { return mImageSize; }
+	QString errorString() const { return mError; }
+	//time of the last open or save in milliseconds
+	int elapsed() const { return mElapsed; }
+	//blocks and bytes written by the last save, and the blocks it kept
+	int blocksWritten() const { return mBlocksWritten; }
+	int blocksKept() const { return mBlocksKept; }
+	qint64 bytesWritten() const { return mBytesWritten; }
+
+private:
+	//the file as it is on disk, mapped for reading
+	struct Mapping
+	{
+		Mapping() : data(NULL), size(0), labelCount(0), tableOffset(0), tableSize(0) {}
+
+		const uchar *data;
+		qint64 size;
+		QSize displaySize;
+		QSize imageSize;
+		int labelCount;
+		qint64 tableOffset;
+		int tableSize;
+	};
+
+	//block to be written, or found in the file with the same content
+	struct Block
+	{
+		QByteArray data;	//header and payload
+		qint64 offset;
+	};
+
+	bool readHeader(const uchar *data, qint64 size, Mapping &map);
+	bool readBlock(const Mapping &map, qint64 offset, quint32 type, const uchar *&payload, int &count, int &bytes);
+	bool decodeLabels(const Mapping &map, const QSize &displaySize);
+	static void scaleLabel(Label &lb, const QSize &from, const QSize &to);
+	template<class List> Block makeBoxBlock(const List &boxes) const;
+	template<class List> Block makePolygonBlock(const List &polygons) const;
+	qint64 findBlock(const Mapping &map, const QMultiHash<quint32, qint64> &index, const QByteArray &block) const;
+	bool writeProject(QFile &fd, bool append, QList<Block> &blocks, const QList<Label> &labels, const QVector<int> &keys,
+		const QVector<int> &dense, const QSize &displaySize, const QSize &imageSize);
+	QByteArray makeHeader(int labelCount, const QSize &displaySize, const QSize &imageSize, qint64 tableOffset, const QByteArray &table) const;
+
+	Crc32 mCrc;
+	QList<Label> mLabels;
+	QSize mImageSize;
+	QString mError;
+	int mElapsed;
+	int mBlocksWritten;
+	int mBlocksKept;
+	qint64 mBytesWritten;
+};
+
+#endif
@@ -22,6 +22,7 @@
 				John K. Tsotsos <tsotsos@cse.yorku.ca>
 */
 #include "SaveDialog.h"
+#include "Exporter.h"
 #include <QDebug>
 #include <QFileDialog>
 
@@ -35,6 +36,9 @@ SaveDialog::SaveDialog(QWidget *parent, Qt::WindowFlags flags)
 	connect(ui.rbtnMatlabStruct, SIGNAL(toggled(bool)), this, SLOT(rbtnFormat_toggled(bool)));
 	connect(ui.rbtnSimpleLabelXML, SIGNAL(toggled(bool)), this, SLOT(rbtnFormat_toggled(bool)));
 	connect(ui.rbtLabelMeXML, SIGNAL(toggled(bool)), this, SLOT(rbtnFormat_toggled(bool)));
+	connect(ui.rbtnNumpy, SIGNAL(toggled(bool)), this, SLOT(rbtnFormat_toggled(bool)));
+	connect(ui.rbtnInstanceMasks, SIGNAL(toggled(bool)), this, SLOT(rbtnFormat_toggled(bool)));
+	connect(ui.rbtnSemanticMasks, SIGNAL(toggled(bool)), this, SLOT(rbtnFormat_toggled(bool)));
 	connect(ui.rbtnSaveAsAVI, SIGNAL(toggled(bool)), this, SLOT(rbtnFormat_toggled(bool)));
 	connect(ui.rbtnSaveImgSeq, SIGNAL(toggled(bool)), this, SLOT(rbtnFormat_toggled(bool)));
 	connect(ui.edtFirstImageIndex, SIGNAL(textChanged(const QString &)), this, SLOT(on_edtFileNamePrefix_textChanged(const QString &)));
@@ -50,6 +54,34 @@ SaveDialog::~SaveDialog(void)
 }
 
 
+QString SaveDialog::codec() const
+{
+	//the list entries start with the fourcc, the first one is the default codec
+	if(ui.cmbCodec->currentIndex() <= 0)
+		return "";
+	return ui.cmbCodec->currentText().left(4);
+}
+
+void SaveDialog::setCodec(const QString &fourcc)
+{
+	if(fourcc.isEmpty())
+	{
+		ui.cmbCodec->setCurrentIndex(0);
+		return;
+	}
+
+	for(int i = 1; i < ui.cmbCodec->count(); i++)
+	{
+		if(ui.cmbCodec->itemText(i).left(4).compare(fourcc, Qt::CaseInsensitive) == 0)
+		{
+			ui.cmbCodec->setCurrentIndex(i);
+			return;
+		}
+	}
+	ui.cmbCodec->addItem(fourcc.left(4));
+	ui.cmbCodec->setCurrentIndex(ui.cmbCodec->count() - 1);
+}
+
 void SaveDialog::rbtnFormat_toggled(bool b)
 {
 	if(b)
@@ -58,12 +90,25 @@ void SaveDialog::rbtnFormat_toggled(bool b)
 		{
 			ui.rbtnSaveAsAVI->setEnabled(true);
 			ui.rbtnSaveImgSeq->setEnabled(true);			
+			ui.cmbImageFormat->setEnabled(ui.rbtnSaveImgSeq->isChecked());
+			ui.cmbCodec->setEnabled(ui.rbtnSaveAsAVI->isChecked());
+			ui.spinSegments->setEnabled(ui.rbtnSaveAsAVI->isChecked());
 		}
 		else
 		{
 			ui.rbtnSaveAsAVI->setDisabled(true);
 			ui.rbtnSaveImgSeq->setDisabled(true);
+			ui.cmbImageFormat->setDisabled(true);
+			ui.cmbCodec->setDisabled(true);
+			ui.spinSegments->setDisabled(true);
 		}
+		//only the exports writing a file per frame can skip the unchanged frames
+		//or pack the frames into an archive
+		bool movie = ui.rbtnBlackBgrd->isChecked() || ui.rbtnOrigImage->isChecked();
+		bool perFrame = (movie && ui.rbtnSaveImgSeq->isChecked()) || ui.rbtLabelMeXML->isChecked() ||
+			ui.rbtnInstanceMasks->isChecked() || ui.rbtnSemanticMasks->isChecked();
+		ui.chkChangedFramesOnly->setEnabled(perFrame);
+		ui.chkArchive->setEnabled(perFrame);
 
 		if(ui.rbtnBlackBgrd->isChecked() || ui.rbtnOrigImage->isChecked())
 		{
@@ -77,8 +122,8 @@ void SaveDialog::rbtnFormat_toggled(bool b)
 			else
 			{
 				mBrowseSettings.title = tr("Save As Image Sequense");
-				mBrowseSettings.ext = tr(".png");
-				mBrowseSettings.filter = tr("Image Files (*.png)");
+				mBrowseSettings.ext = Exporter::imageExtension((ImageSequenceFormat)ui.cmbImageFormat->currentIndex());
+				mBrowseSettings.filter = tr("Image Files (*%1)").arg(mBrowseSettings.ext);
 				mBrowseSettings.index = mBrowseSettings.index.sprintf("%05d",ui.edtFirstImageIndex->text().toInt());
 				
 			}
@@ -86,9 +131,10 @@ void SaveDialog::rbtnFormat_toggled(bool b)
 		}
 		else if(ui.rbtnMatlabStruct->isChecked())
 		{
+			//a .m file name writes the structure as a Matlab function instead
 			mBrowseSettings.title = tr("Save As Matlab structure");
-			mBrowseSettings.ext = tr(".m");
-			mBrowseSettings.filter = tr("Matlab Files (*.m)");
+			mBrowseSettings.ext = tr(".mat");
+			mBrowseSettings.filter = tr("MAT-files (*.mat);;Matlab Files (*.m)");
 			mBrowseSettings.index = "";
 			
 		}
@@ -106,6 +152,21 @@ void SaveDialog::rbtnFormat_toggled(bool b)
 			mBrowseSettings.filter = tr("XML Files (*.xml)");
 			mBrowseSettings.index = mBrowseSettings.index.sprintf("%05d",ui.edtFirstImageIndex->text().toInt());
 		}
+		else if(ui.rbtnNumpy->isChecked())
+		{
+			mBrowseSettings.title = tr("Save As NumPy archive");
+			mBrowseSettings.ext = tr(".npz");
+			mBrowseSettings.filter = tr("NumPy Files (*.npz)");
+			mBrowseSettings.index = "";
+		}
+		else if(ui.rbtnInstanceMasks->isChecked() || ui.rbtnSemanticMasks->isChecked())
+		{
+			//more than 255 ids are written as 16 bit pgm instead
+			mBrowseSettings.title = tr("Save As Label Masks");
+			mBrowseSettings.ext = tr(".png");
+			mBrowseSettings.filter = tr("Image Files (*.png)");
+			mBrowseSettings.index = mBrowseSettings.index.sprintf("%05d",ui.edtFirstImageIndex->text().toInt());
+		}
 
 		ui.edtSavePath->setText(mPath + ui.edtFileNamePrefix->text() + mBrowseSettings.index + mBrowseSettings.ext);
 	}
@@ -133,6 +194,12 @@ void SaveDialog::on_edtFileNamePrefix_textChanged(const QString &text)
 	//rbtnFormat_toggled(true);
 }
 
+void SaveDialog::on_cmbImageFormat_currentIndexChanged(int index)
+{
+	Q_UNUSED(index);
+	rbtnFormat_toggled(true);
+}
+
 QString SaveDialog::fixFileNameForMatlab(QString str)
 {
 	QString tmp = str.replace("-", "_");
@@ -36,10 +36,15 @@ public:
 	SaveDialog(QWidget *parent = 0, Qt::WindowFlags flags = 0);
 	virtual ~SaveDialog(void);
 
+	//fourcc of the selected avi codec, empty for the default one
+	QString codec() const;
+	void setCodec(const QString &fourcc);
+
 protected slots:
 	virtual void rbtnFormat_toggled(bool b);
 	virtual void on_btnBrowse_clicked();
 	virtual void on_edtFileNamePrefix_textChanged(const QString &text);
+	virtual void on_cmbImageFormat_currentIndexChanged(int index);
 
 public:
 	QString mPath;
@@ -33,11 +33,26 @@
 #include <QDomDocument>
 #include <QBitmap>
 #include <QProgressBar>
+#include <QProgressDialog>
+#include <QStyle>
+#include <QInputDialog>
+#include <QPushButton>
 #include "SimpleLabel.h"
 #include "Constants.h"
 #include "Monitor.h"
 #include "About.h"
 #include "SaveDialog.h"
+#include "BoxTrack.h"
+#include "FrameReader.h"
+#include "MotionTracker.h"
+#include "DriftAnalyzer.h"
+#include "TrackSimplifier.h"
+#include "Track.h"
+#include "Exporter.h"
+#include "LabelXmlReader.h"
+#include "LabelMeImporter.h"
+#include "ProjectFile.h"
+#include "EditJournal.h"
 
 const QPoint CommonFunctions::NULL_POINT = QPoint(-1,-1);
 const ViaPoint CommonFunctions::NULL_RECT = ViaPoint(-1, 0.0, QRect(0,0,0,0));
@@ -70,8 +85,22 @@ SimpleLabel::SimpleLabel(QWidget *parent, Qt::WFlags flags)
 	mDisplayImage = new QImage(W_DISPLAYIMAGE, H_DISPLAYIMAGE, QImage::Format_ARGB32);
 //	mDisplayImage= NULL;
 	mMonitor= new Monitor();
+	mMotionTracker = new MotionTracker(this);
+	mDriftAnalyzer = new DriftAnalyzer(this);
+	mExporter = new Exporter(this);
+	mLabelMeImporter = new LabelMeImporter(this);
+	mImportProgress = NULL;
+	mJournal = new EditJournal(this);
 	
 	connect(mMonitor, SIGNAL(imageChanged()), this, SLOT(showImage()), Qt::QueuedConnection);
+	connect(mMotionTracker, SIGNAL(segmentTracked(int, QList<ViaPoint>)), this, SLOT(onSegmentTracked(int, QList<ViaPoint>)));
+	connect(mMotionTracker, SIGNAL(pendingJobsChanged(int)), this, SLOT(onTrackingJobsChanged(int)));
+	connect(mDriftAnalyzer, SIGNAL(suggestionsChanged(int)), this, SLOT(onSuggestionsChanged(int)));
+	connect(mExporter, SIGNAL(progress(int, int, double)), this, SLOT(onExportProgress(int, int, double)));
+	connect(mExporter, SIGNAL(finished(bool, QString)), this, SLOT(onExportFinished(bool, QString)));
+	connect(mLabelMeImporter, SIGNAL(progress(int, int)), this, SLOT(onImportProgress(int, int)));
+	connect(mLabelMeImporter, SIGNAL(finished(bool, QString)), this, SLOT(onImportFinished(bool, QString)));
+	connect(mJournal, SIGNAL(failed(QString)), this, SLOT(onJournalFailed(QString)));
 	connect(mSaveDgl, SIGNAL(accepted()), this, SLOT(on_SaveDialog_accept()));
 
 	
@@ -83,6 +112,7 @@ SimpleLabel::SimpleLabel(QWidget *parent, Qt::WFlags flags)
 	mResizeVertex = -1;
 	mIntrMethod = LinearIntr;
 	mNewPolygon = false;
+	mSimplifyTolerance = SIMPLIFY_TOLERANCE;
 
 	ui.actionLoad_XML->setDisabled(true);
 	ui.actionLoad_LabelMe_XML->setDisabled(true);
@@ -90,10 +120,20 @@ SimpleLabel::SimpleLabel(QWidget *parent, Qt::WFlags flags)
 	ui.hSliderFrames->setDisabled(true);
 	ui.actionNewPolygon->setDisabled(true);
 	ui.actionSave_Dialog->setEnabled(true);
+	updateUndoActions();
 
 	mSaveDgl->ui.edtFirstImageIndex->setText("-1");
 
 	statusBar()->addPermanentWidget(&mStatus_Mode);
+
+	//progress of the background export
+	mExportProgress = new QProgressBar(this);
+	mExportProgress->setVisible(false);
+	statusBar()->addPermanentWidget(mExportProgress);
+	mExportCancel = new QPushButton("Cancel Export", this);
+	mExportCancel->setVisible(false);
+	statusBar()->addPermanentWidget(mExportCancel);
+	connect(mExportCancel, SIGNAL(clicked()), mExporter, SLOT(cancel()));
 	on_cmbBoxLabelShape_currentIndexChanged(Rect);
 
 	//setting up the popup menu
@@ -117,6 +157,8 @@ SimpleLabel::SimpleLabel(QWidget *parent, Qt::WFlags flags)
 
 SimpleLabel::~SimpleLabel()
 {
+	//the journal keeps the labels of the session
+	mJournal->close();
 	releaseCapture();
 	resetLabels();
 	mMonitor->stop();
@@ -129,6 +171,12 @@ SimpleLabel::~SimpleLabel()
 	delete mCrossHairCursor;
 }
 
+void SimpleLabel::setVideoExportDefaults(const QString &codec, int segments)
+{
+	mSaveDgl->setCodec(codec);
+	mSaveDgl->ui.spinSegments->setValue(segments);
+}
+
 void SimpleLabel::resetFilenames()
 {
 	mFileName = "";
@@ -136,8 +184,12 @@ void SimpleLabel::resetFilenames()
 	mPath = "";
 	mExtention = "";
 	mFirstFrameNumber = -1;
+	mProjectFile = "";
+	mExportedLabels.clear();
 }
 
+//Clears the labels without publishing them. The callers load the new labels
+//and then reset the history, which publishes and journals them once.
 void SimpleLabel::resetLabels()
 {
 	mDrawPoint = CommonFunctions::NULL_POINT;
@@ -155,6 +207,9 @@ void SimpleLabel::resetLabels()
 		mLabels[i].viaPointsPoly.clear();
 	}
 	mLabels.clear();
+	mSpanIndex.clear();
+	mMotionTracker->cancelAll();
+	mDriftAnalyzer->cancelAll();
 
 	ui.listLabels->clear();
 	mSaveDgl->ui.edtFirstImageIndex->setText("-1");
@@ -182,8 +237,10 @@ void SimpleLabel::on_actionOpen_triggered()
 	QString s = QFileDialog::getOpenFileName(this, tr("Open Video"), ".", tr("Image Files (*.png *.tif *.tiff *.jpg);;Video Files (*.avi)"));
 	if(!s.isEmpty())
 	{
+		mJournal->close();
 		resetFilenames();
 		resetLabels();
+		resetHistory();
 		releaseCapture();
 
 		//splitting the full path into parts
@@ -224,11 +281,15 @@ void SimpleLabel::on_actionOpen_triggered()
 
 		if(frames > 0)
 		{
+			mFrameReader = QSharedPointer<FrameReader>(new FrameReader(s));
+			mMotionTracker->setFrameReader(mFrameReader);
+			mDriftAnalyzer->setFrameReader(mFrameReader);
 			ui.hSliderFrames->setEnabled(true);
 			ui.hSliderFrames->setRange(firstframe, firstframe + frames - 1);
 			ui.actionLoad_XML->setEnabled(true);
 			ui.actionLoad_LabelMe_XML->setEnabled(true);
 			ui.actionExport->setEnabled(true);
+			openJournal();
 		}
 		else
 			ui.hSliderFrames->setDisabled(true);
@@ -297,20 +358,31 @@ void SimpleLabel::paintEvent (QPaintEvent*)
 		int row = ui.listLabels->currentRow();
 		int n, k;
 		QRect rc;
+		QList<int> active = mSpanIndex.labelsAt(fr);
 
-		for(n = 0; n < mLabels.count(); n++)
+		for(int a = 0; a < active.count(); a++)
 		{
+			n = active[a];
 			if(row == n)
 				br.setColor(QColor(0,255,0, 100));
 			else
 				br.setColor(QColor(255,255,255, 100));
 
-			if(mLabels[n].boxes.count() > 0 && 
-				fr >= mLabels[n].boxes.first().frame &&
-				fr <= mLabels[n].boxes.last().frame)
+			//painting only reads, at() keeps the labels shared with the undo history
+			const Label &lb = mLabels.at(n);
+			if(lb.shape == Polyg)
+			{
+				const ViaPointPolygon *p = lb.findPolygonByFrame(fr);
+				if(p != NULL)
+				{
+					pt.setBrush(br);
+					pt.setPen( Qt::black );
+					pt.drawPolygon(imageToScreen(p->pl.toPolygon()));
+				}
+			}
+			else if((k = lb.boxIndex(fr)) >= 0)
 			{
-				k = fr - mLabels[n].boxes.first().frame;
-				rc = imageToScreen(mLabels[n].boxes[k].rc);
+				rc = imageToScreen(lb.boxes.at(k).rc);
 
 				pt.fillRect(rc, br);
 				pt.setPen( Qt::black );
@@ -332,6 +404,8 @@ void SimpleLabel::paintEvent (QPaintEvent*)
 			break;
 		}
 	}
+
+	drawSuggestions(&pt);
 }
 
 void SimpleLabel::drawModeRect(QPainter *pt, int frame)
@@ -342,21 +416,14 @@ void SimpleLabel::drawModeRect(QPainter *pt, int frame)
 		int row = ui.listLabels->currentRow();
 		if(row >= 0)
 		{
-			if(mLabels[row].viaPoints.count() > 0 &&
-				(frame < mLabels[row].viaPoints.first().frame || frame > mLabels[row].viaPoints.last().frame))
+			Track<RectShape> track(mLabels[row]);
+			if(track.isOutside(frame))
 			{
 				br.setColor(QColor(255,0,0, 100));
 			}
-			else
+			else if(track.isViaPoint(frame))
 			{
-				for(int i = 0; i < mLabels[row].viaPoints.count(); i++)
-				{
-					if(mLabels[row].viaPoints[i].frame == frame)
-					{
-						br.setColor(QColor(0,255,0, 100));
-						break;
-					}
-				}
+				br.setColor(QColor(0,255,0, 100));
 			}
 		}
 
@@ -391,6 +458,33 @@ void SimpleLabel::drawModeRect(QPainter *pt, int frame)
 //	return tmp;
 //}
 
+//marks the suggested via points of the current label along the frame slider
+void SimpleLabel::drawSuggestions(QPainter *pt)
+{
+	int row = ui.listLabels->currentRow();
+	if(row < 0 || !ui.hSliderFrames->isEnabled())
+		return;
+
+	QList<int> frames = mDriftAnalyzer->suggestions(row);
+	if(frames.isEmpty())
+		return;
+
+	QSlider *sl = ui.hSliderFrames;
+	QPoint org = sl->mapTo(this, QPoint(0, 0));
+	//the handle centre never gets closer to the ends than half its length
+	int margin = sl->style()->pixelMetric(QStyle::PM_SliderLength, 0, sl)/2;
+	int span = sl->width() - 2*margin;
+
+	pt->setPen(Qt::NoPen);
+	pt->setBrush(QColor(255, 128, 0));
+	for(int i = 0; i < frames.count(); i++)
+	{
+		int x = org.x() + margin + QStyle::sliderPositionFromValue(sl->minimum(), sl->maximum(), frames[i], span);
+		QPoint tri[3] = {QPoint(x - SUGGESTION_MARK_SIZE, org.y()), QPoint(x + SUGGESTION_MARK_SIZE, org.y()), QPoint(x, org.y() + SUGGESTION_MARK_SIZE)};
+		pt->drawPolygon(tri, 3);
+	}
+}
+
 void SimpleLabel::drawModePoly(QPainter *pt, int frame)
 {
 	int row = ui.listLabels->currentRow();
@@ -408,21 +502,14 @@ void SimpleLabel::drawModePoly(QPainter *pt, int frame)
 		QBrush br(QColor(255,255,255, 100));
 		if(row >= 0)
 		{
-			if(mLabels[row].viaPointsPoly.count() > 0 &&
-				(frame < mLabels[row].viaPointsPoly.first().frame || frame > mLabels[row].viaPointsPoly.last().frame))
+			Track<PolygonShape> track(mLabels[row]);
+			if(track.isOutside(frame))
 			{
 				br.setColor(QColor(255,0,0, 100));
 			}
-			else
+			else if(track.isViaPoint(frame))
 			{
-				for(int i = 0; i < mLabels[row].viaPointsPoly.count(); i++)
-				{
-					if(mLabels[row].viaPointsPoly[i].frame == frame)
-					{
-						br.setColor(QColor(0,255,0, 100));
-						break;
-					}
-				}
+				br.setColor(QColor(0,255,0, 100));
 			}
 		}
 
@@ -471,20 +558,9 @@ void SimpleLabel::setDrawRectToFrame(int v)
 	int row = ui.listLabels->currentRow();
 	if(row >= 0)
 	{
-		if(mLabels[row].boxes.count() > 0)
-		{
-			int fr = v - mLabels[row].viaPoints[0].frame;
-			if(fr >= 0 && mLabels[row].boxes.count() > fr)
-			{
-				if(mLabels[row].boxes[fr].frame != v)
-				{
-					QString s = QString("Frames are out of sync: box = ") + mLabels[row].boxes[fr].frame + "; v = " + v;
-					qDebug() << s;
-				}
-				//mDrawRect.rc = mLabels[row].boxes[fr].rc;
-				mDrawRect = mLabels[row].boxes[fr];
-			}
-		}
+		const ViaPoint *p = Track<RectShape>(mLabels[row]).at(v);
+		if(p != NULL)
+			mDrawRect = *p;
 	}
 }
 
@@ -493,19 +569,9 @@ void SimpleLabel::setDrawPolygonToFrame(int v)
 	int row = ui.listLabels->currentRow();
 	if(row >= 0)
 	{
-		if(mLabels[row].polygons.count() > 0)
-		{
-			int fr = v - mLabels[row].viaPointsPoly[0].frame;
-			if(fr >= 0 && mLabels[row].polygons.count() > fr)
-			{
-				if(mLabels[row].polygons[fr].frame != v)
-				{
-					QString s = QString("Frames are out of sync: polygon = ") + mLabels[row].polygons[fr].frame + "; v = " + v;
-					qDebug() << s;
-				}
-				mDrawPolygon = mLabels[row].polygons[fr].pl;
-			}
-		}
+		const ViaPointPolygon *p = Track<PolygonShape>(mLabels[row]).at(v);
+		if(p != NULL)
+			mDrawPolygon = p->pl.toPolygon();
 	}
 }
 
@@ -529,7 +595,7 @@ void SimpleLabel::mousePressEvent( QMouseEvent * e )
 				int v2 = (vertex + 1)%mLabels[row].viaPointsPoly[0].pl.count();
 
 				//add new vertex to each via point and recalculate polygons
-				QList<ViaPointPolygon>::iterator i;
+				QVector<ViaPointPolygon>::iterator i;
 				for(i = mLabels[row].viaPointsPoly.begin(); i != mLabels[row].viaPointsPoly.end(); ++i)
 				{
 					p1 = i->pl.point(vertex);
@@ -539,19 +605,21 @@ void SimpleLabel::mousePressEvent( QMouseEvent * e )
 					i->pl.insert(v2, p);
 				}
 				rebuildLabelPolygons();
-				mDrawPolygon = mLabels[row].findPolygonByFrame(mMonitor->getCurrentFrameNumber())->pl;
+				commitEdit("Add Vertex");
+				mDrawPolygon = mLabels.at(row).findPolygonByFrame(mMonitor->getCurrentFrameNumber())->pl.toPolygon();
 				update();
 			}
 			else if(tmp->objectName() == "RemoveVertex")
 			{
 				//add new vertex to each via point and recalculate polygons
-				QList<ViaPointPolygon>::iterator i;
+				QVector<ViaPointPolygon>::iterator i;
 				for(i = mLabels[row].viaPointsPoly.begin(); i != mLabels[row].viaPointsPoly.end(); ++i)
 				{
 					i->pl.remove(vertex);
 				}
 				rebuildLabelPolygons();
-				mDrawPolygon = mLabels[row].findPolygonByFrame(mMonitor->getCurrentFrameNumber())->pl;
+				commitEdit("Remove Vertex");
+				mDrawPolygon = mLabels.at(row).findPolygonByFrame(mMonitor->getCurrentFrameNumber())->pl.toPolygon();
 				update();
 			}
 		}
@@ -641,6 +709,7 @@ void SimpleLabel::mouseReleaseEvent( QMouseEvent* )
 			{
 				addViaPointPoly(ui.hSliderFrames->value(), mDrawPolygon);
 			}
+			commitEdit("Move Via Point");
 			mSomethingChanged = false;
 			update();
 		}
@@ -726,7 +795,7 @@ void SimpleLabel::mouseMoveEvent( QMouseEvent * e )
 				double ang = CommonFunctions::findAngleBetweenVectors2(v1, v2);
 				if(row >= 0)
 				{
-					mDrawRect.angle = mLabels[row].findBoxByFrame(mDrawRect.frame)->angle + ang;
+					mDrawRect.angle = mLabels.at(row).findBoxByFrame(mDrawRect.frame)->angle + ang;
 				}
 			}
 			//draw new rectangle
@@ -775,33 +844,6 @@ QPoint SimpleLabel::imageToScreen(QPoint im)
 	return QPoint(im.x() + WINDOW_OFFSET_X, im.y() + WINDOW_OFFSET_Y);
 }
 	
-QPoint SimpleLabel::imageToImage(int srcW, int srcH, QPoint srcP, int destW, int destH)
-{
-	QPoint res;
-	double kX, kY;
-
-	kX = (double)destW/(double)srcW;
-	kY = (double)destH/(double)srcH;
-
-	res.setX(ROUND(srcP.x() * kX));
-	res.setY(ROUND(srcP.y() * kY));
-
-	return res;
-}
-
-QRect SimpleLabel::imageToImage(int srcW, int srcH, QRect srcP, int destW, int destH)
-{
-	QRect res;
-	QPoint tl = imageToImage(srcW, srcH, srcP.topLeft(), destW, destH);
-	QPoint br = imageToImage(srcW, srcH, srcP.bottomRight(), destW, destH);
-
-	res.setTopLeft(tl);
-	res.setBottomRight(br);
-
-	return res;
-}
-
-
 QRect SimpleLabel::screenToImage(QRect scr)
 {
 	return scr.translated(-WINDOW_OFFSET_X, -WINDOW_OFFSET_Y);
@@ -823,29 +865,19 @@ QPolygon SimpleLabel::imageToScreen(QPolygon im)
 	return im.translated(WINDOW_OFFSET_X, WINDOW_OFFSET_Y);
 }
 
-QPolygon SimpleLabel::imageToImage(int srcW, int srcH, QPolygon srcP, int destW, int destH)
-{
-	QPolygon res;
-	QPoint p;
-	for(int i = 0; i < srcP.count(); i++)
-	{
-		p = imageToImage(srcW, srcH, srcP[i], destW, destH);
-		res << p;
-	}
-
-	return res;
-}
-
 void SimpleLabel::on_btnAddLabel_pressed()
 {
 	Label lb;
 	lb.number = mLabels.count();
 	lb.name = "New Label";
 	lb.shape = Polyg;
+	lb.intr = mIntrMethod;
 	lb.desc = "";
 	mLabels.append(lb);
+	mSpanIndex.update(mLabels.count() - 1, lb);
 
 	updateListView();
+	commitEdit("Add Label");
 }
 
 void SimpleLabel::on_btnDeleteLabel_pressed()
@@ -855,9 +887,14 @@ void SimpleLabel::on_btnDeleteLabel_pressed()
 	if(row >= 0 && row < mLabels.count())
 	{
 		mLabels.removeAt(row);
+		mSpanIndex.removeRow(row);
+		//rows after the removed one shift, so tracking results can't be matched any more
+		mMotionTracker->cancelAll();
+		mDriftAnalyzer->cancelAll();
 	}
 
 	updateListView();
+	commitEdit("Delete Label");
 }
 
 void SimpleLabel::updateListView()
@@ -879,6 +916,7 @@ void SimpleLabel::on_listLabels_itemChanged(QListWidgetItem* item)
 	int row = ui.listLabels->row(item);
 
 	mLabels[row].name = item->text();
+	commitEdit("Rename Label");
 }
 
 void SimpleLabel::on_listLabels_currentItemChanged (QListWidgetItem * current, QListWidgetItem * previous)
@@ -888,7 +926,6 @@ void SimpleLabel::on_listLabels_currentItemChanged (QListWidgetItem * current, Q
 	if(row >= 0 && row < mLabels.count())
 	{
 		mLabels[row].desc = ui.textEditDescription->toPlainText();
-		mLabels[row].shape = mShapeMode;
 	}
 
 	row = ui.listLabels->row(current);
@@ -897,22 +934,27 @@ void SimpleLabel::on_listLabels_currentItemChanged (QListWidgetItem * current, Q
 		mShapeMode = mLabels[row].shape;
 		ui.textEditDescription->setText(mLabels[row].desc);
 		ui.cmbBoxLabelShape->setCurrentIndex(mShapeMode);
+		ui.cmbBoxInterpolation->blockSignals(true);
+		ui.cmbBoxInterpolation->setCurrentIndex(mLabels[row].intr);
+		ui.cmbBoxInterpolation->blockSignals(false);
+		//labels loaded from a file haven't been analyzed yet
+		analyzeDrift(row);
 		switch(mShapeMode)
 		{
 		case Rect:
-			if(mLabels[row].boxes.count() > 0)
+			if(mLabels.at(row).boxes.count() > 0)
 			{
-				ViaPoint *p = mLabels[row].findBoxByFrame(mMonitor->getCurrentFrameNumber());
+				const ViaPoint *p = mLabels.at(row).findBoxByFrame(mMonitor->getCurrentFrameNumber());
 				if(p != NULL)
 					mDrawRect = *p;
 			}
 			break;
 		case Polyg:
-			 if(mLabels[row].polygons.count() > 0)
+			 if(mLabels.at(row).polygons.count() > 0)
 			 {
-				ViaPointPolygon *p = mLabels[row].findPolygonByFrame(mMonitor->getCurrentFrameNumber());
+				const ViaPointPolygon *p = mLabels.at(row).findPolygonByFrame(mMonitor->getCurrentFrameNumber());
 				if(p != NULL)
-					mDrawPolygon = p->pl;
+					mDrawPolygon = p->pl.toPolygon();
 			 }
 			break;
 		default:
@@ -928,662 +970,403 @@ void SimpleLabel::on_textEditDescription_textChanged()
 	if(row >= 0)
 	{
 		mLabels[row].desc = ui.textEditDescription->toPlainText();
+		//typing is not worth an undo step of its own, it goes with the last edit
+		amendEdit();
 	}
 }
 
 //add new polygon via point to the structure
-void SimpleLabel::addViaPointPoly(int frame, QPolygon pl, bool addRect)
+void SimpleLabel::addViaPointPoly(int frame, QPolygon pl)
 {
-	bool ok = true;
 	int row = ui.listLabels->currentRow();
 	if(row < 0)
 	{
 		QMessageBox::information(NULL,"Label", "Select a label.");
-		ok = false;
+		return;
 	}
 
-	if(ok)
-	{	
-		QList<ViaPointPolygon>::iterator i;
-		//find the place where to put new polygon
-		for(i = mLabels[row].viaPointsPoly.begin(); i != mLabels[row].viaPointsPoly.end(); i++)
-		{
-			if(i->frame > frame || i->frame == frame)
-			{
-				break;
-			}
-		}
-
-		//if the frame is already a via point replace it
-		if(i != mLabels[row].viaPointsPoly.end() && i->frame == frame)
-		{
-			i->frame = frame;
-			i->pl = pl;
-		}
-		else
-		{
-			//insert new via point
-			ViaPointPolygon v;
-			v.frame = frame;
-			v.pl = pl;
-			mLabels[row].viaPointsPoly.insert(i, v);
-		}
-
-		rebuildLabelPolygons();
-
-		//last parameter is false bacause we don't want to add a polygon
-		//(we just added it)
-		if(addRect)
-			addViaPoint(frame, pl.boundingRect());
-	}
+	ViaPointPolygon v;
+	v.frame = frame;
+	v.pl = pl;
+	Track<PolygonShape>(mLabels[row]).addViaPoint(v);
+	rebuildLabelPolygons();
 }
 
 //add new point in the right place in the label structure
-void SimpleLabel::addViaPoint(int frame, QRect rc)
+void SimpleLabel::addViaPoint(int frame, ViaPoint v)
 {
-	bool ok = true;
 	int row = ui.listLabels->currentRow();
 	if(row < 0)
 	{
 		QMessageBox::information(NULL,"Label", "Select a label.");
-		ok = false;
+		return;
 	}
 
-	if(ok)
-	{	
-		QList<ViaPoint>::iterator i;
-		//find the place where to put new point
-		for(i = mLabels[row].viaPoints.begin(); i != mLabels[row].viaPoints.end(); i++)
-		{
-			if(i->frame > frame || i->frame == frame)
-			{
-				break;
-			}
-		}
+	v.frame = frame;
+	Track<RectShape>(mLabels[row]).addViaPoint(v);
+	rebuildLabelBoxes();
+}
 
-		ViaPoint v;
-		v.frame = frame;
-		v.rc = rc;
-		//if the frame is already a via point replace it
-		if(i != mLabels[row].viaPoints.end() && i->frame == frame)
-		{
-			i->frame = v.frame;
-			i->rc = v.rc;
-		}
-		else
-		{
-			//insert new via point
-			mLabels[row].viaPoints.insert(i, v);
-		}
-		rebuildLabelBoxes();
-	}
+//recalculate the label polygons
+void SimpleLabel::rebuildLabelPolygons()
+{
+	rebuildLabelPolygons(ui.listLabels->currentRow());
 }
 
-//add new point in the right place in the label structure
-void SimpleLabel::addViaPoint(int frame, ViaPoint v)
+void SimpleLabel::rebuildLabelPolygons(int row)
 {
-	bool ok = true;
-	int row = ui.listLabels->currentRow();
-	if(row < 0)
+	if(row >= 0)
 	{
-		QMessageBox::information(NULL,"Label", "Select a label.");
-		ok = false;
+		Track<PolygonShape>(mLabels[row]).rebuild();
+		mSpanIndex.update(row, mLabels[row]);
 	}
+}
 
-	if(ok)
-	{	
-		QList<ViaPoint>::iterator i;
-		//find the place where to put new point
-		for(i = mLabels[row].viaPoints.begin(); i != mLabels[row].viaPoints.end(); i++)
-		{
-			if(i->frame > frame || i->frame == frame)
-			{
-				break;
-			}
-		}
+//recalculate the label boxes
+void SimpleLabel::rebuildLabelBoxes()
+{
+	rebuildLabelBoxes(ui.listLabels->currentRow());
+}
+
+void SimpleLabel::rebuildLabelBoxes(int row)
+{
+	if(row >= 0)
+	{
+		//motion labels start from the linear track, tracked segments are filled in below
+		Track<RectShape>(mLabels[row]).rebuild();
 
-		//if the frame is already a via point replace it
-		if(i != mLabels[row].viaPoints.end() && i->frame == frame)
+		if(mLabels[row].intr == Motion)
 		{
-			*i = v;
-			i->frame = frame;
+			mMotionTracker->setDisplaySize(mDisplayImage->size());
+			mMotionTracker->track(row, mLabels[row].viaPoints, mLabels[row].boxes);
 		}
 		else
 		{
-			//insert new via point
-			ViaPoint nv = v;
-			nv.frame = frame;
-			mLabels[row].viaPoints.insert(i, nv);
-		}
-		rebuildLabelBoxes();
-
-		//add polygon viaPoint too
-		int numVerticies = 4;
-		if( mLabels[row].viaPointsPoly.count() > 0)
-		{
-			numVerticies = mLabels[row].viaPointsPoly[0].pl.count();
+			mMotionTracker->cancel(row);
 		}
+		mSpanIndex.update(row, mLabels[row]);
+		analyzeDrift(row);
+	}
+}
 
-		QPolygon newPolyg;
-		newPolyg << v.rc.topLeft();
-		newPolyg << v.rc.topRight();
-		newPolyg << v.rc.bottomRight();
-
-		for(int ver = 3; ver < numVerticies; ver++)
-		{
-			newPolyg << v.rc.bottomLeft();
-		}
+//collapses dense via points of the label, returns the number of removed via points
+int SimpleLabel::simplifyLabel(int row, double tolerance)
+{
+	Label &lb = mLabels[row];
+	int n = lb.viaPoints.count() + lb.viaPointsPoly.count();
 
-		//we don't want to add new rectangle 
-		//we just added it
-		addViaPointPoly(v.frame, newPolyg, false);
-		
+	//the error is measured against linear interpolation, motion tracked boxes
+	//between the remaining via points would move beyond the tolerance
+	if(lb.viaPoints.count() > 0 && lb.intr == LinearIntr)
+	{
+		lb.viaPoints = TrackSimplifier::simplify(lb.viaPoints, tolerance);
+		rebuildLabelBoxes(row);
+	}
+	if(lb.viaPointsPoly.count() > 0)
+	{
+		lb.viaPointsPoly = TrackSimplifier::simplify(lb.viaPointsPoly, tolerance);
+		rebuildLabelPolygons(row);
 	}
+
+	return n - lb.viaPoints.count() - lb.viaPointsPoly.count();
 }
 
-//recalculate the label polygons
-void SimpleLabel::rebuildLabelPolygons()
+void SimpleLabel::on_actionSimplifyTrack_triggered()
 {
 	int row = ui.listLabels->currentRow();
-	double df = 0.0;
-	QPointF dp;
-	ViaPointPolygon b1, b2;
-	ViaPointPolygon newPolyg;
-	QPoint np;
-	int t;
-
-	if(row >= 0)
-	{
-		QList<ViaPointPolygon>::iterator i;
-		mLabels[row].polygons.clear();
+	if(row < 0 || row >= mLabels.count())
+		return;
 
+	bool ok = false;
+	double tol = QInputDialog::getDouble(this, "Simplify Track", "Tolerance (pixels):", mSimplifyTolerance, 0.0, 100.0, 1, &ok);
+	if(!ok)
+		return;
 
-		if(mLabels[row].viaPointsPoly.count() == 1)
-		{
-			mLabels[row].polygons << mLabels[row].viaPointsPoly[0];
-		}
+	mSimplifyTolerance = tol;
+	int removed = simplifyLabel(row, tol);
+	commitEdit("Simplify Track");
+	statusBar()->showMessage(QString("Removed %1 via point(s)").arg(removed), 3000);
 
-		for(i = mLabels[row].viaPointsPoly.begin(); i != mLabels[row].viaPointsPoly.end() - 1; ++i)
-		{
-			b1 = *i;
-			b2 = *(i + 1);
-			if(mIntrMethod == LinearIntr)
-			{
-				df = b2.frame - b1.frame;
-			}
+	int fr = mMonitor->getCurrentFrameNumber();
+	if(mShapeMode == Rect)
+		setDrawRectToFrame(fr);
+	else if(mShapeMode == Polyg)
+		setDrawPolygonToFrame(fr);
+	update();
+}
 
-			for(int k = b1.frame; k <= b2.frame; k++)
-			{
-				t = k - b1.frame;
-				newPolyg.frame = k;
-				newPolyg.pl = QPolygon();
-				
-				for(int j = 0; j < b1.pl.count(); j++)
-				{
-					if(mIntrMethod == LinearIntr)
-					{
-						QPointF p1 = b2.pl.point(j) - b1.pl.point(j);
-						dp = p1/df;
-						np = linearInterpolation(b1.pl.point(j), dp, t);
-					}
-					newPolyg.pl << np;
-				}
+//hands the current labels to the other threads and to the journal
+void SimpleLabel::publishLabels()
+{
+	mLabelStore.publish(mLabels);
+	mJournal->record(mLabels);
+}
 
-				//the first frame of the new segment is the same as the last frame of the 
-				//previous segment, so we rewrite it
-				if(k == b1.frame && mLabels[row].polygons.count() > 0)
-				{
-					mLabels[row].polygons[mLabels[row].polygons.count() - 1] = newPolyg;
-				}
-				else
-				{
-					mLabels[row].polygons << newPolyg;
-				}
-			}
-		}
+//records the current labels as an undo step and publishes them
+void SimpleLabel::commitEdit(const QString &text)
+{
+	if(mUndoStack.commit(text, mLabels))
+	{
+		publishLabels();
+		updateUndoActions();
 	}
 }
 
+//folds the current labels into the last undo step
+void SimpleLabel::amendEdit()
+{
+	mUndoStack.amend(mLabels);
+	publishLabels();
+}
 
-//recalculate the label boxes
-void SimpleLabel::rebuildLabelBoxes()
+//the current labels become the start of a new history
+void SimpleLabel::resetHistory()
+{
+	mUndoStack.reset(mLabels);
+	publishLabels();
+	updateUndoActions();
+}
+
+//replaces the labels by a step of the undo history, only the changed rows are updated
+void SimpleLabel::restoreLabels(const QList<Label> &labels)
 {
 	int row = ui.listLabels->currentRow();
+	bool sameRows = labels.count() == mLabels.count();
+	QList<int> rows = UndoStack::changedRows(mLabels, labels);
+	mLabels = labels;
+	publishLabels();
 
-	if(row >= 0)
+	if(sameRows)
 	{
-		QList<ViaPoint>::iterator i;
-		mLabels[row].boxes.clear();
-		ViaPoint b1, b2;
-		ViaPoint newbox;
-		double dx = 0, dy = 0;
-		double dw = 0, dh = 0;
-		double df;
-                double da = 0;
-		int t;
-
-		//special case
-		if(mLabels[row].viaPoints.count() == 1)
+		ui.listLabels->blockSignals(true);
+		for(int i = 0; i < rows.count(); i++)
 		{
-			mLabels[row].boxes << mLabels[row].viaPoints[0];
+			int r = rows[i];
+			mSpanIndex.update(r, mLabels[r]);
+			ui.listLabels->item(r)->setText(mLabels[r].name);
+			if(mLabels[r].shape == Rect)
+				analyzeDrift(r);
+			else
+				mDriftAnalyzer->cancel(r);
 		}
+		ui.listLabels->blockSignals(false);
 
-		for(i = mLabels[row].viaPoints.begin(); i != mLabels[row].viaPoints.end() - 1; ++i)
-		{
-			b1 = *i;
-			b2 = *(i+1);
-			
-			if(mIntrMethod == LinearIntr)
-			{
-				df = b2.frame - b1.frame;
-				dx = (b2.rc.left() - b1.rc.left())/df;
-				dy = (b2.rc.top() - b1.rc.top())/df;
-				dw = (b2.rc.width() - b1.rc.width())/df;
-				dh = (b2.rc.height() - b1.rc.height())/df;
-				da = (b2.angle - b1.angle)/df;
-			}
-			for(int k = b1.frame; k <= b2.frame; k++)
-			{
-				t = k - b1.frame;
-				if(mIntrMethod == LinearIntr)
-				{
-					newbox.rc = linearInterpolation(b1.rc, dx, dy, dw, dh, t);
-					newbox.frame = k;
-					newbox.angle = b1.angle + da*t;
-				}
-				else if(mIntrMethod == Motion)
-				{
-					//DO THE MOTION ALGORITHM HERE
-				}
-
-				//the first frame of the new segment is the same as the last frame of the 
-				//previous segment, so we rewrite it
-				if(k == b1.frame && mLabels[row].boxes.count() > 0)
-				{
-					mLabels[row].boxes[mLabels[row].boxes.count() - 1] = newbox;
-				}
-				else
-				{
-					mLabels[row].boxes.append(newbox);
-				}
-			}
-		}
+		//refresh the shape, description and drawn shape of the current label
+		if(row >= 0)
+			on_listLabels_currentItemChanged(ui.listLabels->item(row), NULL);
 	}
+	else
+	{
+		mMotionTracker->cancelAll();
+		mDriftAnalyzer->cancelAll();
+		mSpanIndex.rebuild(mLabels);
+		ui.listLabels->blockSignals(true);
+		updateListView();
+		ui.listLabels->blockSignals(false);
+		//selecting the row again refreshes the current label
+		ui.listLabels->setCurrentRow(qMin(row, mLabels.count() - 1));
+	}
+
+	updateUndoActions();
+	update();
 }
 
-QPoint SimpleLabel::linearInterpolation(QPoint src, QPointF dt, int t)
+void SimpleLabel::updateUndoActions()
 {
-	return src + (t*dt).toPoint();
+	ui.actionUndo->setEnabled(mUndoStack.canUndo());
+	ui.actionUndo->setText(mUndoStack.canUndo() ? "&Undo " + mUndoStack.undoText() : QString("&Undo"));
+	ui.actionRedo->setEnabled(mUndoStack.canRedo());
+	ui.actionRedo->setText(mUndoStack.canRedo() ? "&Redo " + mUndoStack.redoText() : QString("&Redo"));
 }
 
-QRect SimpleLabel::linearInterpolation(QRect initPoint, double dx, double dy, double dw, double dh, int t)
+void SimpleLabel::on_actionUndo_triggered()
 {
-	QRect res;
-	res.setLeft(ROUND(initPoint.left() + t*dx));
-	res.setTop(ROUND(initPoint.top() + t*dy));
-	res.setWidth(ROUND(initPoint.width() + t*dw));
-	res.setHeight(ROUND(initPoint.height() + t*dh));
+	if(mUndoStack.canUndo() && !mNewPolygon)
+		restoreLabels(mUndoStack.undo());
+}
 
-	return res;
+void SimpleLabel::on_actionRedo_triggered()
+{
+	if(mUndoStack.canRedo() && !mNewPolygon)
+		restoreLabels(mUndoStack.redo());
 }
 
-void SimpleLabel::on_btnToBeginning_pressed()
+void SimpleLabel::on_actionUndoLimit_triggered()
+{
+	bool ok = false;
+	int mb = QInputDialog::getInt(this, "Undo History", "Memory limit (MB):", (int)(mUndoStack.memoryLimit()/(1024*1024)), 1, 4096, 1, &ok);
+	if(!ok)
+		return;
+
+	mUndoStack.setMemoryLimit((qint64)mb*1024*1024);
+	updateUndoActions();
+}
+
+//looks for frames where the boxes of the label drift off the target
+void SimpleLabel::analyzeDrift(int row)
+{
+	mDriftAnalyzer->setDisplaySize(mDisplayImage->size());
+	mDriftAnalyzer->analyze(row, mLabels[row].viaPoints, mLabels[row].boxes);
+}
+
+void SimpleLabel::on_cmbBoxInterpolation_currentIndexChanged(int index)
 {
 	int row = ui.listLabels->currentRow();
-	if(mShapeMode == Rect)
-	{
-		if( row >= 0 && mLabels[row].viaPoints.count() > 0)
-		{
-			ui.hSliderFrames->setValue(mLabels[row].viaPoints[0].frame);
-		}
-	}
-	else if(mShapeMode == Polyg)
+	if(row >= 0 && row < mLabels.count() && mLabels[row].intr != (InterpolationMethod)index)
 	{
-		if( row >= 0 && mLabels[row].viaPointsPoly.count() > 0)
+		mLabels[row].intr = (InterpolationMethod)index;
+		if(mLabels[row].viaPoints.count() > 0)
 		{
-			ui.hSliderFrames->setValue(mLabels[row].viaPointsPoly[0].frame);
+			//the rebuild keeps unchanged segments, the tracked ones have to go
+			mLabels[row].boxes.clear();
+			rebuildLabelBoxes();
+			if(mShapeMode == Rect)
+				setDrawRectToFrame(mMonitor->getCurrentFrameNumber());
 		}
+		commitEdit("Change Interpolation");
+		update();
 	}
 }
 
-void SimpleLabel::on_btnPrevViaPoint_pressed()
+void SimpleLabel::onSegmentTracked(int row, QList<ViaPoint> boxes)
 {
-	int row = ui.listLabels->currentRow();
-	if(mShapeMode == Rect)
+	if(row < 0 || row >= mLabels.count() || boxes.count() < 2 || mLabels[row].intr != Motion)
+		return;
+
+	//make sure the segment still lies between two neighbouring via points of
+	//the label, a moved, resized or rotated via point makes it stale
+	Label &lb = mLabels[row];
+	bool valid = false;
+	for(int i = 0; i < lb.viaPoints.count() - 1; i++)
 	{
-		if( row >= 0 && mLabels[row].viaPoints.count() > 0)
+		if(lb.viaPoints.at(i).frame == boxes.first().frame)
 		{
-			int fr = ui.hSliderFrames->value();
-			int i = mLabels[row].viaPoints.count() - 1;
-			while(mLabels[row].viaPoints[i].frame >= fr && i > 0)
-			{
-				i--;
-			}
-
-			ui.hSliderFrames->setValue(mLabels[row].viaPoints[i].frame);
+			valid = lb.viaPoints.at(i) == boxes.first() && lb.viaPoints.at(i + 1) == boxes.last();
+			break;
 		}
 	}
-	else if(mShapeMode == Polyg)
+	if(!valid)
+		return;
+
+	//only the blocks of boxes that really moved are copied
+	for(int k = 0; k < boxes.count(); k++)
 	{
-		if( row >= 0 && mLabels[row].viaPointsPoly.count() > 0)
-		{
-			int fr = ui.hSliderFrames->value();
-			int i = mLabels[row].viaPointsPoly.count() - 1;
-			while(mLabels[row].viaPointsPoly[i].frame >= fr && i > 0)
-			{
-				i--;
-			}
+		int i = lb.boxIndex(boxes[k].frame);
+		if(i >= 0 && lb.boxes.at(i) != boxes[k])
+			lb.boxes.replace(i, boxes[k]);
+	}
+	//tracking results belong to the edit that started the tracking
+	amendEdit();
+	analyzeDrift(row);
 
-			ui.hSliderFrames->setValue(mLabels[row].viaPointsPoly[i].frame);
-		}
+	int fr = mMonitor->getCurrentFrameNumber();
+	if(row == ui.listLabels->currentRow() && mShapeMode == Rect && !mSomethingChanged &&
+		fr > boxes.first().frame && fr < boxes.last().frame)
+	{
+		setDrawRectToFrame(fr);
 	}
+	update();
 }
 
-void SimpleLabel::on_btnStop_pressed()
+void SimpleLabel::onTrackingJobsChanged(int n)
 {
-	mMonitor->stop();
+	if(n > 0)
+		statusBar()->showMessage(QString("Tracking %1 segment(s)...").arg(n));
+	else
+		statusBar()->clearMessage();
 }
 
-void SimpleLabel::on_btnRemoveViaPoint_pressed()
+void SimpleLabel::onSuggestionsChanged(int row)
+{
+	if(row == ui.listLabels->currentRow())
+		update();
+}
+
+void SimpleLabel::on_actionNextSuggestion_triggered()
 {
 	int row = ui.listLabels->currentRow();
-	if(mShapeMode == Rect)
+	if(row < 0)
+		return;
+
+	QList<int> frames = mDriftAnalyzer->suggestions(row);
+	if(frames.isEmpty())
 	{
-		if( row >= 0 && mLabels[row].viaPoints.count() > 0)
-		{
-			int fr = ui.hSliderFrames->value();
-			for(int i = 0; i < mLabels[row].viaPoints.count(); i++)
-			{
-				if(mLabels[row].viaPoints[i].frame == fr)
-				{
-					mLabels[row].viaPoints.removeAt(i);
-					if(mLabels[row].viaPoints.count() > 0)
-					{
-						rebuildLabelBoxes();
-					}
-					break;
-				}
-			}
-		}
+		statusBar()->showMessage("No suggested via points for this label", 2000);
+		return;
 	}
-	else if(mShapeMode == Polyg)
+
+	//wrap around to the first suggestion after the last one
+	int fr = ui.hSliderFrames->value();
+	int i = 0;
+	while(i < frames.count() && frames[i] <= fr)
 	{
-		if( row >= 0 && mLabels[row].viaPointsPoly.count() > 0)
-		{
-			int fr = ui.hSliderFrames->value();
-			for(int i = 0; i < mLabels[row].viaPointsPoly.count(); i++)
-			{
-				if(mLabels[row].viaPointsPoly[i].frame == fr)
-				{
-					mLabels[row].viaPointsPoly.removeAt(i);
-					if(mLabels[row].viaPointsPoly.count() > 0)
-					{
-						rebuildLabelPolygons();
-					}
-					break;
-				}
-			}
-		}
+		i++;
 	}
+	ui.hSliderFrames->setValue(i < frames.count() ? frames[i] : frames.first());
 }
 
-void SimpleLabel::on_btnPlay_pressed()
-{
-	mMonitor->start();
-}
-
-
-void SimpleLabel::on_btnNextViaPoint_pressed()
+//moves the slider to a via point of the current label
+void SimpleLabel::seekViaPoint(ViaPointSeek seek)
 {
 	int row = ui.listLabels->currentRow();
-	if(mShapeMode == Rect)
-	{
-		if( row >= 0 && mLabels[row].viaPoints.count() > 0)
-		{
-			int fr = ui.hSliderFrames->value();
-			int i = 0;
-			while(mLabels[row].viaPoints[i].frame <= fr && i < mLabels[row].viaPoints.count() - 1)
-			{
-				i++;
-			}
+	if(row < 0)
+		return;
 
-			ui.hSliderFrames->setValue(mLabels[row].viaPoints[i].frame);
-		}
-	}
+	int fr = -1;
+	if(mShapeMode == Rect)
+		fr = Track<RectShape>(mLabels[row]).seek(seek, ui.hSliderFrames->value());
 	else if(mShapeMode == Polyg)
-	{
-		if( row >= 0 && mLabels[row].viaPointsPoly.count() > 0)
-		{
-			int fr = ui.hSliderFrames->value();
-			int i = 0;
-			while(mLabels[row].viaPointsPoly[i].frame <= fr && i < mLabels[row].viaPointsPoly.count() - 1)
-			{
-				i++;
-			}
+		fr = Track<PolygonShape>(mLabels[row]).seek(seek, ui.hSliderFrames->value());
 
-			ui.hSliderFrames->setValue(mLabels[row].viaPointsPoly[i].frame);
-		}
-	}
+	if(fr >= 0)
+		ui.hSliderFrames->setValue(fr);
 }
 
-void SimpleLabel::on_btnToEnd_pressed()
+void SimpleLabel::on_btnToBeginning_pressed()
 {
-	int row = ui.listLabels->currentRow();
-	if(mShapeMode == Rect)
-	{
-		if( row >= 0 && mLabels[row].viaPoints.count() > 0)
-		{
-			ui.hSliderFrames->setValue(mLabels[row].viaPoints.last().frame);
-		}
-	}
-	else if(mShapeMode == Polyg)
-	{
-		if( row >= 0 && mLabels[row].viaPointsPoly.count() > 0)
-		{
-			ui.hSliderFrames->setValue(mLabels[row].viaPointsPoly.last().frame);
-		}
-	}
+	seekViaPoint(SeekFirst);
 }
 
-void SimpleLabel::exportToMovie(bool origBkgrd)
+void SimpleLabel::on_btnPrevViaPoint_pressed()
 {
-	int nLbls = ui.listLabels->count();
-	int startF, endF;
-	int i, t;
-	QSize origSz = mMonitor->getImageSize();
-
-	if(nLbls > 0)
-	{
-		//find the earliest frame in all the labels
-		startF = qMax( mSaveDgl->ui.edtFirstImageIndex->text().toInt(), mFirstFrameNumber);
-		endF = qMin(mSaveDgl->ui.edtLastImageIndex->text().toInt(), mFirstFrameNumber + mMonitor->getFrameCount() - 1);
-		if(startF > mFirstFrameNumber + mMonitor->getFrameCount() - 1)
-		{
-			QMessageBox::information(this, "Index is out of bounds", "Starting frame number is larger than image sequence length.");
-			return;
-		}
-
-		CvVideoWriter* aviW;
-		QString saveFile = mSaveDgl->ui.edtSavePath->text();
-		QString path, prefix, fname, ext;
-		int index;
-
-		CommonFunctions::splitPath(saveFile, path, fname, prefix, (uint)5, index, ext);
-
-		if(mSaveDgl->ui.rbtnSaveAsAVI->isChecked())
-		{
-			int fps = mMonitor->getFPS();
-			if(fps < 1)
-				fps = 30;
-
-			try
-			{
-				//CV_FOURCC('M', 'P', '4', '2') CV_FOURCC('M','J','P','G')
-				aviW = cvCreateVideoWriter(saveFile.toAscii(), CV_FOURCC_PROMPT, fps, cvSize(origSz.width(), origSz.height()));
-			//		CvVideoWriter* aviW = cvCreateAVIWriter((mFileName.left(mFileName.length()-4) + "_bm.avi").toAscii(), 0, fps, cvSize(origSz.width(), origSz.height()));
-			}
-			catch(...)
-			{
-				aviW = cvCreateVideoWriter(saveFile.toAscii(), CV_FOURCC_DEFAULT, fps, cvSize(origSz.width(), origSz.height()));
-			}
-		}
-
-		QPainter pt;
-		int h;
-		QColor cl;
-		QBrush br(QColor(0,0,0,255));
-		QImage *im = NULL;
-		if(!origBkgrd)
-		{
-			im = new QImage(origSz, QImage::Format_ARGB32);
-		}
-		ViaPoint *bx;
-		ViaPointPolygon *polyg;
-		IplImage* ipl = cvCreateImage(cvSize(origSz.width(), origSz.height()), IPL_DEPTH_8U, 3);
-		for(t = startF; t <= endF; t++)
-		{
-			if(origBkgrd)
-			{
-				mMonitor->moveToFrame(t);
-				im = mMonitor->getImage();
-			}
-
-			pt.begin(im);
-			if(!origBkgrd)
-			{
-				pt.fillRect(im->rect(), Qt::black);
-			}
-			for(i = 0; i < nLbls; i++)
-			{
-				if(mLabels[i].shape == Rect)
-				{
-					if(t >= mLabels[i].boxes[0].frame &&
-						t <= mLabels[i].boxes[mLabels[i].boxes.count() - 1].frame)
-					{
-						h = 200;//(int)(100 + (i + 1) * 155.0/nLbls);
-						cl = QColor::fromRgb(h,h,h,128);
-						br.setColor(cl);
-						bx = mLabels[i].findBoxByFrame(t);
-						QRect rt = imageToImage(mDisplayImage->width(), mDisplayImage->height(), bx->rc, origSz.width(), origSz.height());
-						pt.fillRect(rt, br);
-					}
-				}
-				else if(mLabels[i].shape == Polyg)
-				{
-					if(t >= mLabels[i].polygons[0].frame &&
-						t <= mLabels[i].polygons[mLabels[i].polygons.count() - 1].frame)
-					{
-						h = 200;//(int)(100 + (i + 1) * 155.0/nLbls);
-						cl = QColor::fromRgb(h,h,h,128);
-						br.setColor(cl);
-						pt.setBrush(br);
-						polyg = mLabels[i].findPolygonByFrame(t);
-						QPolygon pl = imageToImage(mDisplayImage->width(), mDisplayImage->height(), polyg->pl, origSz.width(), origSz.height());
-						pt.drawPolygon(pl);
-					}
-				}
-			}
-
-			if(mSaveDgl->ui.rbtnSaveAsAVI->isChecked())
-			{
-				mMonitor->convertARGB2RGB(im, ipl);
-				cvWriteFrame(aviW, ipl);
-			}
-			else
-			{
-				QString sv;
-				sv = path + prefix + sv.sprintf("%05d", t) + ext;
-				im->save(sv, "PNG");
-			}
-
-			pt.end();
-		}
-		if(mSaveDgl->ui.rbtnSaveAsAVI->isChecked())
-		{
-			cvReleaseVideoWriter(&aviW);
-		}
-
-		if(!origBkgrd)
-		{
-			delete im;
-		}
-	}
+	seekViaPoint(SeekPrevious);
 }
 
+void SimpleLabel::on_btnStop_pressed()
+{
+	mMonitor->stop();
+}
 
-void SimpleLabel::exportToMatlabStruct()
+void SimpleLabel::on_btnRemoveViaPoint_pressed()
 {
-	QSize origSz = mMonitor->getImageSize();
-	int i, k, j;
-	QString saveFile = mSaveDgl->ui.edtSavePath->text();
-	QString filename = mSaveDgl->ui.edtFileNamePrefix->text();
+	int row = ui.listLabels->currentRow();
+	if(row < 0)
+		return;
 
-	QFile fd(saveFile);
-	if(fd.open(QFile::WriteOnly | QFile::Truncate))
-	{
-		QTextStream out(&fd);
-		out << "function " << filename << " = " << filename + "_lbl" << endl;
-		for(i = 0; i < mLabels.count(); i++)
-		{
-			out << filename << "(" << i +1 << ").number = " << mLabels[i].number << ";" << endl;
-			out << filename << "(" << i +1 << ").desc = '" << mLabels[i].desc.replace("\n", "") << "';" << endl;
-			out << filename << "(" << i +1 << ").name = '" << mLabels[i].name << "';" << endl;
-			out << filename << "(" << i +1 << ").startFrame = " << mLabels[i].viaPoints[0].frame << ";" << endl;
-			out << filename << "(" << i +1 << ").endFrame = " << mLabels[i].viaPoints[mLabels[i].viaPoints.count() - 1].frame << ";" << endl;
-
-			out << filename << "(" << i +1 << ").boxes = [";
-			for(k = 0; k < mLabels[i].boxes.count(); k++)
-			{
-				QRect rc = imageToImage(mDisplayImage->width(), mDisplayImage->height(), mLabels[i].boxes[k].rc, origSz.width(), origSz.height());
-				out << rc.left()<< "," << rc.top() << "," << rc.width() << "," << rc.height();
-				if(k != mLabels[i].boxes.count() - 1)
-					out << ";";
-			}
-			out << "];" << endl;
+	int fr = ui.hSliderFrames->value();
+	if(mShapeMode == Rect && Track<RectShape>(mLabels[row]).removeViaPoint(fr))
+		rebuildLabelBoxes();
+	else if(mShapeMode == Polyg && Track<PolygonShape>(mLabels[row]).removeViaPoint(fr))
+		rebuildLabelPolygons();
+	else
+		return;
+	commitEdit("Remove Via Point");
+}
 
-			for(k = 0; k < mLabels[i].viaPoints.count(); k++)
-			{
-				QRect rc = imageToImage(mDisplayImage->width(), mDisplayImage->height(), mLabels[i].viaPoints[k].rc, origSz.width(), origSz.height());
-					
-				out << filename << "(" << i +1 << ").pivots(" << k + 1 << ").frame = " <<  mLabels[i].viaPoints[k].frame << ";" << endl;
-				out << filename << "(" << i +1 << ").pivots(" << k + 1 << ").box = [";
-				out << rc.left() << "," << rc.top() << "," << rc.width() << "," << rc.height() << "];" << endl;
-			}
+void SimpleLabel::on_btnPlay_pressed()
+{
+	mMonitor->start();
+}
 
 
-			
-			for(k = 0; k < mLabels[i].polygons.count(); k++)
-			{
-				out << filename << "(" << i +1 << ").polygons(" << k + 1 << ").polygon=[";
-				QPolygon pl = imageToImage(mDisplayImage->width(), mDisplayImage->height(), mLabels[i].polygons[k].pl, origSz.width(), origSz.height());
-				for(j = 0; j < pl.count(); j++)
-				{
-					QPoint pt = pl.point(j);
-					out << pt.x() << "," << pt.y();
-					if(j != pl.count() - 1)
-						out << ";";
-				}
-				out << "];" << endl;
-			}
+void SimpleLabel::on_btnNextViaPoint_pressed()
+{
+	seekViaPoint(SeekNext);
+}
 
-			for(k = 0; k < mLabels[i].viaPointsPoly.count(); k++)
-			{
-				QPolygon pl = imageToImage(mDisplayImage->width(), mDisplayImage->height(), mLabels[i].viaPointsPoly[k].pl, origSz.width(), origSz.height());
-					
-				out << filename << "(" << i +1 << ").pivotsPolyg(" << k + 1 << ").frame = " <<  mLabels[i].viaPoints[k].frame << ";" << endl;
-				out << filename << "(" << i +1 << ").pivotsPolyg(" << k + 1 << ").polygon = [";
-				for(j = 0; j < pl.count(); j++)
-				{
-					QPoint pt = pl.point(j);
-					out << pt.x() << "," << pt.y();
-					if(j != pl.count() - 1)
-						out << ";";
-				}
-			}
-		}
-		out << "];" << endl;
-		fd.close();
-	}
+void SimpleLabel::on_btnToEnd_pressed()
+{
+	seekViaPoint(SeekLast);
 }
 
 Label* SimpleLabel::findLabel(int number)
@@ -1601,409 +1384,105 @@ Label* SimpleLabel::findLabel(int number)
 
 
 
-void SimpleLabel::exportToLabelMeXML()
+void SimpleLabel::on_actionLoad_LabelMe_XML_triggered()
 {
-	QString saveFile = mSaveDgl->ui.edtSavePath->text();
-	QString path, fname, ext;
-	CommonFunctions::splitPath(saveFile, path, fname, ext);
+	if(mLabelMeImporter->isRunning())
+		return;
 
-	int startF = qMax( mSaveDgl->ui.edtFirstImageIndex->text().toInt(), mFirstFrameNumber);
-	int endF = qMin(mSaveDgl->ui.edtLastImageIndex->text().toInt(), mFirstFrameNumber + mMonitor->getFrameCount() - 1);
-	if(startF > mFirstFrameNumber + mMonitor->getFrameCount() - 1)
+	QString s = QFileDialog::getOpenFileName(this, tr("Open LabelMe XML"), ".", tr("XML Files (*.xml)"));
+	if(!s.isEmpty() && mLabelMeImporter->start(s, mDisplayImage->size()))
 	{
-		QMessageBox::information(this, "Index is out of bounds", "Starting frame number is larger than image sequence length.");
-		return;
+		//the dialog keeps the labels from being edited while the files are parsed
+		mImportProgress = new QProgressDialog("Importing LabelMe files...", "Cancel", 0, 0, this);
+		mImportProgress->setWindowModality(Qt::WindowModal);
+		mImportProgress->setMinimumDuration(0);
+		connect(mImportProgress, SIGNAL(canceled()), mLabelMeImporter, SLOT(cancel()));
+		mImportProgress->show();
 	}
+}
 
-	for(int i = startF; i <= endF; i++)
+void SimpleLabel::onImportProgress(int done, int total)
+{
+	if(mImportProgress != NULL)
 	{
-		exportFrameToLabelMeXML(path, i);
+		mImportProgress->setRange(0, total);
+		mImportProgress->setValue(done);
 	}
 }
 
-
-void SimpleLabel::on_actionLoad_LabelMe_XML_triggered()
+void SimpleLabel::onImportFinished(bool ok, QString message)
 {
-	int curframe = -1, totframes = 0;
-	int w = 0, h = 0;
-	bool err = false;
-	QString s = QFileDialog::getOpenFileName(this, tr("Open LabelMe XML"), ".", tr("XML Files (*.xml)"));
-	QSize sz = mMonitor->getImageSize();
-
-	if(!s.isEmpty())
+	bool cancelled = false;
+	if(mImportProgress != NULL)
 	{
-		try
-		{
-			//scanning first file for global settings
-			QFile f(s);
-			if(f.open(QIODevice::ReadOnly))
-			{
-				QDomDocument doc("");
-				if(doc.setContent(&f))
-				{
-					resetLabels();
-
-					QDomNode anot = doc.documentElement();
-
-					QDomNode n = anot.firstChild();
-					while(!n.isNull())	//going through all the elements
-					{
-						QDomElement e = n.toElement();
-						if(!e.isNull() && e.tagName() == "frame")
-						{
-							curframe = e.text().trimmed().toInt();
-						}
-						if(!e.isNull() && e.tagName() == "source")
-						{
-
-							QDomNode n1 = n.firstChild();
-							while(!n1.isNull())	//going through all the children
-							{
-								QDomElement e1 = n1.toElement();
-								if(!e1.isNull() && e1.tagName() == "numberFrames")
-								{
-									totframes = e1.text().trimmed().toInt();
-								}
-								n1 = n1.nextSibling();
-							}
-						}
-						if(!e.isNull() && e.tagName() == "imagesize")
-						{
-							QDomNode n1 = n.firstChild();
-							while(!n1.isNull())	//going through all the children
-							{
-								QDomElement e1 = n1.toElement();
-								if(!e1.isNull() && e1.tagName() == "rows")
-								{
-									h = e1.text().trimmed().toInt();
-								}
-								if(!e1.isNull() && e1.tagName() == "columns")
-								{
-									w = e1.text().trimmed().toInt();
-								}
-								n1 = n1.nextSibling();
-							}
-						}
-
-						n = n.nextSibling();
-					}
-					
-				}
-				else
-				{
-					QMessageBox::information(this, "Invalid XML file", "Failed to parse XML file " + s);
-				}
-
-				f.close();
-			}
+		cancelled = mImportProgress->wasCanceled();
+		mImportProgress->deleteLater();
+		mImportProgress = NULL;
+	}
 
-			QRect rc;
-			int x, y, id;
-			QString idstr;
-			QString path;
-			QString ext;
-			QString filename;
-			QString prefix;
-			int firstframe;
-			QProgressBar pBar(statusBar());
-			pBar.setRange(curframe, totframes);
-			pBar.setVisible(true);
-
-			//splitting the full path into parts
-			CommonFunctions::splitPath(s, path, filename, prefix, (uint)5, firstframe, ext);
-
-			while(!err && curframe < totframes && QFile::exists(s))
-			{
-				pBar.setValue(curframe);
-				rc.setCoords(0,0,0,0);
-				QFile fd(s);
-				if(fd.open(QIODevice::ReadOnly))
-				{
-					QDomDocument doc("");
-					if(doc.setContent(&fd))
-					{	
-						QDomNode anot = doc.documentElement();
-
-						curframe = anot.namedItem("frame").toElement().text().trimmed().toInt();
-
-						QDomNode n = anot.firstChild();
-						while(!n.isNull())	//going through all the elements
-						{
-							QDomElement e = n.toElement();
-							if(!e.isNull() && e.tagName() == "object")
-							{
-								idstr = e.namedItem("tgtID").toElement().text().trimmed();
-								if(idstr == "")
-								{
-									n = n.nextSibling();
-									continue;
-								}
-								id = idstr.toInt();
-								Label *lbl = findLabel(id);
-								if(lbl == NULL)
-								{
-									//create a new label and added it to the list
-									//need to retrieve it from the list in order to
-									//get a pointer to the to the actual object in the list
-									lbl = new Label();
-									lbl->number = id;
-									lbl->name = e.namedItem("name").toElement().text();
-									mLabels.append(*lbl);
-									delete lbl;
-									lbl = findLabel(id);
-
-									//adding ui item to the list
-									QListWidgetItem *it = new QListWidgetItem();
-									it->setText(lbl->name);
-									it->setFlags(it->flags() | Qt::ItemIsEditable);
-									ui.listLabels->addItem(it);
-								}
-
-								
-								QDomNode bbox = e.namedItem("bbox");
-								if(!bbox.isNull())
-								{
-									QDomNode pt = bbox.namedItem("pt");
-									if(!pt.isNull())
-									{
-										x = qRound(pt.namedItem("x").toElement().text().trimmed().toFloat());
-										y = qRound(pt.namedItem("y").toElement().text().trimmed().toFloat());
-										rc.setTopLeft(QPoint(x,y));
-
-										pt = pt.nextSibling();
-										x = qRound(pt.namedItem("x").toElement().text().trimmed().toFloat());
-										y = qRound(pt.namedItem("y").toElement().text().trimmed().toFloat());
-										rc.setTopRight(QPoint(x,y));
-
-										pt = pt.nextSibling();
-										x = qRound(pt.namedItem("x").toElement().text().trimmed().toFloat());
-										y = qRound(pt.namedItem("y").toElement().text().trimmed().toFloat());
-										rc.setBottomRight(QPoint(x,y));
-
-										pt = pt.nextSibling();
-										x = qRound(pt.namedItem("x").toElement().text().trimmed().toFloat());
-										y = qRound(pt.namedItem("y").toElement().text().trimmed().toFloat());
-										rc.setBottomLeft(QPoint(x,y));
-
-										rc = imageToImage(w, h, rc, mDisplayImage->width(), mDisplayImage->height());
-
-										ViaPoint vp;
-										vp.frame = curframe;
-										vp.rc = rc;
-										lbl->boxes.append(vp);
-										lbl->viaPoints.append(vp);
-									}
-								}
-
-								QDomNode polygon = e.namedItem("polygon");
-								if(!polygon.isNull())
-								{
-									ViaPointPolygon polyg;
-									polyg.frame = curframe;
-									QDomNode pt = polygon.namedItem("pt");
-									while(!pt.isNull())
-									{
-										x = qRound(pt.namedItem("x").toElement().text().trimmed().toFloat());
-										y = qRound(pt.namedItem("y").toElement().text().trimmed().toFloat());
-										
-										QPoint pl_pt(x,y);
-
-										pl_pt = imageToImage(w, h, pl_pt, mDisplayImage->width(), mDisplayImage->height());
-										polyg.pl << pl_pt;
-										pt = pt.nextSibling();
-									}
-									//only adding polygon if it is at least a triangle
-									if(polyg.pl.count() > 2)
-									{
-										lbl->shape = Polyg;
-										lbl->polygons << polyg;
-										lbl->viaPointsPoly << polyg;
-									}
-								}
-							}
-							n = n.nextSibling();
-						}
-					}
-					else
-					{
-						QMessageBox::information(this, "Invalid XML file", "Failed to parse XML file " + s);
-						err = true;
-					}
+	if(!ok)
+	{
+		if(cancelled)
+			statusBar()->showMessage(message, 3000);
+		else
+			QMessageBox::information(this, "Invalid XML file", message);
+		return;
+	}
 
-					fd.close();
-				}
+	resetLabels();
+	mLabels = mLabelMeImporter->labels();
+	for(int row = 0; row < mLabels.count(); row++)
+	{
+		QListWidgetItem *it = new QListWidgetItem();
+		it->setText(mLabels[row].name);
+		it->setFlags(it->flags() | Qt::ItemIsEditable);
+		ui.listLabels->addItem(it);
+	}
 
-				firstframe++;
-				QString num;
-				num.sprintf("%05d",firstframe);
-				s = path + prefix + num + ext;
-			}
-			pBar.setVisible(false);
-		}
-		catch(...)
+	//LabelMe stores a box for every frame, keep only the via points needed to reproduce them
+	if(ui.actionSimplifyOnImport->isChecked())
+	{
+		int removed = 0;
+		for(int row = 0; row < mLabels.count(); row++)
 		{
-			QMessageBox::information(this, "Unrecoverable error", "Error while processing file: " + s);
+			removed += simplifyLabel(row, mSimplifyTolerance);
 		}
+		message += QString(", removed %1 via point(s)").arg(removed);
 	}
+	mSpanIndex.rebuild(mLabels);
+	resetHistory();
+	statusBar()->showMessage(message, 3000);
 }
 
 void SimpleLabel::on_actionLoad_XML_triggered()
 {
-	int w, h;
-	QSize origSz = mMonitor->getImageSize();
-
-	w = origSz.width();
-	h = origSz.height();
-
 	QString s = QFileDialog::getOpenFileName(this, tr("Open Label XML"), ".", tr("XML Files (*.xml)"));
 	if(!s.isEmpty())
 	{
 		QFile fd(s);
 		if(fd.open(QIODevice::ReadOnly))
 		{
-			QDomDocument doc("Labels");
-			if(doc.setContent(&fd))
+			LabelXmlReader reader;
+			if(reader.read(&fd, mMonitor->getImageSize(), mDisplayImage->size()))
 			{
 				resetLabels();
 
-				QDomNode root = doc.documentElement();
-				QDomNode n = root.firstChild();
-				while(!n.isNull())	//going through all the labels
+				mLabels = reader.labels();
+				for(int i = 0; i < mLabels.count(); i++)
 				{
-					QDomElement e = n.toElement();
-					if(!e.isNull() && e.tagName() == "image")
-					{
-						w = e.attribute("width", "-1").toInt();
-						h = e.attribute("height", "-1").toInt();
-					}
-					else if(!e.isNull() && e.tagName() == "label")
-					{
-						Label lb;
-						lb.name = e.attribute("name", "-1");
-						lb.desc = e.attribute("desc", "-1");
-						lb.number = e.attribute("number", "-1").toInt();
-						lb.shape = (LabelShape)e.attribute("shape", "-1").toInt();
-						
-						QDomNode t = e.firstChild();
-						while(!t.isNull())
-						{
-							QDomElement el = t.toElement();
-							qDebug() << el.tagName();
-							if(!el.isNull())
-							{
-								QDomNode p = el.firstChild();
-								while(!p.isNull())
-								{
-									QDomElement point = p.toElement();
-									qDebug() << point.tagName();
-									if(!point.isNull())
-									{
-										if(el.tagName() == "boxes" || el.tagName() == "pivots")
-										{
-											ViaPoint pt;
-
-											pt.frame = point.attribute("frame", "-1").toInt();
-											pt.rc.setLeft(point.attribute("left", "-1").toInt());
-											pt.rc.setTop(point.attribute("top", "-1").toInt());
-											pt.rc.setRight(point.attribute("right", "-1").toInt());
-											pt.rc.setBottom(point.attribute("bottom", "-1").toInt());
-											pt.angle = (point.attribute("angle", "0.0").toFloat());
-											if(point.tagName() == "box")
-											{
-												lb.boxes.append(pt);
-											}
-											else if(point.tagName() == "pivot")
-											{
-												lb.viaPoints.append(pt);
-											}
-										}
-										else if(el.tagName() == "polygons" || el.tagName() == "polygonPivots")
-										{
-											ViaPointPolygon pl;
-											pl.frame = point.attribute("frame", "-1").toInt();
-											
-											QDomNode vertex = point.firstChild();
-											while(!vertex.isNull())
-											{
-												QDomElement ver = vertex.toElement();
-												QPoint v;
-												v.setX(ver.attribute("x", "-1").toInt());
-												v.setY(ver.attribute("y", "-1").toInt());
-
-												pl.pl << v;
-
-												vertex = vertex.nextSibling();
-											}
-
-											if(point.tagName() == "polygon")
-											{
-												lb.polygons.append(pl);
-											}
-											else if(point.tagName() == "polygonPivot")
-											{
-												lb.viaPointsPoly.append(pl);
-											}
-										}
-									}
-									p = p.nextSibling();
-								}
-							}
-							t = t.nextSibling();
-						}
-						mLabels.append(lb);
-						ui.listLabels->addItem(lb.name);
-					}
-					n = n.nextSibling();
+					ui.listLabels->addItem(mLabels[i].name);
 				}
+				mSpanIndex.rebuild(mLabels);
+				resetHistory();
+				mJournal->markSaved(mLabels, s);
 
-				//converting coordinates to the screen image size
-				QList<Label>::iterator i;
-				for(i = mLabels.begin(); i != mLabels.end(); i++)
-				{
-					if(i->shape == Rect)
-					{
-						QList<ViaPoint>::iterator k;
-						for(k = i->boxes.begin(); k != i->boxes.end(); k++)
-						{
-							k->rc = imageToImage(w, h, k->rc, mDisplayImage->width(), mDisplayImage->height());
-						}
-
-						QList<ViaPoint>::iterator j;
-						for(j = i->viaPoints.begin(); j != i->viaPoints.end(); j++)
-						{
-							j->rc = imageToImage(w, h, j->rc, mDisplayImage->width(), mDisplayImage->height());
-
-							ViaPoint* bx = i->findBoxByFrame(j->frame);
-
-	//						qDebug() << "box:" << bx->rc << "   viapoint:" << j->rc;
-							if(bx != NULL && bx->rc != j->rc)
-								j->rc = bx->rc;
-						}
-					}
-					else if(i->shape == Polyg)
-					{
-						QList<ViaPointPolygon>::iterator k;
-						for(k = i->polygons.begin(); k != i->polygons.end(); k++)
-						{
-							k->pl = imageToImage(w, h, k->pl, mDisplayImage->width(), mDisplayImage->height());
-						}
-
-						QList<ViaPointPolygon>::iterator j;
-						for(j = i->viaPointsPoly.begin(); j != i->viaPointsPoly.end(); j++)
-						{
-							j->pl = imageToImage(w, h, j->pl, mDisplayImage->width(), mDisplayImage->height());
-
-							ViaPointPolygon* pl = i->findPolygonByFrame(j->frame);
-
-							if(pl != NULL && pl->pl != j->pl)
-								j->pl = pl->pl;
-						}
-					}
-				}
-		}	
+				double sec = qMax(reader.elapsed(), 1) / 1000.0;
+				statusBar()->showMessage(QString("Loaded %1 label(s) in %2 s, %3 MB/s").arg(mLabels.count())
+					.arg(sec, 0, 'f', 2).arg(reader.bytesRead() / (1024.0 * 1024.0) / sec, 0, 'f', 1), 5000);
+			}
 			else
 			{
-				QMessageBox::information(this, "Invalid XML file", "Failed to parse XML file " + s);
+				QMessageBox::information(this, "Invalid XML file", "Failed to parse XML file " + s + "\n" + reader.errorString());
 			}
 
 			fd.close();
@@ -2015,666 +1494,102 @@ void SimpleLabel::on_actionLoad_XML_triggered()
 	}
 }
 
-void SimpleLabel::exportFrameToLabelMeXMLWebTool(QString path, int frame)
-{
-	QSize origSz = mMonitor->getImageSize();
-
-	QDomDocument doc("");
-	QDomElement root = doc.createElement("annotation");
-	doc.appendChild(root);
-
-	//filename
-	QDomElement tmp = doc.createElement("filename");
-	QDomText txt = doc.createTextNode(mFileName);
-	tmp.appendChild(txt);
-	root.appendChild(tmp);
-
-	//folder
-	tmp = doc.createElement("folder");
-	txt = doc.createTextNode(mPath);
-	tmp.appendChild(txt);
-	root.appendChild(tmp);
-
-	//frame
-	tmp = doc.createElement("frame");
-	txt = doc.createTextNode(QString("%1").arg(frame));
-	tmp.appendChild(txt);
-	root.appendChild(tmp);
-
-	//source
-	QDomElement src = doc.createElement("source");
-	//sourceImage
-	tmp = doc.createElement("sourceImage");
-	txt = doc.createTextNode("");
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//sourceAnnotation
-	tmp = doc.createElement("sourceAnnotation");
-	txt = doc.createTextNode("SimpleLabel");
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//numberFrames
-	tmp = doc.createElement("numberFrames");
-	txt = doc.createTextNode(QString::number(mMonitor->getFrameCount()));
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-
-	root.appendChild(src);
-
-	//imagesize
-	src = doc.createElement("imagesize");
-	//rows
-	tmp = doc.createElement("rows");
-	txt = doc.createTextNode(QString::number(origSz.height()));
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//columns
-	tmp = doc.createElement("columns");
-	txt = doc.createTextNode(QString::number(origSz.width()));
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//channels
-	tmp = doc.createElement("channels");
-	txt = doc.createTextNode(QString::number(3));
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	root.appendChild(src);
-
-
-	int fr;
-	QDomElement obj;
-	QList<Label>::iterator lb;
-	
-	for(lb = mLabels.begin(); lb != mLabels.end(); lb++)
-	{
-		if(lb->boxes.count() < 1)
-			continue;
-
-		QDomElement pt;
-		QDomElement x;
-		QDomElement y;
-
-		//object
-		obj = doc.createElement("object");
-
-		//name
-		QDomElement name = doc.createElement("name");
-		//deleted
-		QDomElement deleted = doc.createElement("deleted");
-		//verified
-		QDomElement verified = doc.createElement("verified");
-		//date
-		QDomElement date = doc.createElement("date");
-		//id
-		QDomElement tgtID = doc.createElement("id");
-
-		//bbox
-		QDomElement bbox = doc.createElement("bbox");
-		//polygon
-		QDomElement polygon = doc.createElement("polygon");
-
-		fr = frame - lb->boxes[0].frame;
-		if(fr >= 0 && fr < lb->boxes.count())
-		{
-			QRect b = imageToImage(mDisplayImage->width(), mDisplayImage->height(), lb->boxes[fr].rc, origSz.width(), origSz.height());
-			
-			txt = doc.createTextNode(lb->name);
-			name.appendChild(txt);
-
-			txt = doc.createTextNode(QDateTime::currentDateTime().toString("d-MMM-yyy h:mm:ss"));
-			date.appendChild(txt);
-
-			txt = doc.createTextNode(QString::number(lb->number));
-			tgtID.appendChild(txt);
-
-			//polygon
-			if(lb->shape == Rect)
-			{
-				pt = doc.createElement("pt");
-				x = doc.createElement("x");
-				y = doc.createElement("y");
-
-				txt = doc.createTextNode(QString::number(b.left()));
-				x.appendChild(txt);
-				txt = doc.createTextNode(QString::number(b.top()));
-				y.appendChild(txt);
-				pt.appendChild(x);
-				pt.appendChild(y);
-				polygon.appendChild(pt);
-			}
-			else if(lb->shape == Polyg)
-			{
-				QPolygon pl = imageToImage(mDisplayImage->width(), mDisplayImage->height(), lb->viaPointsPoly[fr].pl, origSz.width(), origSz.height());
-				for(int pi = 0; pi < pl.count(); pi++)
-				{
-					pt = doc.createElement("pt");
-					x = doc.createElement("x");
-					y = doc.createElement("y");
-
-					QPoint pl_pt = pl.point(pi);
-					txt = doc.createTextNode(QString::number(pl_pt.x()));
-					x.appendChild(txt);
-					txt = doc.createTextNode(QString::number(pl_pt.y()));
-					y.appendChild(txt);
-					pt.appendChild(x);
-					pt.appendChild(y);
-					polygon.appendChild(pt);
-				}
-			}
-		}
-		else
-		{
-			txt = doc.createTextNode("");
-			bbox.appendChild(txt);
-			txt = doc.createTextNode("");
-			name.appendChild(txt);
-			txt = doc.createTextNode("");
-			tgtID.appendChild(txt);
-			txt = doc.createTextNode("");
-			polygon.appendChild(txt);
-		}
+void SimpleLabel::on_actionOpen_Project_triggered()
+{
+	QString s = QFileDialog::getOpenFileName(this, tr("Open Project"), ".", tr("SimpleLabel Projects (*.slp)"));
+	if(s.isEmpty())
+		return;
 
-		//deleted
-		txt = doc.createTextNode("0");
-		deleted.appendChild(txt);
-
-		//verified
-		txt = doc.createTextNode("1");
-		verified.appendChild(txt);
-
-		obj.appendChild(bbox);
-		obj.appendChild(name);
-		obj.appendChild(tgtID);
-		obj.appendChild(polygon);
-		obj.appendChild(deleted);
-		obj.appendChild(verified);
-
-		root.appendChild(obj);
-	}
-
-
-
-	QString num;
-	num.sprintf("%05d",frame);
-	QString fname = path + "/" + mFileNamePrefix + num + ".xml";
-	QFile fd(fname);
-	if(fd.open(QIODevice::WriteOnly | QIODevice::Truncate))
-	{
-		QTextStream out(&fd);
-		out << doc;
-
-		fd.close();
-	}
-}
-
-
-void SimpleLabel::exportFrameToLabelMeXML(QString path, int frame)
-{
-	QSize origSz = mMonitor->getImageSize();
-
-	QDomDocument doc("");
-	QDomElement root = doc.createElement("annotation");
-	doc.appendChild(root);
-
-	//filename
-	QDomElement tmp = doc.createElement("filename");
-	QDomText txt = doc.createTextNode(mFileName);
-	tmp.appendChild(txt);
-	root.appendChild(tmp);
-
-	//folder
-	tmp = doc.createElement("folder");
-	txt = doc.createTextNode(mPath);
-	tmp.appendChild(txt);
-	root.appendChild(tmp);
-
-	//frame
-	tmp = doc.createElement("frame");
-	txt = doc.createTextNode(QString("%1").arg(frame));
-	tmp.appendChild(txt);
-	root.appendChild(tmp);
-
-	//source
-	QDomElement src = doc.createElement("source");
-	//sourceImage
-	tmp = doc.createElement("sourceImage");
-	txt = doc.createTextNode("");
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//sourceAnnotation
-	tmp = doc.createElement("sourceAnnotation");
-	txt = doc.createTextNode("");
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//sensor
-	tmp = doc.createElement("sensor");
-	txt = doc.createTextNode("");
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//sensorType
-	tmp = doc.createElement("sensorType");
-	txt = doc.createTextNode("");
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//scenario
-	tmp = doc.createElement("scenario");
-	txt = doc.createTextNode("");
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//day
-	tmp = doc.createElement("day");
-	txt = doc.createTextNode("");
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//clip
-	tmp = doc.createElement("clip");
-	txt = doc.createTextNode("");
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//sampleSet
-	tmp = doc.createElement("sampleSet");
-	txt = doc.createTextNode("");
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//numberFrames
-	tmp = doc.createElement("numberFrames");
-	txt = doc.createTextNode(QString::number(mMonitor->getFrameCount()));
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//duration
-	tmp = doc.createElement("duration");
-	txt = doc.createTextNode("");
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//FrameRate
-	tmp = doc.createElement("FrameRate");
-	txt = doc.createTextNode("");
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-
-	root.appendChild(src);
-
-
-	//imagesize
-	src = doc.createElement("imagesize");
-	//rows
-	tmp = doc.createElement("rows");
-	txt = doc.createTextNode(QString::number(origSz.height()));
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//columns
-	tmp = doc.createElement("columns");
-	txt = doc.createTextNode(QString::number(origSz.width()));
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	//channels
-	tmp = doc.createElement("channels");
-	txt = doc.createTextNode(QString::number(3));
-	tmp.appendChild(txt);
-	src.appendChild(tmp);
-	root.appendChild(src);
-
-
-	int fr;
-	QDomElement obj;
-	QList<Label>::iterator lb;
-	for(lb = mLabels.begin(); lb != mLabels.end(); lb++)
-	{
-		if(lb->boxes.count() < 1)
-			continue;
-
-		//object
-		obj = doc.createElement("object");
-
-		//bbox
-		QDomElement bbox = doc.createElement("bbox");
-		//center
-		QDomElement center = doc.createElement("center");
-		//size
-		QDomElement size = doc.createElement("size");
-		//obscuration
-		QDomElement obscuration = doc.createElement("obscuration");
-		//view
-		QDomElement view = doc.createElement("view");
-		//name
-		QDomElement name = doc.createElement("name");
-		//tgtID
-		QDomElement tgtID = doc.createElement("tgtID");
-		//polygon
-		QDomElement polygon = doc.createElement("polygon");
-		//eccentricity
-		QDomElement eccentricity = doc.createElement("eccentricity");
-		//deleted
-		QDomElement deleted = doc.createElement("deleted");
-		//verified
-		QDomElement verified = doc.createElement("verified");
-
-		fr = frame - lb->boxes[0].frame;
-		if(fr >= 0 && fr < lb->boxes.count())
-		{
-			QRect b = imageToImage(mDisplayImage->width(), mDisplayImage->height(), lb->boxes[fr].rc, origSz.width(), origSz.height());
-			
-			QDomElement pt = doc.createElement("pt");
-			QDomElement x = doc.createElement("x");
-			QDomElement y = doc.createElement("y");
-
-			//top left
-			txt = doc.createTextNode(QString::number(b.left()));
-			x.appendChild(txt);
-			txt = doc.createTextNode(QString::number(b.top()));
-			y.appendChild(txt);
-			pt.appendChild(x);
-			pt.appendChild(y);
-			bbox.appendChild(pt);
-
-			//top right
-			pt = doc.createElement("pt");
-			x = doc.createElement("x");
-			y = doc.createElement("y");
-
-			txt = doc.createTextNode(QString::number(b.right()));
-			x.appendChild(txt);
-			txt = doc.createTextNode(QString::number(b.top()));
-			y.appendChild(txt);
-			pt.appendChild(x);
-			pt.appendChild(y);
-			bbox.appendChild(pt);
-
-			//bottom right
-			pt = doc.createElement("pt");
-			x = doc.createElement("x");
-			y = doc.createElement("y");
-
-			txt = doc.createTextNode(QString::number(b.right()));
-			x.appendChild(txt);
-			txt = doc.createTextNode(QString::number(b.bottom()));
-			y.appendChild(txt);
-			pt.appendChild(x);
-			pt.appendChild(y);
-			bbox.appendChild(pt);
-
-			//bottom left
-			pt = doc.createElement("pt");
-			x = doc.createElement("x");
-			y = doc.createElement("y");
-
-			txt = doc.createTextNode(QString::number(b.left()));
-			x.appendChild(txt);
-			txt = doc.createTextNode(QString::number(b.bottom()));
-			y.appendChild(txt);
-			pt.appendChild(x);
-			pt.appendChild(y);
-			bbox.appendChild(pt);
-
-			//top left
-			pt = doc.createElement("pt");
-			x = doc.createElement("x");
-			y = doc.createElement("y");
-
-			txt = doc.createTextNode(QString::number(b.left()));
-			x.appendChild(txt);
-			txt = doc.createTextNode(QString::number(b.top()));
-			y.appendChild(txt);
-			pt.appendChild(x);
-			pt.appendChild(y);
-			bbox.appendChild(pt);
-
-			//center
-			x = doc.createElement("x");
-			y = doc.createElement("y");
-
-			txt = doc.createTextNode(QString::number((b.left() + b.right())/2));
-			x.appendChild(txt);
-			txt = doc.createTextNode(QString::number((b.top() + b.bottom())/2));
-			y.appendChild(txt);
-
-			center.appendChild(x);
-			center.appendChild(y);
-
-			//size
-			x = doc.createElement("x");
-			y = doc.createElement("y");
-
-			txt = doc.createTextNode(QString::number(b.width()));
-			x.appendChild(txt);
-			txt = doc.createTextNode(QString::number(b.height()));
-			y.appendChild(txt);
-
-			size.appendChild(x);
-			size.appendChild(y);
-
-			//obscuration
-			txt = doc.createTextNode("unobscured");
-			obscuration.appendChild(txt);
-			
-			//view
-			txt = doc.createTextNode("");
-			view.appendChild(txt);
-
-			//name
-			txt = doc.createTextNode(lb->name);
-			name.appendChild(txt);
-
-			//tgtID
-			txt = doc.createTextNode(QString::number(lb->number));
-			tgtID.appendChild(txt);
-
-			//polygon
-			if(lb->shape == Rect)
-			{
-				pt = doc.createElement("pt");
-				x = doc.createElement("x");
-				y = doc.createElement("y");
-
-				txt = doc.createTextNode(QString::number(b.left()));
-				x.appendChild(txt);
-				txt = doc.createTextNode(QString::number(b.top()));
-				y.appendChild(txt);
-				pt.appendChild(x);
-				pt.appendChild(y);
-				polygon.appendChild(pt);
-			}
-			else if(lb->shape == Polyg)
-			{
-				QPolygon pl = imageToImage(mDisplayImage->width(), mDisplayImage->height(), lb->viaPointsPoly[fr].pl, origSz.width(), origSz.height());
-				for(int pi = 0; pi < pl.count(); pi++)
-				{
-					pt = doc.createElement("pt");
-					x = doc.createElement("x");
-					y = doc.createElement("y");
-
-					QPoint pl_pt = pl.point(pi);
-					txt = doc.createTextNode(QString::number(pl_pt.x()));
-					x.appendChild(txt);
-					txt = doc.createTextNode(QString::number(pl_pt.y()));
-					y.appendChild(txt);
-					pt.appendChild(x);
-					pt.appendChild(y);
-					polygon.appendChild(pt);
-				}
-			}
-			
+	ProjectFile project;
+	if(!project.open(s, mDisplayImage->size()))
+	{
+		QMessageBox::information(this, "Open project failed", "Failed to open project " + s + "\n" + project.errorString());
+		return;
+	}
 
-			//eccentricity
-			float sm = qMin(b.width(), b.height());
-			float bg = qMax(b.width(), b.height());
-			txt = doc.createTextNode(QString::number(bg/sm));
-			eccentricity.appendChild(txt);
-		}
-		else
-		{
-			txt = doc.createTextNode("");
-			bbox.appendChild(txt);
-			txt = doc.createTextNode("");
-			center.appendChild(txt);
-			txt = doc.createTextNode("");
-			size.appendChild(txt);
-			txt = doc.createTextNode("");
-			obscuration.appendChild(txt);
-			txt = doc.createTextNode("");
-			name.appendChild(txt);
-			txt = doc.createTextNode("");
-			tgtID.appendChild(txt);
-			txt = doc.createTextNode("");
-			polygon.appendChild(txt);
-			txt = doc.createTextNode("");
-			eccentricity.appendChild(txt);
-		}
+	setLabels(project.labels());
+	mProjectFile = s;
+	mJournal->markSaved(mLabels, s);
 
-		//deleted
-		txt = doc.createTextNode("0");
-		deleted.appendChild(txt);
+	statusBar()->showMessage(QString("Opened %1 label(s) in %2 s").arg(mLabels.count()).arg(project.elapsed() / 1000.0, 0, 'f', 2), 5000);
+}
 
-		//verified
-		txt = doc.createTextNode("1");
-		verified.appendChild(txt);
+void SimpleLabel::on_actionSave_Project_triggered()
+{
+	if(mProjectFile.isEmpty())
+		on_actionSave_Project_As_triggered();
+	else
+		saveProject(mProjectFile);
+}
 
-		obj.appendChild(bbox);
-		obj.appendChild(center);
-		obj.appendChild(size);
-		obj.appendChild(obscuration);
-		obj.appendChild(view);
-		obj.appendChild(name);
-		obj.appendChild(tgtID);
-		obj.appendChild(polygon);
-		obj.appendChild(eccentricity);
-		obj.appendChild(deleted);
-		obj.appendChild(verified);
+void SimpleLabel::on_actionSave_Project_As_triggered()
+{
+	QString s = QFileDialog::getSaveFileName(this, tr("Save Project"), mPath, tr("SimpleLabel Projects (*.slp)"));
+	if(!s.isEmpty())
+		saveProject(s);
+}
 
-		root.appendChild(obj);
+void SimpleLabel::saveProject(const QString &file)
+{
+	ProjectFile project;
+	if(!project.save(file, mLabels, mDisplayImage->size(), mMonitor->getImageSize()))
+	{
+		QMessageBox::information(this, "Save project failed", "Failed to save project " + file + "\n" + project.errorString());
+		return;
 	}
+	mProjectFile = file;
+	mJournal->markSaved(mLabels, file);
 
+	int blocks = project.blocksWritten() + project.blocksKept();
+	statusBar()->showMessage(QString("Saved %1 label(s) in %2 s, wrote %3 of %4 blocks (%5 KB)").arg(mLabels.count())
+		.arg(project.elapsed() / 1000.0, 0, 'f', 2).arg(project.blocksWritten()).arg(blocks).arg(project.bytesWritten() / 1024), 5000);
+}
 
-
-	QString num;
-	num.sprintf("%05d",frame);
-	QString fname = path + "/" + mFileNamePrefix + num + ".xml";
-	QFile fd(fname);
-	if(fd.open(QIODevice::WriteOnly | QIODevice::Truncate))
+//replaces all labels, the history starts over
+void SimpleLabel::setLabels(const QList<Label> &labels)
+{
+	resetLabels();
+	mLabels = labels;
+	for(int i = 0; i < mLabels.count(); i++)
 	{
-		QTextStream out(&fd);
-		out << doc;
-
-		fd.close();
+		ui.listLabels->addItem(mLabels[i].name);
 	}
-
+	mSpanIndex.rebuild(mLabels);
+	resetHistory();
 }
 
-void SimpleLabel::exportToSimpleLabelXML()
+//opens the journal of the video and offers to recover the labels that were
+//not saved when the last session ended
+void SimpleLabel::openJournal()
 {
-	int i, k, j;
-
-	QDomDocument doc("Labels");
-	QDomElement root = doc.createElement("root");
-	doc.appendChild(root);
-	QSize origSz = mMonitor->getImageSize();
-
-	//save image properties
-	QDomElement imTag = doc.createElement("image");
-	imTag.setAttribute("name", mFileName);
-	imTag.setAttribute("width", origSz.width());
-	imTag.setAttribute("height", origSz.height());
-	root.appendChild(imTag);
-
-	//save labels
-	for(i = 0; i < mLabels.count(); i++)
+	QString name = mFirstFrameNumber >= 0 ? mFileNamePrefix : mFileName;
+	QString file = mPath + name + ".sljournal";
+	QList<Label> labels;
+	bool unsaved;
+	if(!mJournal->open(file, labels, unsaved))
 	{
-		QDomElement tag = doc.createElement("label");
-		tag.setAttribute("name", mLabels[i].name);
-		tag.setAttribute("number", mLabels[i].number);
-		tag.setAttribute("desc", mLabels[i].desc);
-		tag.setAttribute("shape", mLabels[i].shape);
-
-		if(mLabels[i].shape == Rect)
-		{
-			//bounding rectangles
-			QDomElement boxes = doc.createElement("boxes");
-			for(k = 0; k < mLabels[i].boxes.count(); k++)
-			{
-				QRect p = imageToImage(mDisplayImage->width(), mDisplayImage->height(), mLabels[i].boxes[k].rc, origSz.width(), origSz.height());
-				QDomElement b = doc.createElement("box");
-				b.setAttribute("frame", mLabels[i].boxes[k].frame);
-				b.setAttribute("left", p.left());
-				b.setAttribute("top", p.top());
-				b.setAttribute("right", p.right());
-				b.setAttribute("bottom", p.bottom());
-				b.setAttribute("angle", mLabels[i].boxes[k].angle);
-
-				boxes.appendChild(b);
-			}
-			tag.appendChild(boxes);
-
-			//bounding rectangle via points
-			QDomElement pivots = doc.createElement("pivots");
-			for(k = 0; k < mLabels[i].viaPoints.count(); k++)
-			{
-				QRect p = imageToImage(mDisplayImage->width(), mDisplayImage->height(), mLabels[i].viaPoints[k].rc, origSz.width(), origSz.height());
-				QDomElement b = doc.createElement("pivot");
-				b.setAttribute("frame", mLabels[i].viaPoints[k].frame);
-				b.setAttribute("left", p.left());
-				b.setAttribute("top", p.top());
-				b.setAttribute("right", p.right());
-				b.setAttribute("bottom", p.bottom());
-				b.setAttribute("angle", mLabels[i].viaPoints[k].angle);
-
-				pivots.appendChild(b);
-			}
-			tag.appendChild(pivots);
-		}
-		else if(mLabels[i].shape == Polyg)
-		{
-			//polygons
-			QDomElement polygons = doc.createElement("polygons");
-			for(k = 0; k < mLabels[i].polygons.count(); k++)
-			{
-				QDomElement polyg = doc.createElement("polygon");
-				polyg.setAttribute("frame", mLabels[i].polygons[k].frame);
-				for(j = 0; j < mLabels[i].polygons[k].pl.count(); j++)
-				{
-					QPoint p = imageToImage(mDisplayImage->width(), mDisplayImage->height(), mLabels[i].polygons[k].pl.point(j), origSz.width(), origSz.height());
-					QDomElement vertex = doc.createElement("vertex");
-					vertex.setAttribute("x", p.x());
-					vertex.setAttribute("y", p.y());
-					polyg.appendChild(vertex);
-				
-				}
-				polygons.appendChild(polyg);
-			}
-			tag.appendChild(polygons);
-
-			//polygon via points
-			QDomElement polygonPivots = doc.createElement("polygonPivots");
-			for(k = 0; k < mLabels[i].viaPointsPoly.count(); k++)
-			{
-				QDomElement polygPivot = doc.createElement("polygonPivot");
-				polygPivot.setAttribute("frame", mLabels[i].viaPointsPoly[k].frame);
-				for(j = 0; j < mLabels[i].viaPointsPoly[k].pl.count(); j++)
-				{
-					QPoint p = imageToImage(mDisplayImage->width(), mDisplayImage->height(), mLabels[i].viaPointsPoly[k].pl.point(j), origSz.width(), origSz.height());
-					QDomElement vertex = doc.createElement("vertex");
-					vertex.setAttribute("x", p.x());
-					vertex.setAttribute("y", p.y());
-					polygPivot.appendChild(vertex);
-				}
-				polygonPivots.appendChild(polygPivot);
-			}
-			tag.appendChild(polygonPivots);
-		}
-		root.appendChild(tag);
+		statusBar()->showMessage("Autosave is off, failed to open " + file + ": " + mJournal->errorString(), 10000);
+		return;
 	}
 
-	QString saveFile = mSaveDgl->ui.edtSavePath->text();
-
-	QFile fd(saveFile);
-	if(fd.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	if(unsaved && !labels.isEmpty() &&
+		QMessageBox::question(this, "Recover labels", QString("%1 label(s) of this video were not saved. Recover them?").arg(labels.count()),
+		QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes) == QMessageBox::Yes)
 	{
-		QTextStream out(&fd);
-		out << doc;
-
-		fd.close();
+		setLabels(labels);
+		statusBar()->showMessage(QString("Recovered %1 label(s)").arg(labels.count()), 5000);
+	}
+	else
+	{
+		//the journal continues from the current labels
+		mJournal->record(mLabels);
 	}
 }
 
+void SimpleLabel::onJournalFailed(QString error)
+{
+	QMessageBox::information(this, "Autosave failed", "Writing " + mJournal->fileName() + " failed, the edits are no longer autosaved.\n" + error);
+}
 
 void SimpleLabel::on_actionExport_triggered()
 {
@@ -2708,33 +1623,128 @@ void SimpleLabel::on_actionExport_triggered()
 
 void SimpleLabel::on_SaveDialog_accept()
 {
-	if(mSaveDgl->ui.rbtnBlackBgrd->isChecked())
+	if(mExporter->isRunning())
 	{
-		exportToMovie(false);
+		QMessageBox::information(this, "Export", "Another export is running. Wait for it to finish or cancel it.");
+		return;
 	}
+
+	ExportSettings settings;
+	if(mSaveDgl->ui.rbtnBlackBgrd->isChecked())
+		settings.format = ExportBlackBackground;
 	else if(mSaveDgl->ui.rbtnOrigImage->isChecked())
+		settings.format = ExportOriginalImages;
+	else if(mSaveDgl->ui.rbtnSimpleLabelXML->isChecked())
+		settings.format = ExportSimpleLabelXML;
+	else if(mSaveDgl->ui.rbtLabelMeXML->isChecked())
+		settings.format = ExportLabelMeXML;
+	else if(mSaveDgl->ui.rbtnMatlabStruct->isChecked())
+		settings.format = ExportMatlabStruct;
+	else if(mSaveDgl->ui.rbtnNumpy->isChecked())
+		settings.format = ExportNumpy;
+	else if(mSaveDgl->ui.rbtnInstanceMasks->isChecked())
+		settings.format = ExportInstanceMasks;
+	else if(mSaveDgl->ui.rbtnSemanticMasks->isChecked())
+		settings.format = ExportSemanticMasks;
+	else
+		return;
+
+	settings.saveAsAvi = mSaveDgl->ui.rbtnSaveAsAVI->isChecked();
+	settings.imageFormat = (ImageSequenceFormat)mSaveDgl->ui.cmbImageFormat->currentIndex();
+	settings.codec = mSaveDgl->codec();
+	settings.segments = mSaveDgl->ui.spinSegments->value();
+	settings.archive = mSaveDgl->ui.chkArchive->isChecked();
+	settings.saveFile = mSaveDgl->ui.edtSavePath->text();
+	settings.structName = mSaveDgl->ui.edtFileNamePrefix->text();
+	settings.frameCount = mMonitor->getFrameCount();
+	settings.firstFrame = qMax(mSaveDgl->ui.edtFirstImageIndex->text().toInt(), mFirstFrameNumber);
+	settings.lastFrame = qMin(mSaveDgl->ui.edtLastImageIndex->text().toInt(), mFirstFrameNumber + settings.frameCount - 1);
+	settings.fps = mMonitor->getFPS();
+	if(settings.fps < 1)
+		settings.fps = 30;
+	settings.displaySize = mDisplayImage->size();
+	settings.imageSize = mMonitor->getImageSize();
+	settings.fileName = mFileName;
+	settings.path = mPath;
+	settings.fileNamePrefix = mFileNamePrefix;
+
+	if(Exporter::countsFrames(settings.format) && settings.firstFrame > mFirstFrameNumber + settings.frameCount - 1)
 	{
-		exportToMovie(true);
+		QMessageBox::information(this, "Index is out of bounds", "Starting frame number is larger than image sequence length.");
+		return;
 	}
-	else if(mSaveDgl->ui.rbtnSimpleLabelXML->isChecked())
+
+	//per frame exports only rewrite the frames that changed since the last
+	//export with the same settings
+	LabelSnapshot labels = mLabelStore.snapshot();
+	QString key = QString("%1|%2|%3|%4|%5|%6|%7|%8").arg(settings.format).arg(settings.saveFile).arg(settings.saveAsAvi)
+		.arg(settings.imageFormat).arg(settings.firstFrame).arg(settings.lastFrame).arg(settings.fileName).arg(settings.archive);
+	if(mSaveDgl->ui.chkChangedFramesOnly->isChecked() && mExportedLabels.contains(key))
 	{
-		exportToSimpleLabelXML();
+		settings.changedOnly = true;
+		settings.changedFrames = FrameRangeSet::changedFrames(mExportedLabels[key].labels(), labels.labels());
 	}
-	else if(mSaveDgl->ui.rbtLabelMeXML->isChecked())
+
+	//The export works on its own snapshot and its own reader, so labeling and
+	//motion tracking can go on in the meantime without waiting for each other
+	//on the capture. The reader has to be opened here in the GUI thread.
+	QSharedPointer<FrameReader> reader;
+	if(!mFrameReader.isNull())
+		reader = QSharedPointer<FrameReader>(new FrameReader(mFrameReader->fileName()));
+	if(mExporter->start(settings, labels, reader))
 	{
-		exportToLabelMeXML();
+		mExportKey = key;
+		mExportLabels = labels;
+		mExportXmlFile = settings.format == ExportSimpleLabelXML ? settings.saveFile : QString();
+		mExportUnit = Exporter::countsFrames(settings.format) ? "frames" : "labels";
+		mExportProgress->setFormat("%v/%m " + mExportUnit);
+		mExportProgress->setRange(0, 0);
+		mExportProgress->setVisible(true);
+		mExportCancel->setVisible(true);
 	}
-	else if(mSaveDgl->ui.rbtnMatlabStruct->isChecked())
+}
+
+void SimpleLabel::onExportProgress(int done, int total, double rate)
+{
+	mExportProgress->setRange(0, total);
+	mExportProgress->setValue(done);
+	statusBar()->showMessage(QString("Exporting... %1 %2/s").arg(rate, 0, 'f', 1).arg(mExportUnit));
+}
+
+void SimpleLabel::onExportFinished(bool ok, QString message)
+{
+	//a failed or cancelled export leaves the files in an unknown state
+	if(ok)
+		mExportedLabels[mExportKey] = mExportLabels;
+	else
+		mExportedLabels.remove(mExportKey);
+	//the exported labels are saved, the edits made during the export are not
+	if(ok && !mExportXmlFile.isEmpty())
 	{
-		exportToMatlabStruct();
+		mJournal->markSaved(mExportLabels.labels(), mExportXmlFile);
+		mJournal->record(mLabels);
 	}
+	mExportLabels = LabelSnapshot();
+	mExportXmlFile = "";
 
+	mExportProgress->setVisible(false);
+	mExportCancel->setVisible(false);
+	statusBar()->showMessage(message, 5000);
 }
 
 void SimpleLabel::on_cmbBoxLabelShape_currentIndexChanged ( int index )
 {
-	mShapeMode = (LabelShape)index;
 	int row = ui.listLabels->currentRow();
+	if(row >= 0 && row < mLabels.count() && !convertLabelShape(row, (LabelShape)index))
+	{
+		ui.cmbBoxLabelShape->blockSignals(true);
+		ui.cmbBoxLabelShape->setCurrentIndex(mShapeMode);
+		ui.cmbBoxLabelShape->blockSignals(false);
+		return;
+	}
+	commitEdit("Change Shape");
+
+	mShapeMode = (LabelShape)index;
 	if(row >= 0 && mMonitor->isInitialized())
 	{
 		switch(mShapeMode)
@@ -2756,6 +1766,45 @@ void SimpleLabel::on_cmbBoxLabelShape_currentIndexChanged ( int index )
 	}
 }
 
+//Makes the given shape the authoritative track of the label, the via points
+//of the old shape are converted. Polygons only survive as their bounding
+//boxes so the user is asked first.
+bool SimpleLabel::convertLabelShape(int row, LabelShape shape)
+{
+	Label &lb = mLabels[row];
+	if(lb.shape == shape)
+		return true;
+
+	if(shape == Rect && lb.viaPointsPoly.count() > 0)
+	{
+		if(QMessageBox::question(this, "Convert the Label",
+			"Converting the label to a rectangle replaces its polygons with their bounding boxes.\nDo you want to proceed?",
+			QMessageBox::Ok, QMessageBox::Cancel) != QMessageBox::Ok)
+		{
+			return false;
+		}
+
+		lb.viaPoints = Label::toBoxes(lb.viaPointsPoly);
+		lb.viaPointsPoly.clear();
+		lb.polygons.clear();
+		lb.shape = Rect;
+		rebuildLabelBoxes(row);
+	}
+	else if(shape == Polyg && lb.viaPoints.count() > 0)
+	{
+		lb.viaPointsPoly = Label::toPolygons(lb.viaPoints);
+		lb.viaPoints.clear();
+		lb.boxes.clear();
+		lb.shape = Polyg;
+		mMotionTracker->cancel(row);
+		mDriftAnalyzer->cancel(row);
+		rebuildLabelPolygons(row);
+	}
+
+	lb.shape = shape;
+	return true;
+}
+
 void SimpleLabel::on_actionNewPolygon_triggered()
 {
 	int row = ui.listLabels->currentRow();
@@ -2772,6 +1821,7 @@ void SimpleLabel::on_actionNewPolygon_triggered()
 			mLabels[row].viaPointsPoly.clear();
 			mLabels[row].polygons.clear();
 			mLabels[row].shape = Polyg;
+			mSpanIndex.update(row, mLabels[row]);
 
 			mFirstPolygon = QPolygon();
 			mNewPolygon = true;
@@ -2803,6 +1853,7 @@ void SimpleLabel::on_actionFinish_triggered()
 		mDrawPolygon = mFirstPolygon;
 	}
 	mNewPolygon = false;
+	commitEdit("New Polygon");
 
 	ui.centralWidget->setEnabled(true);
 	ui.menuFile->setEnabled(true);
@@ -27,12 +27,27 @@
 
 #include <QtGui/QMainWindow>
 #include <QPolygon>
+#include <QSharedPointer>
+#include <QHash>
 #include "ui_SimpleLabel.h"
 #include "Constants.h"
+#include "LabelSpanIndex.h"
+#include "Track.h"
+#include "UndoStack.h"
+#include "LabelStore.h"
 
 class Monitor;
 class About;
 class SaveDialog;
+class MotionTracker;
+class DriftAnalyzer;
+class Exporter;
+class LabelMeImporter;
+class EditJournal;
+class FrameReader;
+class QProgressBar;
+class QProgressDialog;
+class QPushButton;
 
 class SimpleLabel : public QMainWindow
 {
@@ -42,9 +57,11 @@ public:
 	SimpleLabel(QWidget *parent = 0, Qt::WFlags flags = 0);
 	~SimpleLabel();
 
+	//latest published version of the labels, safe to read from any thread
+	LabelSnapshot labelSnapshot() const { return mLabelStore.snapshot(); }
 
-public:
-	QList<Label> mLabels;
+	//save dialog defaults of the avi codec and segment count, set by the command line options
+	void setVideoExportDefaults(const QString &codec, int segments);
 
 private:
 	void resetLabels();
@@ -52,39 +69,46 @@ private:
 	void releaseCapture();
 	QPoint screenToImage(QPoint scr);
 	QPoint imageToScreen(QPoint im);
-	QPoint imageToImage(int srcW, int srcH, QPoint srcP, int destW, int destH);
 	QRect screenToImage(QRect scr);
 	QRect imageToScreen(QRect im);
-	QRect imageToImage(int srcW, int srcH, QRect srcP, int destW, int destH);
 	QPolygon screenToImage(QPolygon scr);
 	QPolygon imageToScreen(QPolygon im);
-	QPolygon imageToImage(int srcW, int srcH, QPolygon srcP, int destW, int destH);
 	void updateListView();
-	void addViaPoint(int frame, QRect rc);
 	void addViaPoint(int frame, ViaPoint v);
-	void addViaPointPoly(int frame, QPolygon pl, bool addRect = true);
+	void addViaPointPoly(int frame, QPolygon pl);
+	bool convertLabelShape(int row, LabelShape shape);
 	void rebuildLabelBoxes();
+	void rebuildLabelBoxes(int row);
 	void rebuildLabelPolygons();
+	void rebuildLabelPolygons(int row);
+	int simplifyLabel(int row, double tolerance);
 	void setDrawRectToFrame(int v);
 	void setDrawPolygonToFrame(int v);
-	QRect linearInterpolation(QRect initPoint, double dx, double dy, double dw, double dh, int t);
-	QPoint linearInterpolation(QPoint src, QPointF dt, int t);
-	void exportFrameToLabelMeXML(QString path, int frame);
-	void exportFrameToLabelMeXMLWebTool(QString path, int frame);
+	void seekViaPoint(ViaPointSeek seek);
 	Label* findLabel(int number);
-	void exportToMovie(bool origBkgrd);
-	void exportToSimpleLabelXML();
-	void exportToLabelMeXML();
-	void exportToMatlabStruct();
 	void drawCirclesAtVertices(QPainter *pt, QRect rc);
 	void drawCirclesAtVertices(QPainter *pt, QPolygon &pl);
 	void drawModeRect(QPainter *pt, int frame);
 	void drawModePoly(QPainter *pt, int frame);
+	void drawSuggestions(QPainter *pt);
+	void analyzeDrift(int row);
+	void commitEdit(const QString &text);
+	void amendEdit();
+	void resetHistory();
+	void restoreLabels(const QList<Label> &labels);
+	void updateUndoActions();
+	void saveProject(const QString &file);
+	void setLabels(const QList<Label> &labels);
+	void publishLabels();
+	void openJournal();
 	//QRect rotateRect(QRect rc, float a);
 
 private slots:
 	virtual void on_actionOpen_triggered();
 	virtual void on_actionLoad_XML_triggered();
+	virtual void on_actionOpen_Project_triggered();
+	virtual void on_actionSave_Project_triggered();
+	virtual void on_actionSave_Project_As_triggered();
 	virtual void showImage();
 	virtual void paintEvent (QPaintEvent*);
 	virtual void on_hSliderFrames_valueChanged(int v);
@@ -111,12 +135,46 @@ private slots:
 	virtual void on_actionNewPolygon_triggered();
 	virtual void on_actionFinish_triggered();
 	virtual void on_textEditDescription_textChanged();
+	virtual void on_cmbBoxInterpolation_currentIndexChanged(int index);
+	virtual void onSegmentTracked(int row, QList<ViaPoint> boxes);
+	virtual void onTrackingJobsChanged(int n);
+	virtual void onSuggestionsChanged(int row);
+	virtual void on_actionNextSuggestion_triggered();
+	virtual void on_actionSimplifyTrack_triggered();
+	virtual void on_actionUndo_triggered();
+	virtual void on_actionRedo_triggered();
+	virtual void on_actionUndoLimit_triggered();
+	virtual void onExportProgress(int done, int total, double rate);
+	virtual void onExportFinished(bool ok, QString message);
+	virtual void onImportProgress(int done, int total);
+	virtual void onImportFinished(bool ok, QString message);
+	virtual void onJournalFailed(QString error);
 
 private:
 	Ui::SimpleLabelClass ui;
 
+	//labels edited by the GUI thread, other threads read snapshots of mLabelStore
+	QList<Label> mLabels;
+	LabelStore mLabelStore;
+	LabelSpanIndex mSpanIndex;
+	UndoStack mUndoStack;
+
 	QImage *mDisplayImage;
 	Monitor *mMonitor;
+	MotionTracker *mMotionTracker;
+	DriftAnalyzer *mDriftAnalyzer;
+	Exporter *mExporter;
+	QSharedPointer<FrameReader> mFrameReader;
+	QProgressBar *mExportProgress;
+	QPushButton *mExportCancel;
+	QString mExportUnit;	//frames or labels, whatever the running export counts
+	QHash<QString, LabelSnapshot> mExportedLabels;	//labels of the last export to every destination
+	QString mExportKey;		//destination of the running export
+	LabelSnapshot mExportLabels;	//labels of the running export
+	QString mExportXmlFile;	//SimpleLabel XML file written by the running export, it saves the labels
+	LabelMeImporter *mLabelMeImporter;
+	QProgressDialog *mImportProgress;
+	EditJournal *mJournal;	//crash-safe autosave of the edits, kept next to the video
 
 	QPoint mDrawPoint;
 	ViaPoint mDrawRect;
@@ -132,10 +190,13 @@ private:
 	QString mFileNamePrefix;
 	QString mPath;
 	QString mExtention;
+	QString mProjectFile;	//binary project the labels were last opened from or saved to
 	int mFirstFrameNumber;
 	bool mSomethingChanged;
 	QLabel mStatus_Mode;
 	
+	double mSimplifyTolerance;	//pixel tolerance of the track simplification
+
 	bool mNewPolygon;	//when set to true, we are in the process of creating new polygon
 	QPolygon mFirstPolygon;
 
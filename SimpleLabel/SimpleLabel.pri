@@ -3,16 +3,64 @@
 # ------------------------------------------------------
 
 HEADERS += ./SimpleLabel.h \
+		./SmallPolygon.h \
+		./BlockList.h \
+		./Track.h \
 		./Constants.h \
 		./Monitor.h \
 		./About.h \
-		./SaveDialog.h
+		./SaveDialog.h \
+		./BoxTrack.h \
+		./LabelSpanIndex.h \
+		./FrameReader.h \
+		./MotionTracker.h \
+		./GrayImage.h \
+		./DriftAnalyzer.h \
+		./TrackSimplifier.h \
+		./UndoStack.h \
+		./LabelStore.h \
+		./Exporter.h \
+		./DomStreamWriter.h \
+		./LabelXmlReader.h \
+		./LabelMeImporter.h \
+		./BoundedQueue.h \
+		./LabelMask.h \
+		./NpzWriter.h \
+		./MatWriter.h \
+		./Crc32.h \
+		./LittleEndian.h \
+		./FileSync.h \
+		./ProjectFile.h \
+		./EditJournal.h \
+		./FrameRangeSet.h \
+		./TarWriter.h
 
 SOURCES += ./main.cpp \
 		./SimpleLabel.cpp \
 		./Monitor.cpp \
 		./About.cpp \
-		./SaveDialog.cpp
+		./SaveDialog.cpp \
+		./BoxTrack.cpp \
+		./LabelSpanIndex.cpp \
+		./FrameReader.cpp \
+		./MotionTracker.cpp \
+		./GrayImage.cpp \
+		./DriftAnalyzer.cpp \
+		./TrackSimplifier.cpp \
+		./UndoStack.cpp \
+		./LabelStore.cpp \
+		./Exporter.cpp \
+		./DomStreamWriter.cpp \
+		./LabelXmlReader.cpp \
+		./LabelMeImporter.cpp \
+		./LabelMask.cpp \
+		./NpzWriter.cpp \
+		./MatWriter.cpp \
+		./FileSync.cpp \
+		./ProjectFile.cpp \
+		./EditJournal.cpp \
+		./FrameRangeSet.cpp \
+		./TarWriter.cpp
 
 FORMS += ./SimpleLabel.ui \
 		./AboutDlg.ui \
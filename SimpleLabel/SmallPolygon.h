@@ -0,0 +1,185 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef SMALLPOLYGON_H
+#define SMALLPOLYGON_H
+
+#include <QVector>
+#include <QPolygon>
+#include <QPoint>
+#include <QRect>
+
+//number of vertices stored inside the polygon itself
+#define SMALL_POLYGON_SIZE	12
+
+//Polygon with inline storage for up to SMALL_POLYGON_SIZE vertices. Polygon
+//tracks keep one polygon per frame, with QPolygon each of them would live in
+//its own heap buffer; here the vertices are stored next to the rest of the
+//via point and only larger polygons spill to the heap.
+//
+//The polygon holds no pointers into itself, so it is declared movable and
+//tracks of polygons are kept in contiguous QVectors.
+class SmallPolygon
+{
+public:
+	SmallPolygon() : mCount(0) {}
+
+	SmallPolygon(const QPolygon &pl) : mCount(0)
+	{
+		resize(pl.count());
+		QPoint *p = data();
+		for(int i = 0; i < pl.count(); i++)
+		{
+			p[i] = pl.at(i);
+		}
+	}
+
+	int count() const { return mCount; }
+	bool isEmpty() const { return mCount == 0; }
+	void clear() { resize(0); }
+	void reserve(int n)
+	{
+		if(n > SMALL_POLYGON_SIZE)
+			mHeap.reserve(n);
+	}
+
+	QPoint point(int i) const { return constData()[i]; }
+	QPoint &operator[](int i) { return data()[i]; }
+	const QPoint &operator[](int i) const { return constData()[i]; }
+	//vertices past SMALL_POLYGON_SIZE are kept in mHeap
+	const QPoint *constData() const { return mCount > SMALL_POLYGON_SIZE ? mHeap.constData() : mInline; }
+
+	SmallPolygon &operator<<(const QPoint &p)
+	{
+		resize(mCount + 1);
+		data()[mCount - 1] = p;
+		return *this;
+	}
+
+	void insert(int i, const QPoint &p)
+	{
+		resize(mCount + 1);
+		QPoint *d = data();
+		for(int k = mCount - 1; k > i; k--)
+		{
+			d[k] = d[k - 1];
+		}
+		d[i] = p;
+	}
+
+	void remove(int i)
+	{
+		QPoint *d = data();
+		for(int k = i; k < mCount - 1; k++)
+		{
+			d[k] = d[k + 1];
+		}
+		resize(mCount - 1);
+	}
+
+	QRect boundingRect() const
+	{
+		if(mCount == 0)
+			return QRect();
+
+		const QPoint *d = constData();
+		int left = d[0].x(), right = left;
+		int top = d[0].y(), bottom = top;
+		for(int i = 1; i < mCount; i++)
+		{
+			left = qMin(left, d[i].x());
+			right = qMax(right, d[i].x());
+			top = qMin(top, d[i].y());
+			bottom = qMax(bottom, d[i].y());
+		}
+		return QRect(QPoint(left, top), QPoint(right, bottom));
+	}
+
+	QPolygon toPolygon() const
+	{
+		QPolygon res(mCount);
+		const QPoint *d = constData();
+		for(int i = 0; i < mCount; i++)
+		{
+			res[i] = d[i];
+		}
+		return res;
+	}
+
+	bool operator==(const SmallPolygon &b) const
+	{
+		if(mCount != b.mCount)
+			return false;
+		const QPoint *d1 = constData();
+		const QPoint *d2 = b.constData();
+		for(int i = 0; i < mCount; i++)
+		{
+			if(d1[i] != d2[i])
+				return false;
+		}
+		return true;
+	}
+
+	bool operator!=(const SmallPolygon &b) const
+	{
+		return !(*this == b);
+	}
+
+private:
+	QPoint *data() { return mCount > SMALL_POLYGON_SIZE ? mHeap.data() : mInline; }
+
+	//moves the vertices between the inline and the heap storage when the
+	//count crosses SMALL_POLYGON_SIZE
+	void resize(int n)
+	{
+		if(n > SMALL_POLYGON_SIZE && mCount <= SMALL_POLYGON_SIZE)
+		{
+			mHeap.resize(n);
+			for(int i = 0; i < mCount; i++)
+			{
+				mHeap[i] = mInline[i];
+			}
+		}
+		else if(n > SMALL_POLYGON_SIZE)
+		{
+			mHeap.resize(n);
+		}
+		else if(mCount > SMALL_POLYGON_SIZE)
+		{
+			for(int i = 0; i < n; i++)
+			{
+				mInline[i] = mHeap.at(i);
+			}
+			mHeap.clear();
+		}
+		mCount = n;
+	}
+
+	int mCount;
+	QPoint mInline[SMALL_POLYGON_SIZE];
+	QVector<QPoint> mHeap;
+};
+
+Q_DECLARE_TYPEINFO(SmallPolygon, Q_MOVABLE_TYPE);
+
+#endif
@@ -0,0 +1,241 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "TarWriter.h"
+#include "FileSync.h"
+#include <QDateTime>
+#include <QTextStream>
+#include <QStringList>
+#include <string.h>
+
+//bytes of padding after data of the given size up to the next block
+static int padding(qint64 size)
+{
+	return (int)((TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE);
+}
+
+//octal number of len - 1 digits followed by a NUL, as the ustar fields are
+static void putOctal(char *field, int len, qint64 v)
+{
+	QByteArray digits = QByteArray::number(v, 8).rightJustified(len - 1, '0');
+	memcpy(field, digits.constData(), len - 1);
+	field[len - 1] = 0;
+}
+
+TarWriter::TarWriter()
+	: mEnd(0), mTime(0), mAppending(false)
+{
+}
+
+TarWriter::~TarWriter()
+{
+	mFile.close();
+}
+
+bool TarWriter::open(const QString &file, bool append)
+{
+	mFile.close();
+	mIndex.clear();
+	mBuffer.clear();
+	mEnd = 0;
+	mAppending = false;
+	mError = "";
+	mTime = QDateTime::currentDateTime().toTime_t();
+	mFile.setFileName(file);
+
+	if(append && readIndex(file))
+	{
+		//the new entries overwrite the end of the archive
+		if(mFile.open(QIODevice::ReadWrite) && mFile.size() >= mEnd && mFile.resize(mEnd) && mFile.seek(mEnd))
+		{
+			mAppending = true;
+			return true;
+		}
+		mFile.close();
+		mIndex.clear();
+		mEnd = 0;
+	}
+
+	if(!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		mError = mFile.errorString();
+		return false;
+	}
+	//an old index would point into the new archive
+	QFile::remove(indexFile(file));
+	return true;
+}
+
+bool TarWriter::readIndex(const QString &file)
+{
+	QFile idx(indexFile(file));
+	if(!idx.open(QIODevice::ReadOnly | QIODevice::Text))
+		return false;
+
+	QTextStream in(&idx);
+	in.setCodec("UTF-8");
+	while(!in.atEnd())
+	{
+		QString line = in.readLine();
+		if(line.isEmpty())
+			continue;
+
+		QStringList parts = line.split(' ');
+		bool okOffset, okSize;
+		Entry e;
+		e.offset = parts.value(0).toLongLong(&okOffset);
+		e.size = parts.value(1).toLongLong(&okSize);
+		if(parts.count() < 3 || !okOffset || !okSize || e.offset < TAR_BLOCK_SIZE || e.offset % TAR_BLOCK_SIZE != 0 || e.size < 0)
+		{
+			mIndex.clear();
+			mEnd = 0;
+			return false;
+		}
+		//names may contain spaces
+		QString name = line.section(' ', 2);
+		mIndex.insert(name, e);
+		mEnd = qMax(mEnd, e.offset + e.size + padding(e.size));
+	}
+	return true;
+}
+
+QByteArray TarWriter::header(const QByteArray &name, qint64 size) const
+{
+	QByteArray h(TAR_BLOCK_SIZE, 0);
+	char *p = h.data();
+	memcpy(p, name.constData(), name.size());
+	putOctal(p + 100, 8, 0644);		//mode
+	putOctal(p + 108, 8, 0);		//uid
+	putOctal(p + 116, 8, 0);		//gid
+	putOctal(p + 124, 12, size);
+	putOctal(p + 136, 12, mTime);
+	p[156] = '0';					//regular file
+	memcpy(p + 257, "ustar", 6);
+	memcpy(p + 263, "00", 2);
+
+	//the checksum is computed with the checksum field set to spaces
+	memset(p + 148, ' ', 8);
+	uint sum = 0;
+	for(int i = 0; i < TAR_BLOCK_SIZE; i++)
+	{
+		sum += (uchar)p[i];
+	}
+	putOctal(p + 148, 7, sum);
+	return h;
+}
+
+bool TarWriter::addFile(const QString &name, const QByteArray &data)
+{
+	QByteArray n = name.toUtf8();
+	QMutexLocker lock(&mMutex);
+	if(!mFile.isOpen())
+		return false;
+	if(n.size() > TAR_NAME_SIZE)
+	{
+		mError = "The name " + name + " is too long for the archive.";
+		return false;
+	}
+
+	Entry e;
+	e.offset = mEnd + mBuffer.size() + TAR_BLOCK_SIZE;
+	e.size = data.size();
+	mBuffer.append(header(n, data.size()));
+	mBuffer.append(data);
+	mBuffer.append(QByteArray(padding(data.size()), 0));
+	mIndex.insert(name, e);
+
+	if(mBuffer.size() >= TAR_WRITE_BUFFER)
+		return flush();
+	return true;
+}
+
+//the mutex is locked
+bool TarWriter::flush()
+{
+	if(mFile.write(mBuffer) != mBuffer.size())
+	{
+		mError = mFile.errorString();
+		return false;
+	}
+	mEnd += mBuffer.size();
+	mBuffer.clear();
+	return true;
+}
+
+bool TarWriter::finish()
+{
+	QMutexLocker lock(&mMutex);
+	if(!mFile.isOpen())
+		return false;
+
+	//two zero blocks end the archive
+	mBuffer.append(QByteArray(2*TAR_BLOCK_SIZE, 0));
+	//the archive is on the disk before the index lists its entries
+	bool ok = flush();
+	if(ok && !FileSync::sync(mFile))
+	{
+		mError = mFile.errorString();
+		ok = false;
+	}
+	mFile.close();
+	if(!ok)
+		return false;
+
+	//the index is replaced at once, so it never lists entries that aren't written
+	QString file = indexFile(mFile.fileName());
+	QFile idx(file + ".tmp");
+	if(!idx.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+	{
+		mError = idx.errorString();
+		return false;
+	}
+	QTextStream out(&idx);
+	out.setCodec("UTF-8");
+	for(QMap<QString, Entry>::const_iterator it = mIndex.constBegin(); it != mIndex.constEnd(); ++it)
+	{
+		out << it.value().offset << " " << it.value().size << " " << it.key() << "\n";
+	}
+	out.flush();
+	bool synced = out.status() == QTextStream::Ok && FileSync::sync(idx);
+	idx.close();
+	if(!synced || idx.error() != QFile::NoError)
+	{
+		mError = idx.errorString();
+		idx.remove();
+		return false;
+	}
+
+	//a crash leaves either the old or the new index, never none
+	if(!FileSync::replace(idx.fileName(), file))
+	{
+		mError = "Failed to replace " + file;
+		return false;
+	}
+	return true;
+}
+
+QString TarWriter::errorString() const
+{
+	QMutexLocker lock(&mMutex);
+	return mError;
+}
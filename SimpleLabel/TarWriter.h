@@ -0,0 +1,89 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef TARWRITER_H
+#define TARWRITER_H
+
+#include <QFile>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QByteArray>
+
+#define TAR_BLOCK_SIZE		512
+//names longer than this don't fit into the ustar header
+#define TAR_NAME_SIZE		100
+//entries are collected into writes of at least this size
+#define TAR_WRITE_BUFFER	(4*1024*1024)
+
+//Writes many small files into one uncompressed ustar archive with large
+//sequential writes, so per frame exports don't create a file per frame. The
+//offset and size of every entry are listed in a text index next to the
+//archive, one "offset size name" line per entry, so a frame can be read
+//without scanning the archive.
+//
+//An archive can be reopened to append entries. An entry added again under the
+//same name is appended as well, tar extracts the later one and the index
+//points to it.
+class TarWriter
+{
+public:
+	TarWriter();
+	~TarWriter();
+
+	//Append keeps the entries of an existing archive, it starts a new one if
+	//the archive or its index is missing or they don't match.
+	bool open(const QString &file, bool append);
+	bool isOpen() const { return mFile.isOpen(); }
+	bool isAppending() const { return mAppending; }
+	//can be called from several threads
+	bool addFile(const QString &name, const QByteArray &data);
+	//writes the end of the archive and the index
+	bool finish();
+
+	QString errorString() const;
+	int entryCount() const { return mIndex.count(); }
+	static QString indexFile(const QString &archive) { return archive + ".idx"; }
+
+private:
+	struct Entry
+	{
+		qint64 offset;	//of the data, the header is the block before it
+		qint64 size;
+	};
+
+	bool readIndex(const QString &file);
+	bool flush();
+	QByteArray header(const QByteArray &name, qint64 size) const;
+
+	mutable QMutex mMutex;
+	QFile mFile;
+	QByteArray mBuffer;
+	qint64 mEnd;		//archive offset where the buffer starts
+	uint mTime;
+	bool mAppending;
+	QMap<QString, Entry> mIndex;
+	QString mError;
+};
+
+#endif
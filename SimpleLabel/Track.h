@@ -0,0 +1,257 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef TRACK_H
+#define TRACK_H
+
+#include <QList>
+#include <QVector>
+#include "Constants.h"
+#include "BoxTrack.h"
+#include "BlockList.h"
+
+enum ViaPointSeek
+{
+	SeekFirst,
+	SeekPrevious,
+	SeekNext,
+	SeekLast
+};
+
+//Shape policies tell a track which lists of the label hold the via points and
+//the per-frame shapes.
+struct RectShape
+{
+	typedef ViaPoint Point;
+	typedef QList<ViaPoint> List;
+	typedef BlockList<ViaPoint> Frames;
+
+	static QList<ViaPoint> &viaPoints(Label &lb) { return lb.viaPoints; }
+	static BlockList<ViaPoint> &frames(Label &lb) { return lb.boxes; }
+};
+
+struct PolygonShape
+{
+	typedef ViaPointPolygon Point;
+	typedef QVector<ViaPointPolygon> List;
+	typedef BlockList<ViaPointPolygon> Frames;
+
+	static QVector<ViaPointPolygon> &viaPoints(Label &lb) { return lb.viaPointsPoly; }
+	static BlockList<ViaPointPolygon> &frames(Label &lb) { return lb.polygons; }
+};
+
+//Interpolation policies fill the block of a segment with the shapes of the
+//frames from b1 up to, but not including, b2.
+template<class Shape>
+struct LinearInterpolation;
+
+template<>
+struct LinearInterpolation<RectShape>
+{
+	static void interpolate(const ViaPoint &b1, const ViaPoint &b2, QVector<ViaPoint> &out)
+	{
+		BoxTrack seg;
+		seg.interpolate(b1, b2);
+		seg.appendTo(out, seg.count() - 1);
+	}
+};
+
+template<>
+struct LinearInterpolation<PolygonShape>
+{
+	static void interpolate(const ViaPointPolygon &b1, const ViaPointPolygon &b2, QVector<ViaPointPolygon> &out)
+	{
+		int n = b2.frame - b1.frame;
+		int nv = qMin(b1.pl.count(), b2.pl.count());
+		ViaPointPolygon p;
+		out.reserve(out.count() + n);
+		for(int t = 0; t < n; t++)
+		{
+			p.frame = b1.frame + t;
+			p.pl.clear();
+			for(int j = 0; j < nv; j++)
+			{
+				QPointF dp = n > 0 ? QPointF(b2.pl[j] - b1.pl[j])/n : QPointF();
+				p.pl << b1.pl[j] + (t*dp).toPoint();
+			}
+			out << p;
+		}
+	}
+};
+
+//Editing and evaluation of one shape track of a label. The shape and the
+//interpolation are template policies, so rectangles and polygons share the
+//same code without switching on the shape inside the loops.
+//
+//The lists are held by reference, which doesn't make them const in the const
+//methods. Reading goes through via() and frames() so it never detaches lists
+//that are shared with the undo history or a snapshot.
+template<class Shape, class Interpolator = LinearInterpolation<Shape> >
+class Track
+{
+public:
+	typedef typename Shape::Point Point;
+
+	Track(Label &lb) : mVia(Shape::viaPoints(lb)), mFrames(Shape::frames(lb)) {}
+
+	bool isEmpty() const { return via().isEmpty(); }
+
+	//inserts the via point in frame order, a via point in the same frame is replaced
+	void addViaPoint(const Point &p)
+	{
+		int i = indexOf(p.frame);
+		if(i < via().count() && via().at(i).frame == p.frame)
+			mVia[i] = p;
+		else
+			mVia.insert(i, p);
+	}
+
+	bool removeViaPoint(int frame)
+	{
+		if(!isViaPoint(frame))
+			return false;
+		mVia.erase(mVia.begin() + indexOf(frame));
+		return true;
+	}
+
+	bool isViaPoint(int frame) const
+	{
+		int i = indexOf(frame);
+		return i < via().count() && via().at(i).frame == frame;
+	}
+
+	//the frame is before the first or after the last via point
+	bool isOutside(int frame) const
+	{
+		const typename Shape::List &v = via();
+		return !v.isEmpty() && (frame < v.at(0).frame || frame > v.at(v.count() - 1).frame);
+	}
+
+	//shape in the given frame, NULL outside of the track
+	const Point *at(int frame) const
+	{
+		const typename Shape::List &f = frames();
+		if(f.isEmpty())
+			return NULL;
+
+		int i = frame - f.at(0).frame;
+		if(i < 0 || i >= f.count())
+			return NULL;
+		return &f.at(i);
+	}
+
+	//frame of the via point to move to from the given frame, -1 if there are no via points
+	int seek(ViaPointSeek seek, int frame) const
+	{
+		const typename Shape::List &v = via();
+		if(v.isEmpty())
+			return -1;
+
+		int i;
+		switch(seek)
+		{
+		case SeekFirst:
+			return v.at(0).frame;
+		case SeekPrevious:
+			i = v.count() - 1;
+			while(v.at(i).frame >= frame && i > 0)
+			{
+				i--;
+			}
+			return v.at(i).frame;
+		case SeekNext:
+			i = 0;
+			while(v.at(i).frame <= frame && i < v.count() - 1)
+			{
+				i++;
+			}
+			return v.at(i).frame;
+		case SeekLast:
+		default:
+			return v.at(v.count() - 1).frame;
+		}
+	}
+
+	//Recalculates the shapes of all frames from the via points. Every segment
+	//between two via points is a block of the frames and the last via point is
+	//a block of its own. Segments whose via points didn't change keep their
+	//block, so a rebuild after an edit only interpolates the segments next to
+	//the edited via point and the rest stays shared with the undo history.
+	void rebuild()
+	{
+		const typename Shape::List &v = via();
+		typename Shape::Frames old = mFrames;
+		mFrames.clear();
+		for(int i = 0; i < v.count() - 1; i++)
+		{
+			int b = findSegment(old, v.at(i), v.at(i + 1));
+			if(b >= 0)
+			{
+				mFrames.appendBlock(old.block(b));
+				continue;
+			}
+
+			QVector<Point> seg;
+			Interpolator::interpolate(v.at(i), v.at(i + 1), seg);
+			mFrames.appendBlock(seg);
+		}
+		if(!v.isEmpty())
+			mFrames.appendBlock(QVector<Point>(1, v.at(v.count() - 1)));
+	}
+
+private:
+	const typename Shape::List &via() const { return mVia; }
+	const typename Shape::Frames &frames() const { return mFrames; }
+
+	//index of the first via point at or after the frame
+	int indexOf(int frame) const
+	{
+		const typename Shape::List &v = via();
+		int i = 0;
+		while(i < v.count() && v.at(i).frame < frame)
+		{
+			i++;
+		}
+		return i;
+	}
+
+	//the block of the frames that holds exactly the segment from p1 up to p2
+	//and still ends at p2, -1 if there is none
+	static int findSegment(const typename Shape::Frames &frames, const Point &p1, const Point &p2)
+	{
+		if(frames.isEmpty())
+			return -1;
+
+		int i = p1.frame - frames.first().frame;
+		int n = p2.frame - p1.frame;
+		int b = i >= 0 ? frames.blockAt(i) : -1;
+		if(b < 0 || frames.block(b).count() != n || i + n >= frames.count())
+			return -1;
+		return frames.at(i) == p1 && frames.at(i + n) == p2 ? b : -1;
+	}
+
+	typename Shape::List &mVia;
+	typename Shape::Frames &mFrames;
+};
+
+#endif
@@ -0,0 +1,167 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "TrackSimplifier.h"
+#include "BoxTrack.h"
+#include <QVector>
+#include <QPair>
+#include <float.h>
+
+//finds the box between i and j that is reproduced worst by interpolating between them
+static int worstBox(const QList<ViaPoint> &track, int i, int j, double &err)
+{
+	//interpolated exactly the way the label boxes are rebuilt
+	BoxTrack seg;
+	seg.interpolate(track[i], track[j]);
+
+	int worst = i + 1;
+	err = 0.0;
+	for(int k = i + 1; k < j; k++)
+	{
+		double e = TrackSimplifier::boxError(seg.at(track[k].frame - track[i].frame), track[k]);
+		if(e > err)
+		{
+			err = e;
+			worst = k;
+		}
+	}
+	return worst;
+}
+
+static int worstPolygon(const QVector<ViaPointPolygon> &track, int i, int j, double &err)
+{
+	const ViaPointPolygon &p1 = track[i];
+	const ViaPointPolygon &p2 = track[j];
+	double df = p2.frame - p1.frame;
+
+	//only polygons with the same number of vertices can be interpolated, so
+	//the span is split where the number of vertices changes
+	for(int k = i + 1; k < j; k++)
+	{
+		if(track[k].pl.count() != p1.pl.count())
+		{
+			err = DBL_MAX;
+			return k;
+		}
+	}
+	if(p2.pl.count() != p1.pl.count())
+	{
+		err = DBL_MAX;
+		return j - 1;
+	}
+
+	int worst = i + 1;
+	err = 0.0;
+	for(int k = i + 1; k < j; k++)
+	{
+		const ViaPointPolygon &p = track[k];
+		int t = p.frame - p1.frame;
+		for(int v = 0; v < p.pl.count(); v++)
+		{
+			QPointF dp = QPointF(p2.pl.point(v) - p1.pl.point(v))/df;
+			QPoint d = p1.pl.point(v) + (t*dp).toPoint() - p.pl.point(v);
+			double e = qMax(qAbs(d.x()), qAbs(d.y()));
+			if(e > err)
+			{
+				err = e;
+				worst = k;
+			}
+		}
+	}
+	return worst;
+}
+
+template<class List>
+static List douglasPeucker(const List &track, double tolerance, int (*worst)(const List&, int, int, double&))
+{
+	if(track.count() < 3)
+		return track;
+
+	QVector<bool> keep(track.count(), false);
+	keep[0] = true;
+	keep[track.count() - 1] = true;
+	for(int k = 1; k < track.count(); k++)
+	{
+		if(track[k].frame - track[k - 1].frame != 1)
+		{
+			keep[k - 1] = true;
+			keep[k] = true;
+		}
+	}
+
+	//explicit stack, long tracks would recurse too deep
+	QVector<QPair<int, int> > spans;
+	int last = 0;
+	for(int k = 1; k < track.count(); k++)
+	{
+		if(keep[k])
+		{
+			spans << qMakePair(last, k);
+			last = k;
+		}
+	}
+
+	while(!spans.isEmpty())
+	{
+		QPair<int, int> s = spans.last();
+		spans.pop_back();
+		if(s.second - s.first < 2)
+			continue;
+
+		double err;
+		int k = worst(track, s.first, s.second, err);
+		if(err > tolerance)
+		{
+			keep[k] = true;
+			spans << qMakePair(s.first, k) << qMakePair(k, s.second);
+		}
+	}
+
+	List res;
+	for(int k = 0; k < track.count(); k++)
+	{
+		if(keep[k])
+			res << track[k];
+	}
+	return res;
+}
+
+QList<ViaPoint> TrackSimplifier::simplify(const QList<ViaPoint> &track, double tolerance)
+{
+	return douglasPeucker(track, tolerance, worstBox);
+}
+
+QVector<ViaPointPolygon> TrackSimplifier::simplify(const QVector<ViaPointPolygon> &track, double tolerance)
+{
+	return douglasPeucker(track, tolerance, worstPolygon);
+}
+
+double TrackSimplifier::boxError(const ViaPoint &a, const ViaPoint &b)
+{
+	double err = qMax(qMax(qAbs(a.rc.left() - b.rc.left()), qAbs(a.rc.top() - b.rc.top())),
+		qMax(qAbs(a.rc.right() - b.rc.right()), qAbs(a.rc.bottom() - b.rc.bottom())));
+
+	//rotation moves the corners along a circle around the box centre
+	double r = sqrt((double)sqr(b.rc.width()) + sqr(b.rc.height()))/2;
+	return err + r*qAbs(a.angle - b.angle)*M_PI/180;
+}
@@ -0,0 +1,50 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef TRACKSIMPLIFIER_H
+#define TRACKSIMPLIFIER_H
+
+#include <QList>
+#include <QVector>
+#include "Constants.h"
+
+//default tolerance of the track simplification, in display image pixels
+#define SIMPLIFY_TOLERANCE	1.0
+
+//Douglas-Peucker style reduction of dense tracks to a small set of via points.
+//A span of the track is replaced by its end points when the linear interpolation
+//between them reproduces every box (polygon) of the span within the tolerance,
+//otherwise the span is split at the worst frame and both halves are checked
+//again. Frame gaps in the track are never bridged, the boxes on both sides of a
+//gap are always kept.
+class TrackSimplifier
+{
+public:
+	static QList<ViaPoint> simplify(const QList<ViaPoint> &track, double tolerance);
+	static QVector<ViaPointPolygon> simplify(const QVector<ViaPointPolygon> &track, double tolerance);
+
+	//largest distance between corresponding corners of the two boxes, in pixels
+	static double boxError(const ViaPoint &a, const ViaPoint &b);
+};
+
+#endif
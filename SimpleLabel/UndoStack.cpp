@@ -0,0 +1,220 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#include "UndoStack.h"
+#include <QSet>
+
+//Memory is shared by address: the first node of a QList, the buffer of a
+//QVector and every block of a BlockList. Reading only uses const access, so
+//an address is only new if the data was really copied.
+static void addData(QSet<const void*> &set, const QList<ViaPoint> &l)
+{
+	if(!l.isEmpty())
+		set.insert(&l.at(0));
+}
+
+static void addData(QSet<const void*> &set, const QVector<ViaPointPolygon> &l)
+{
+	if(!l.isEmpty())
+		set.insert(l.constData());
+}
+
+template<class T>
+static void addData(QSet<const void*> &set, const BlockList<T> &l)
+{
+	for(int b = 0; b < l.blockCount(); b++)
+	{
+		set.insert(l.block(b).constData());
+	}
+}
+
+static qint64 unsharedData(const QSet<const void*> &set, const QList<ViaPoint> &l)
+{
+	if(l.isEmpty() || set.contains(&l.at(0)))
+		return 0;
+	//QList keeps the large elements in separately allocated nodes
+	return (qint64)l.count()*(sizeof(ViaPoint) + sizeof(void*));
+}
+
+static qint64 unsharedData(const QSet<const void*> &set, const QVector<ViaPointPolygon> &l)
+{
+	if(l.isEmpty() || set.contains(l.constData()))
+		return 0;
+	return (qint64)l.count()*sizeof(ViaPointPolygon);
+}
+
+//only the blocks that aren't shared with the other labels count
+template<class T>
+static qint64 unsharedData(const QSet<const void*> &set, const BlockList<T> &l)
+{
+	qint64 bytes = 0;
+	for(int b = 0; b < l.blockCount(); b++)
+	{
+		if(!set.contains(l.block(b).constData()))
+			bytes += (qint64)l.block(b).count()*sizeof(T);
+	}
+	return bytes;
+}
+
+UndoStack::UndoStack()
+{
+	mLimit = UNDO_MEMORY_LIMIT;
+	reset(QList<Label>());
+}
+
+void UndoStack::reset(const QList<Label> &labels)
+{
+	Step st;
+	st.labels = labels;
+	st.bytes = 0;
+
+	mSteps.clear();
+	mSteps << st;
+	mCurrent = 0;
+	mUsage = 0;
+}
+
+bool UndoStack::commit(const QString &text, const QList<Label> &labels)
+{
+	if(changedRows(mSteps[mCurrent].labels, labels).isEmpty())
+		return false;
+
+	while(mSteps.count() > mCurrent + 1)
+	{
+		mUsage -= mSteps.last().bytes;
+		mSteps.removeLast();
+	}
+
+	Step st;
+	st.text = text;
+	st.labels = labels;
+	st.bytes = 0;
+	mSteps << st;
+	mCurrent++;
+	updateBytes(mCurrent);
+	trim();
+	return true;
+}
+
+void UndoStack::amend(const QList<Label> &labels)
+{
+	mSteps[mCurrent].labels = labels;
+	updateBytes(mCurrent);
+	updateBytes(mCurrent + 1);
+	trim();
+}
+
+QString UndoStack::undoText() const
+{
+	return canUndo() ? mSteps[mCurrent].text : QString();
+}
+
+QString UndoStack::redoText() const
+{
+	return canRedo() ? mSteps[mCurrent + 1].text : QString();
+}
+
+const QList<Label> &UndoStack::undo()
+{
+	if(canUndo())
+		mCurrent--;
+	return mSteps[mCurrent].labels;
+}
+
+const QList<Label> &UndoStack::redo()
+{
+	if(canRedo())
+		mCurrent++;
+	return mSteps[mCurrent].labels;
+}
+
+void UndoStack::setMemoryLimit(qint64 bytes)
+{
+	mLimit = bytes;
+	trim();
+}
+
+QList<int> UndoStack::changedRows(const QList<Label> &a, const QList<Label> &b)
+{
+	QList<int> rows;
+	bool all = a.count() != b.count();
+	for(int i = 0; i < b.count(); i++)
+	{
+		if(all || a.at(i) != b.at(i))
+			rows << i;
+	}
+	return rows;
+}
+
+qint64 UndoStack::unsharedBytes(const QList<Label> &a, const QList<Label> &b)
+{
+	//rows may have moved, so the shared data is looked up by address
+	QSet<const void*> shared;
+	for(int i = 0; i < a.count(); i++)
+	{
+		const Label &lb = a.at(i);
+		addData(shared, lb.viaPoints);
+		addData(shared, lb.boxes);
+		addData(shared, lb.viaPointsPoly);
+		addData(shared, lb.polygons);
+	}
+
+	qint64 bytes = 0;
+	for(int i = 0; i < b.count(); i++)
+	{
+		const Label &lb = b.at(i);
+		bytes += unsharedData(shared, lb.viaPoints);
+		bytes += unsharedData(shared, lb.boxes);
+		bytes += unsharedData(shared, lb.viaPointsPoly);
+		bytes += unsharedData(shared, lb.polygons);
+	}
+	return bytes;
+}
+
+void UndoStack::updateBytes(int i)
+{
+	if(i <= 0 || i >= mSteps.count())
+		return;
+
+	mUsage -= mSteps[i].bytes;
+	mSteps[i].bytes = unsharedBytes(mSteps[i - 1].labels, mSteps[i].labels);
+	mUsage += mSteps[i].bytes;
+}
+
+//drops the oldest steps first, then the redo steps furthest away
+void UndoStack::trim()
+{
+	while(mUsage > mLimit && mCurrent > 0)
+	{
+		mSteps.removeFirst();
+		mCurrent--;
+		mUsage -= mSteps.first().bytes;
+		mSteps.first().bytes = 0;
+	}
+
+	while(mUsage > mLimit && canRedo())
+	{
+		mUsage -= mSteps.last().bytes;
+		mSteps.removeLast();
+	}
+}
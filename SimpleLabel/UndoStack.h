@@ -0,0 +1,92 @@
+/*	SimpleLabel - a simple and light program for semi automatic labeling of regions
+	of interest on images or image sequences. 
+	Developed at Laboratory for Active and Attentive Vision, York University, Toronto.
+	http://www.cse.yorku.ca/LAAV/home/ headed by John K. Tsotsos.
+
+    Copyright (C) 2010  Eugene Simine.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	Contact: 	Eugene Simine <eugene@cse.yorku.ca> or
+				John K. Tsotsos <tsotsos@cse.yorku.ca>
+*/
+#ifndef UNDOSTACK_H
+#define UNDOSTACK_H
+
+#include <QList>
+#include <QString>
+#include "Constants.h"
+
+//default memory limit of the undo history in bytes
+#define UNDO_MEMORY_LIMIT (64*1024*1024)
+
+//Undo history of the label list. Every step holds a whole label list, but Qt
+//containers are implicitly shared and the dense tracks are kept in blocks, one
+//per segment between two via points. A step shares everything it didn't touch
+//with its neighbours and with the live labels, so it only costs the via point
+//lists and the segment blocks that changed in it, and restoring it only
+//touches the changed rows. When the history grows over the memory limit the
+//oldest steps are dropped.
+class UndoStack
+{
+public:
+	UndoStack();
+
+	//forgets the history, the labels become the only step
+	void reset(const QList<Label> &labels);
+	//Adds the labels as a new step after the current one and drops the redo
+	//steps. Returns false and adds nothing if the labels didn't change.
+	bool commit(const QString &text, const QList<Label> &labels);
+	//replaces the labels of the current step without adding a new one
+	void amend(const QList<Label> &labels);
+
+	bool canUndo() const { return mCurrent > 0; }
+	bool canRedo() const { return mCurrent < mSteps.count() - 1; }
+	QString undoText() const;
+	QString redoText() const;
+
+	//moves to the previous or next step and returns its labels
+	const QList<Label> &undo();
+	const QList<Label> &redo();
+
+	int count() const { return mSteps.count(); }
+	void setMemoryLimit(qint64 bytes);
+	qint64 memoryLimit() const { return mLimit; }
+	//estimated size of the track data held only by the history
+	qint64 memoryUsage() const { return mUsage; }
+
+	//Rows of b whose content differs from the same rows of a. When the number
+	//of labels differs every row of b is returned.
+	static QList<int> changedRows(const QList<Label> &a, const QList<Label> &b);
+	//estimated size of the track data of b that is not shared with a
+	static qint64 unsharedBytes(const QList<Label> &a, const QList<Label> &b);
+
+private:
+	struct Step
+	{
+		QString text;
+		QList<Label> labels;
+		qint64 bytes;	//track data introduced by this step
+	};
+
+	void updateBytes(int i);
+	void trim();
+
+	QList<Step> mSteps;
+	int mCurrent;
+	qint64 mLimit;
+	qint64 mUsage;
+};
+
+#endif
@@ -30,6 +30,21 @@ int main(int argc, char *argv[])
 	QApplication a(argc, argv);
 	a.setApplicationVersion(APP_VERSION);
 	SimpleLabel w;
+
+	//--codec=FOURCC and --segments=N are the save dialog defaults of the avi
+	//export, the export itself is still started from the dialog
+	QString codec;
+	int segments = 1;
+	QStringList args = a.arguments();
+	for(int i = 1; i < args.count(); i++)
+	{
+		if(args[i].startsWith("--codec="))
+			codec = args[i].mid(8);
+		else if(args[i].startsWith("--segments="))
+			segments = qMax(1, args[i].mid(11).toInt());
+	}
+	w.setVideoExportDefaults(codec, segments);
+
 	w.show();
 	return a.exec();
 }
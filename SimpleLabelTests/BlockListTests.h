@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "../SimpleLabel/BlockList.h"
+
+TEST(BlockListTests, AppendStartsNewBlocks)
+{
+	BlockList<int> list;
+	for(int i = 0; i < BLOCK_LIST_SIZE + 10; i++)
+	{
+		list << i;
+	}
+	ASSERT_EQ(BLOCK_LIST_SIZE + 10, list.count());
+	EXPECT_EQ(2, list.blockCount());
+	EXPECT_EQ(BLOCK_LIST_SIZE, list.blockStart(1));
+	EXPECT_EQ(BLOCK_LIST_SIZE + 3, list.at(BLOCK_LIST_SIZE + 3));
+	EXPECT_EQ(1, list.blockAt(BLOCK_LIST_SIZE));
+	EXPECT_EQ(-1, list.blockAt(5));
+}
+
+TEST(BlockListTests, ReplaceDetachesOnlyItsBlock)
+{
+	BlockList<int> list;
+	list.appendBlock(QVector<int>(10, 1));
+	list.appendBlock(QVector<int>(10, 2));
+	list.appendBlock(QVector<int>(10, 3));
+
+	BlockList<int> copy = list;
+	copy.replace(15, 7);
+	EXPECT_EQ(7, copy.at(15));
+	EXPECT_EQ(2, list.at(15));
+	EXPECT_EQ(list.block(0).constData(), copy.block(0).constData());
+	EXPECT_NE(list.block(1).constData(), copy.block(1).constData());
+	EXPECT_EQ(list.block(2).constData(), copy.block(2).constData());
+}
+
+TEST(BlockListTests, EqualityComparesContent)
+{
+	BlockList<int> a;
+	a.appendBlock(QVector<int>(4, 1));
+	a.appendBlock(QVector<int>(4, 2));
+
+	BlockList<int> b;
+	for(int i = 0; i < 8; i++)
+	{
+		b << (i < 4 ? 1 : 2);
+	}
+	EXPECT_TRUE(a == b);
+
+	BlockList<int> c = a;
+	EXPECT_TRUE(a == c);
+	c.replace(7, 2);
+	EXPECT_TRUE(a == c);
+	c.replace(7, 5);
+	EXPECT_TRUE(a != c);
+}
\ No newline at end of file
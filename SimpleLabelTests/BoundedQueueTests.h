@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <QThread>
+#include "../SimpleLabel/BoundedQueue.h"
+
+class QueueProducer : public QThread
+{
+public:
+	QueueProducer(BoundedQueue<int> *queue, int count) : mQueue(queue), mCount(count), mMaxCount(0) {}
+
+	void run()
+	{
+		for(int i = 0; i < mCount; i++)
+		{
+			mQueue->push(i);
+			mMaxCount = qMax(mMaxCount, mQueue->count());
+		}
+		mQueue->close();
+	}
+
+	BoundedQueue<int> *mQueue;
+	int mCount;
+	int mMaxCount;
+};
+
+TEST(BoundedQueueTests, KeepsOrderAndCapacity)
+{
+	BoundedQueue<int> queue(4);
+	QueueProducer producer(&queue, 1000);
+	producer.start();
+
+	int item, expected = 0;
+	while(queue.pop(item))
+	{
+		EXPECT_EQ(expected, item);
+		expected++;
+	}
+	producer.wait();
+
+	EXPECT_EQ(1000, expected);
+	EXPECT_LE(producer.mMaxCount, 4);
+}
+
+TEST(BoundedQueueTests, AbortDropsItems)
+{
+	BoundedQueue<int> queue(4);
+	EXPECT_TRUE(queue.push(1));
+	EXPECT_TRUE(queue.push(2));
+	queue.close();
+	EXPECT_FALSE(queue.push(3));
+
+	int item;
+	EXPECT_TRUE(queue.pop(item));
+	EXPECT_EQ(1, item);
+	queue.abort();
+	EXPECT_FALSE(queue.pop(item));
+}
\ No newline at end of file
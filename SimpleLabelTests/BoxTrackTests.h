@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+#include "../SimpleLabel/BoxTrack.h"
+
+TEST(BoxTrackTests, InterpolationKeepsEndPoints)
+{
+	ViaPoint b1(10, 0, QRect(0, 0, 10, 20));
+	ViaPoint b2(20, 30, QRect(100, 50, 30, 40));
+	BoxTrack bt;
+	bt.interpolate(b1, b2);
+
+	ASSERT_EQ(11, bt.count());
+	EXPECT_EQ(10, bt.frame[0]);
+	EXPECT_EQ(20, bt.frame[10]);
+	EXPECT_TRUE(bt.at(0) == b1);
+	EXPECT_TRUE(bt.at(10) == b2);
+	EXPECT_EQ(QRect(50, 25, 20, 30), bt.rect(5));
+}
+
+TEST(BoxTrackTests, ScaleMatchesCornerScaling)
+{
+	QList<ViaPoint> boxes;
+	boxes << ViaPoint(0, 0, QRect(10, 20, 30, 40));
+	BoxTrack bt(boxes);
+	bt.scale(100, 100, 200, 50);
+
+	EXPECT_EQ(20, bt.x[0]);
+	EXPECT_EQ(10, bt.y[0]);
+	//right = 39 -> 78, bottom = 59 -> 30 (29.5 rounded up)
+	EXPECT_EQ(78 - 20 + 1, bt.w[0]);
+	EXPECT_EQ(30 - 10 + 1, bt.h[0]);
+}
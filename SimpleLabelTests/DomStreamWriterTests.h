@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <QBuffer>
+#include <QTime>
+#include <QDomDocument>
+#include "../SimpleLabel/DomStreamWriter.h"
+
+//builds a project shaped like a SimpleLabel XML export either as a QDomDocument
+//or streamed through a DomStreamWriter
+static QByteArray writeProject(int labels, int frames, const QString &desc, bool stream)
+{
+	QByteArray data;
+	QBuffer buf(&data);
+	buf.open(QIODevice::WriteOnly);
+
+	if(stream)
+	{
+		DomStreamWriter xml(&buf);
+		xml.writeDocType("Labels");
+		xml.writeStartElement("root");
+		xml.writeStartElement("image");
+		xml.writeAttribute("name", QString("frame_00000.png"));
+		xml.writeAttribute("width", 640);
+		xml.writeAttribute("height", 480);
+		xml.writeEndElement();
+		for(int i = 0; i < labels; i++)
+		{
+			xml.writeStartElement("label");
+			xml.writeAttribute("name", QString("label %1").arg(i));
+			xml.writeAttribute("number", i);
+			xml.writeAttribute("desc", desc);
+			xml.writeAttribute("shape", 0);
+			xml.writeAttribute("interpolation", 1);
+			xml.writeStartElement("boxes");
+			for(int t = 0; t < frames; t++)
+			{
+				xml.writeStartElement("box");
+				xml.writeAttribute("frame", t);
+				xml.writeAttribute("left", i + t);
+				xml.writeAttribute("top", 2 * t);
+				xml.writeAttribute("right", i + t + 20);
+				xml.writeAttribute("bottom", 2 * t + 30);
+				xml.writeAttribute("angle", t * 0.37f);
+				xml.writeEndElement();
+			}
+			xml.writeEndElement();
+			xml.writeStartElement("pivots");
+			xml.writeEndElement();
+			xml.writeEndElement();
+		}
+		EXPECT_TRUE(xml.finish());
+	}
+	else
+	{
+		QDomDocument doc("Labels");
+		QDomElement root = doc.createElement("root");
+		doc.appendChild(root);
+		QDomElement imTag = doc.createElement("image");
+		imTag.setAttribute("name", QString("frame_00000.png"));
+		imTag.setAttribute("width", 640);
+		imTag.setAttribute("height", 480);
+		root.appendChild(imTag);
+		for(int i = 0; i < labels; i++)
+		{
+			QDomElement tag = doc.createElement("label");
+			tag.setAttribute("name", QString("label %1").arg(i));
+			tag.setAttribute("number", i);
+			tag.setAttribute("desc", desc);
+			tag.setAttribute("shape", 0);
+			tag.setAttribute("interpolation", 1);
+			QDomElement boxes = doc.createElement("boxes");
+			for(int t = 0; t < frames; t++)
+			{
+				QDomElement b = doc.createElement("box");
+				b.setAttribute("frame", t);
+				b.setAttribute("left", i + t);
+				b.setAttribute("top", 2 * t);
+				b.setAttribute("right", i + t + 20);
+				b.setAttribute("bottom", 2 * t + 30);
+				b.setAttribute("angle", t * 0.37f);
+				boxes.appendChild(b);
+			}
+			tag.appendChild(boxes);
+			tag.appendChild(doc.createElement("pivots"));
+			root.appendChild(tag);
+		}
+		QTextStream out(&buf);
+		out << doc.toString(1);
+	}
+	return data;
+}
+
+TEST(DomStreamWriterTests, MatchesQDomOutput)
+{
+	QString desc = QString::fromUtf8("a <car> & \"truck\"\n\tend]]> caf\xc3\xa9");
+	QByteArray dom = writeProject(3, 5, desc, false);
+	QByteArray streamed = writeProject(3, 5, desc, true);
+
+	EXPECT_FALSE(dom.isEmpty());
+	EXPECT_EQ(QString::fromUtf8(dom), QString::fromUtf8(streamed));
+}
+
+//the attribute order depends on the QHash of the Qt in use
+TEST(DomStreamWriterTests, AttributeOrderMatchesQDom)
+{
+	QStringList names;
+	names << "name" << "number" << "desc" << "shape" << "interpolation" << "width" << "height" << "frame"
+		<< "left" << "top" << "right" << "bottom" << "angle" << "x" << "y";
+
+	QDomDocument doc;
+	QDomElement el = doc.createElement("a");
+	doc.appendChild(el);
+	QByteArray data;
+	QBuffer buf(&data);
+	buf.open(QIODevice::WriteOnly);
+	DomStreamWriter xml(&buf);
+	xml.writeStartElement("a");
+	for(int i = 0; i < names.count(); i++)
+	{
+		el.setAttribute(names[i], i);
+		xml.writeAttribute(names[i], i);
+	}
+	EXPECT_TRUE(xml.finish());
+
+	EXPECT_EQ(doc.toString(1), QString::fromUtf8(data));
+}
+
+TEST(DomStreamWriterTests, EscapesLikeQDom)
+{
+	EXPECT_EQ(QString("&lt;a> &amp; &quot;b&quot;"), DomStreamWriter::escape("<a> & \"b\""));
+	EXPECT_EQ(QString("]]&gt;"), DomStreamWriter::escape("]]>"));
+	EXPECT_EQ(QString("&#xa;&#xd;&#x9;"), DomStreamWriter::escape("\n\r\t"));
+}
+
+TEST(DomStreamWriterTests, EmptyElements)
+{
+	QByteArray data;
+	QBuffer buf(&data);
+	buf.open(QIODevice::WriteOnly);
+	DomStreamWriter xml(&buf);
+	xml.writeStartElement("root");
+	xml.writeStartElement("a");
+	xml.writeAttribute("x", 1);
+	xml.writeEndElement();
+	xml.writeStartElement("b");
+	EXPECT_TRUE(xml.finish());
+
+	EXPECT_EQ(QByteArray("<root>\n <a x=\"1\"/>\n <b/>\n</root>\n"), data);
+}
+
+//run with --gtest_also_run_disabled_tests --gtest_output=xml to compare both
+//ways of exporting a large project, the timings are recorded as properties
+TEST(DomStreamWriterTests, DISABLED_Benchmark)
+{
+	QTime timer;
+	timer.start();
+	QByteArray dom = writeProject(200, 5000, "benchmark", false);
+	int domMs = timer.restart();
+	QByteArray streamed = writeProject(200, 5000, "benchmark", true);
+	int streamMs = timer.elapsed();
+
+	EXPECT_TRUE(dom == streamed);
+	RecordProperty("bytes", dom.size());
+	RecordProperty("QDomDocumentMs", domMs);
+	RecordProperty("DomStreamWriterMs", streamMs);
+}
\ No newline at end of file
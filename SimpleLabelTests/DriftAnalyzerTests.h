@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include "../SimpleLabel/DriftAnalyzer.h"
+#include "TestHelpers.h"
+
+//linear boxes following the square from (50, 100) to (150, 100) over ten frames
+static QList<ViaPoint> makeDriftBoxes()
+{
+	QList<ViaPoint> boxes;
+	for(int t = 0; t <= 10; t++)
+		boxes << ViaPoint(t, 0, QRect(30 + 10*t, 80, 40, 40));
+	return boxes;
+}
+
+TEST(DriftAnalyzerTests, SuggestsWorstFrameOfDriftingRun)
+{
+	//the square leaves the boxes in frames 4 to 6 and is farthest off in frame 5
+	QList<QPoint> centres;
+	for(int t = 0; t <= 10; t++)
+		centres << QPoint(50 + 10*t, 100 + (t == 5 ? 40 : (t == 4 || t == 6 ? 20 : 0)));
+
+	TestFile tmp;
+	FrameReader reader(writeSquareSequence(tmp, centres));
+	ASSERT_TRUE(reader.isValid());
+	QList<int> frames = DriftAnalyzer::analyzeSegment(&reader, reader.imageSize(), makeDriftBoxes());
+
+	ASSERT_EQ(1, frames.count());
+	EXPECT_EQ(5, frames[0]);
+}
+
+TEST(DriftAnalyzerTests, SingleDriftingFrameIsNotSuggested)
+{
+	//runs shorter than DRIFT_MIN_RUN are left alone
+	QList<QPoint> centres;
+	for(int t = 0; t <= 10; t++)
+		centres << QPoint(50 + 10*t, 100 + (t == 5 ? 40 : 0));
+
+	TestFile tmp;
+	FrameReader reader(writeSquareSequence(tmp, centres));
+	QList<int> frames = DriftAnalyzer::analyzeSegment(&reader, reader.imageSize(), makeDriftBoxes());
+
+	EXPECT_TRUE(frames.isEmpty());
+}
+
+TEST(DriftAnalyzerTests, FollowingTrackHasNoSuggestions)
+{
+	QList<QPoint> centres;
+	for(int t = 0; t <= 10; t++)
+		centres << QPoint(50 + 10*t, 100);
+
+	TestFile tmp;
+	FrameReader reader(writeSquareSequence(tmp, centres));
+	QList<int> frames = DriftAnalyzer::analyzeSegment(&reader, reader.imageSize(), makeDriftBoxes());
+
+	EXPECT_TRUE(frames.isEmpty());
+}
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <QFileInfo>
+#include "../SimpleLabel/EditJournal.h"
+#include "TestHelpers.h"
+
+TEST(EditJournalTests, ReplaysRecordedLabels)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+	QList<Label> labels;
+	bool unsaved;
+
+	EditJournal journal;
+	ASSERT_TRUE(journal.open(file, labels, unsaved));
+	EXPECT_TRUE(labels.isEmpty());
+	EXPECT_FALSE(unsaved);
+
+	labels << makeTrackLabel(1, 5) << makeTrackLabel(2, 5);
+	journal.record(labels);
+	labels[1].name = "car";
+	labels[1].intr = Motion;
+	labels[1].boxes.replace(2, ViaPoint(2, 0, QRect(5, 5, 10, 10)));
+	journal.record(labels);
+	journal.close();
+
+	QList<Label> replayed;
+	ASSERT_TRUE(EditJournal::replay(file, replayed, unsaved));
+	EXPECT_TRUE(unsaved);
+	ASSERT_EQ(2, replayed.count());
+	EXPECT_EQ(QString("car"), replayed[1].name);
+	ASSERT_EQ(5, replayed[0].boxes.count());
+	EXPECT_EQ(QRect(25, 25, 10, 10), replayed[0].boxes[2].rc);
+	//the motion tracked label keeps its dense track
+	EXPECT_EQ(QRect(5, 5, 10, 10), replayed[1].boxes[2].rc);
+}
+
+TEST(EditJournalTests, SavedLabelsAreNotUnsaved)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+	QList<Label> labels;
+	bool unsaved;
+
+	EditJournal journal;
+	ASSERT_TRUE(journal.open(file, labels, unsaved));
+	labels << makeTrackLabel(1, 5);
+	journal.record(labels);
+	journal.markSaved(labels, "labels.slp");
+	journal.close();
+
+	ASSERT_TRUE(journal.open(file, labels, unsaved));
+	EXPECT_EQ(1, labels.count());
+	EXPECT_FALSE(unsaved);
+	labels.removeLast();
+	journal.record(labels);
+	journal.close();
+
+	ASSERT_TRUE(EditJournal::replay(file, labels, unsaved));
+	EXPECT_TRUE(labels.isEmpty());
+	EXPECT_TRUE(unsaved);
+}
+
+TEST(EditJournalTests, TornRecordIsDropped)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+	QList<Label> labels;
+	bool unsaved;
+
+	EditJournal journal;
+	ASSERT_TRUE(journal.open(file, labels, unsaved));
+	labels << makeTrackLabel(1, 5);
+	journal.record(labels);
+	journal.close();
+	qint64 size = QFileInfo(file).size();
+
+	ASSERT_TRUE(journal.open(file, labels, unsaved));
+	labels << makeTrackLabel(2, 5);
+	journal.record(labels);
+	journal.close();
+
+	//a crash in the middle of the last write
+	QFile fd(file);
+	ASSERT_TRUE(fd.open(QIODevice::ReadWrite));
+	ASSERT_TRUE(fd.resize(fd.size() - 3));
+	fd.close();
+
+	ASSERT_TRUE(journal.open(file, labels, unsaved));
+	journal.close();
+	EXPECT_EQ(1, labels.count());
+	EXPECT_EQ(size, QFileInfo(file).size());
+}
+
+TEST(EditJournalTests, LargeJournalIsCompacted)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+	QList<Label> labels;
+	bool unsaved;
+
+	EditJournal journal;
+	ASSERT_TRUE(journal.open(file, labels, unsaved));
+	labels << makeTrackLabel(1, 5) << makeTrackLabel(2, 50000);
+	labels[1].intr = Motion;
+	//every version of the long tracked segment is journaled whole, reopening
+	//waits for each one to be written
+	for(int i = 0; i < 6; i++)
+	{
+		labels[1].boxes.replace(i, ViaPoint(i, 0, QRect(i, i, 10, 10)));
+		journal.record(labels);
+		journal.close();
+		QList<Label> replayed;
+		ASSERT_TRUE(journal.open(file, replayed, unsaved));
+		EXPECT_EQ(QRect(i, i, 10, 10), replayed[1].boxes[i].rc);
+	}
+	journal.close();
+
+	//six versions of the segment are larger than the compaction size
+	EXPECT_LT(QFileInfo(file).size(), JOURNAL_COMPACT_SIZE);
+	QList<Label> replayed;
+	ASSERT_TRUE(EditJournal::replay(file, replayed, unsaved));
+	ASSERT_EQ(2, replayed.count());
+	EXPECT_EQ(QRect(5, 5, 10, 10), replayed[1].boxes[5].rc);
+	EXPECT_EQ(QRect(0, 0, 10, 10), replayed[1].boxes[0].rc);
+}
+
+TEST(EditJournalTests, MovingViaPointWritesTheViaPoint)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+	QList<Label> labels;
+	bool unsaved;
+
+	EditJournal journal;
+	ASSERT_TRUE(journal.open(file, labels, unsaved));
+	labels << makeTrackLabel(1, 50000);
+	Track<RectShape>(labels[0]).addViaPoint(ViaPoint(25000, 0, QRect(5, 5, 10, 10)));
+	Track<RectShape>(labels[0]).rebuild();
+	journal.record(labels);
+	journal.close();
+	qint64 size = QFileInfo(file).size();
+
+	ASSERT_TRUE(journal.open(file, labels, unsaved));
+	Track<RectShape>(labels[0]).addViaPoint(ViaPoint(25000, 0, QRect(7, 7, 10, 10)));
+	Track<RectShape>(labels[0]).rebuild();
+	journal.record(labels);
+	journal.close();
+	EXPECT_LT(QFileInfo(file).size() - size, 100);
+
+	QList<Label> replayed;
+	ASSERT_TRUE(EditJournal::replay(file, replayed, unsaved));
+	ASSERT_EQ(1, replayed.count());
+	EXPECT_TRUE(replayed[0] == labels[0]);
+}
+
+TEST(EditJournalTests, ReplaysRowOperations)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+	QList<Label> labels;
+	bool unsaved;
+
+	EditJournal journal;
+	ASSERT_TRUE(journal.open(file, labels, unsaved));
+	labels << makeTrackLabel(1, 5) << makeTrackLabel(2, 5) << makeTrackLabel(3, 5) << makeTrackLabel(4, 5);
+	journal.record(labels);
+	labels.removeAt(1);
+	journal.record(labels);
+	labels.insert(2, makeTrackLabel(5, 8));
+	journal.record(labels);
+	labels[0].name = "car";
+	Track<RectShape>(labels[3]).removeViaPoint(4);
+	Track<RectShape>(labels[3]).rebuild();
+	journal.record(labels);
+	journal.close();
+
+	QList<Label> replayed;
+	ASSERT_TRUE(EditJournal::replay(file, replayed, unsaved));
+	ASSERT_EQ(labels.count(), replayed.count());
+	for(int i = 0; i < labels.count(); i++)
+	{
+		EXPECT_TRUE(replayed[i] == labels[i]) << i;
+	}
+	EXPECT_EQ(1, replayed[3].boxes.count());
+}
+
+TEST(EditJournalTests, EditsAfterTheSavedLabelsStayUnsaved)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+	QList<Label> labels;
+	bool unsaved;
+
+	EditJournal journal;
+	ASSERT_TRUE(journal.open(file, labels, unsaved));
+	labels << makeTrackLabel(1, 5);
+	QList<Label> exported = labels;
+	labels[0].name = "car";
+	//an export saves the labels it started with, the editor went on meanwhile
+	journal.record(labels);
+	journal.markSaved(exported, "labels.xml");
+	journal.record(labels);
+	journal.close();
+
+	QList<Label> replayed;
+	ASSERT_TRUE(EditJournal::replay(file, replayed, unsaved));
+	EXPECT_TRUE(unsaved);
+	ASSERT_EQ(1, replayed.count());
+	EXPECT_EQ(QString("car"), replayed[0].name);
+}
\ No newline at end of file
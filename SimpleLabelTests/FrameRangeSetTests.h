@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "../SimpleLabel/FrameRangeSet.h"
+#include "../SimpleLabel/Track.h"
+
+TEST(FrameRangeSetTests, MergesTouchingRuns)
+{
+	FrameRangeSet set;
+	set.add(10, 20);
+	set.add(30, 40);
+	EXPECT_EQ(2, set.runCount());
+	set.add(21, 29);
+	EXPECT_EQ(1, set.runCount());
+	set.add(5, 12);
+	set.add(50, 50);
+	EXPECT_EQ(2, set.runCount());
+	EXPECT_EQ(37, set.frameCount());
+
+	EXPECT_FALSE(set.contains(4));
+	EXPECT_TRUE(set.contains(5));
+	EXPECT_TRUE(set.contains(40));
+	EXPECT_FALSE(set.contains(41));
+	EXPECT_EQ(40, set.runEnd(25));
+	EXPECT_EQ(-1, set.runEnd(45));
+	EXPECT_EQ(25, set.nextFrame(25));
+	EXPECT_EQ(50, set.nextFrame(41));
+	EXPECT_EQ(INT_MAX, set.nextFrame(51));
+}
+
+TEST(FrameRangeSetTests, IntersectsWithRange)
+{
+	FrameRangeSet set;
+	set.add(0, 10);
+	set.add(20, 30);
+	FrameRangeSet part = set.intersected(5, 25);
+	EXPECT_EQ(2, part.runCount());
+	EXPECT_EQ(12, part.frameCount());
+	EXPECT_FALSE(part.contains(4));
+	EXPECT_FALSE(part.contains(26));
+	EXPECT_TRUE(set.intersected(11, 19).isEmpty());
+}
+
+static QList<Label> makeRangeLabels()
+{
+	QList<Label> labels;
+	Label lb;
+	lb.name = "car";
+	lb.viaPoints << ViaPoint(0, 0, QRect(0, 0, 10, 10)) << ViaPoint(10, 0, QRect(0, 0, 10, 10)) << ViaPoint(20, 0, QRect(0, 0, 10, 10));
+	Track<RectShape>(lb).rebuild();
+	labels << lb;
+
+	lb.name = "person";
+	lb.viaPoints.clear();
+	lb.viaPoints << ViaPoint(30, 0, QRect(0, 0, 10, 10)) << ViaPoint(40, 0, QRect(0, 0, 10, 10));
+	Track<RectShape>(lb).rebuild();
+	labels << lb;
+	return labels;
+}
+
+TEST(FrameRangeSetTests, MovedViaPointChangesSpanBetweenNeighbours)
+{
+	QList<Label> before = makeRangeLabels();
+	QList<Label> after = before;
+	EXPECT_TRUE(FrameRangeSet::changedFrames(before, after).isEmpty());
+
+	after[0].viaPoints[1].rc = QRect(40, 0, 10, 10);
+	Track<RectShape>(after[0]).rebuild();
+	FrameRangeSet changed = FrameRangeSet::changedFrames(before, after);
+	EXPECT_EQ(1, changed.runCount());
+	EXPECT_FALSE(changed.contains(0));
+	EXPECT_TRUE(changed.contains(1));
+	EXPECT_TRUE(changed.contains(19));
+	EXPECT_FALSE(changed.contains(20));
+	EXPECT_FALSE(changed.contains(35));
+}
+
+TEST(FrameRangeSetTests, RenamedOrAddedLabelChangesAllItsFrames)
+{
+	QList<Label> before = makeRangeLabels();
+	QList<Label> after = before;
+	after[1].name = "cyclist";
+	FrameRangeSet changed = FrameRangeSet::changedFrames(before, after);
+	EXPECT_EQ(11, changed.frameCount());
+	EXPECT_TRUE(changed.contains(30));
+	EXPECT_TRUE(changed.contains(40));
+
+	after = before;
+	after.removeLast();
+	changed = FrameRangeSet::changedFrames(before, after);
+	EXPECT_EQ(11, changed.frameCount());
+	EXPECT_FALSE(changed.contains(20));
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <QPainter>
+#include "../SimpleLabel/GrayImage.h"
+
+//white square on black background
+static GrayImage makeSquareImage(int left, int top)
+{
+	QImage im(100, 100, QImage::Format_RGB32);
+	im.fill(qRgb(0, 0, 0));
+	QPainter pt(&im);
+	pt.fillRect(left, top, 20, 20, Qt::white);
+	pt.end();
+	return GrayImage(im, im.size());
+}
+
+TEST(GrayImageTests, SimilarityOfSameContentIsOne)
+{
+	GrayImage im = makeSquareImage(40, 40);
+	int a[PATCH_SIZE], b[PATCH_SIZE];
+	im.samplePatch(50, 50, 40, 40, a);
+	im.samplePatch(50, 50, 40, 40, b);
+
+	EXPECT_EQ(0, GrayImage::patchDistance(a, b));
+	EXPECT_DOUBLE_EQ(1.0, GrayImage::patchSimilarity(a, b));
+}
+
+TEST(GrayImageTests, SimilarityDropsWhenBoxMissesTarget)
+{
+	GrayImage im1 = makeSquareImage(40, 40);
+	GrayImage im2 = makeSquareImage(10, 10);
+	int a[PATCH_SIZE], b[PATCH_SIZE], c[PATCH_SIZE];
+	im1.samplePatch(50, 50, 40, 40, a);
+	//target moved and the box followed it
+	im2.samplePatch(20, 20, 40, 40, b);
+	//target moved and the box stayed
+	im2.samplePatch(50, 50, 40, 40, c);
+
+	EXPECT_DOUBLE_EQ(1.0, GrayImage::patchSimilarity(a, b));
+	EXPECT_LT(GrayImage::patchSimilarity(a, c), 0.6);
+}
+
+TEST(GrayImageTests, FlatPatchesAreSimilar)
+{
+	GrayImage im = makeSquareImage(0, 0);
+	int a[PATCH_SIZE], b[PATCH_SIZE];
+	im.samplePatch(70, 70, 20, 20, a);
+	im.samplePatch(80, 60, 10, 10, b);
+
+	EXPECT_DOUBLE_EQ(1.0, GrayImage::patchSimilarity(a, b));
+}
\ No newline at end of file
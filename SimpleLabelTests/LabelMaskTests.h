@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <QTemporaryFile>
+#include "../SimpleLabel/LabelMask.h"
+
+static int countId(const LabelMask &mask, quint16 id)
+{
+	int res = 0;
+	for(int y = 0; y < mask.height(); y++)
+	{
+		for(int x = 0; x < mask.width(); x++)
+		{
+			if(mask.at(x, y) == id)
+				res++;
+		}
+	}
+	return res;
+}
+
+TEST(LabelMaskTests, UnrotatedBoxCoversItsRectangle)
+{
+	LabelMask mask(20, 20);
+	mask.fillBox(ViaPoint(0, 0, QRect(2, 3, 10, 5)), 1.0, 1.0, 7);
+
+	EXPECT_EQ(50, countId(mask, 7));
+	EXPECT_EQ(7, mask.at(2, 3));
+	EXPECT_EQ(7, mask.at(11, 7));
+	EXPECT_EQ(0, mask.at(12, 7));
+	EXPECT_EQ(0, mask.at(11, 8));
+}
+
+TEST(LabelMaskTests, BoxIsScaledToTheMask)
+{
+	LabelMask mask(40, 40);
+	mask.fillBox(ViaPoint(0, 0, QRect(2, 3, 10, 5)), 2.0, 2.0, 1);
+
+	EXPECT_EQ(200, countId(mask, 1));
+	EXPECT_EQ(1, mask.at(4, 6));
+	EXPECT_EQ(0, mask.at(3, 6));
+}
+
+TEST(LabelMaskTests, RotatedBoxKeepsItsArea)
+{
+	LabelMask mask(40, 40);
+	mask.fillBox(ViaPoint(0, 30, QRect(10, 10, 20, 10)), 1.0, 1.0, 1);
+
+	EXPECT_NEAR(200, countId(mask, 1), 10);
+	EXPECT_EQ(1, mask.at(20, 15));
+	//corners of the unrotated box are outside
+	EXPECT_EQ(0, mask.at(10, 10));
+	EXPECT_EQ(0, mask.at(29, 19));
+}
+
+TEST(LabelMaskTests, PolygonsSharingAnEdgeDontOverlap)
+{
+	LabelMask mask(20, 20);
+	SmallPolygon a, b;
+	a << QPoint(0, 0) << QPoint(10, 0) << QPoint(0, 10);
+	b << QPoint(10, 0) << QPoint(10, 10) << QPoint(0, 10);
+	mask.fillPolygon(a, 1.0, 1.0, 1);
+	int first = countId(mask, 1);
+	mask.fillPolygon(b, 1.0, 1.0, 2);
+
+	EXPECT_EQ(first, countId(mask, 1));
+	EXPECT_EQ(100, countId(mask, 1) + countId(mask, 2));
+}
+
+TEST(LabelMaskTests, ShapesAreClippedToTheMask)
+{
+	LabelMask mask(10, 10);
+	SmallPolygon pl;
+	pl << QPoint(-5, -5) << QPoint(5, -5) << QPoint(5, 5) << QPoint(-5, 5);
+	mask.fillPolygon(pl, 1.0, 1.0, 3);
+	mask.fillBox(ViaPoint(0, 0, QRect(8, 8, 10, 10)), 1.0, 1.0, 4);
+
+	EXPECT_EQ(25, countId(mask, 3));
+	EXPECT_EQ(4, countId(mask, 4));
+}
+
+TEST(LabelMaskTests, Pgm16IsBigEndian)
+{
+	LabelMask mask(3, 2);
+	mask.fillRect(1, 1, 2, 2, 0x1234);
+
+	QTemporaryFile file;
+	ASSERT_TRUE(file.open());
+	file.close();
+	ASSERT_TRUE(mask.savePgm16(file.fileName()));
+
+	ASSERT_TRUE(file.open());
+	QByteArray data = file.readAll();
+	QByteArray header("P5\n3 2\n65535\n");
+	ASSERT_EQ(header.size() + 12, data.size());
+	EXPECT_EQ(header, data.left(header.size()));
+	EXPECT_EQ((char)0x12, data[header.size() + 8]);
+	EXPECT_EQ((char)0x34, data[header.size() + 9]);
+}
\ No newline at end of file
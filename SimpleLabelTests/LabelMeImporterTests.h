@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <QBuffer>
+#include "../SimpleLabel/LabelMeImporter.h"
+
+static LabelMeObject labelMeObject(int id, const QString &name, const QRect &box)
+{
+	LabelMeObject obj;
+	obj.id = QString::number(id);
+	obj.name = name;
+	obj.hasBox = true;
+	obj.box = box;
+	return obj;
+}
+
+TEST(LabelMeImporterTests, ParsesFrame)
+{
+	QByteArray data(
+		"<annotation>\n"
+		" <frame>7</frame>\n"
+		" <source><numberFrames>20</numberFrames></source>\n"
+		" <imagesize><rows>480</rows><columns>640</columns></imagesize>\n"
+		" <object>\n"
+		"  <bbox>\n"
+		"   <pt><x>10</x><y>20</y></pt><pt><x>30</x><y>20</y></pt>\n"
+		"   <pt><x>30</x><y>40</y></pt><pt><x>10</x><y>40</y></pt><pt><x>10</x><y>20</y></pt>\n"
+		"  </bbox>\n"
+		"  <name>car</name>\n"
+		"  <tgtID> 3 </tgtID>\n"
+		"  <polygon><pt><x>1.4</x><y>2.6</y></pt><pt><x>5</x><y>2</y></pt><pt><x>5</x><y>6</y></pt></polygon>\n"
+		" </object>\n"
+		" <object><name>no id</name><tgtID></tgtID></object>\n"
+		"</annotation>\n");
+	QBuffer buf(&data);
+	buf.open(QIODevice::ReadOnly);
+
+	LabelMeFrame frame;
+	QString error;
+	ASSERT_TRUE(LabelMeImporter::parseFrame(&buf, frame, error));
+	EXPECT_EQ(7, frame.frame);
+	EXPECT_EQ(20, frame.frameCount);
+	EXPECT_EQ(QSize(640, 480), frame.imageSize);
+	ASSERT_EQ(1, frame.objects.count());
+	EXPECT_EQ(QString("3"), frame.objects[0].id);
+	EXPECT_EQ(QString("car"), frame.objects[0].name);
+	EXPECT_TRUE(frame.objects[0].hasBox);
+	EXPECT_EQ(QRect(QPoint(10, 20), QPoint(30, 40)), frame.objects[0].box);
+	ASSERT_EQ(3, frame.objects[0].polygon.count());
+	EXPECT_EQ(QPoint(1, 3), frame.objects[0].polygon.point(0));
+}
+
+TEST(LabelMeImporterTests, MergesTracksInFileOrder)
+{
+	QVector<LabelMeFrame> frames(3);
+	for(int f = 0; f < frames.count(); f++)
+	{
+		frames[f].frame = f;
+		frames[f].parsed = true;
+	}
+	frames[0].objects << labelMeObject(5, "b", QRect(0, 0, 10, 10));
+	frames[1].objects << labelMeObject(2, "a", QRect(1, 1, 10, 10)) << labelMeObject(5, "b", QRect(2, 2, 10, 10));
+	frames[2].objects << labelMeObject(2, "a", QRect(3, 3, 10, 10));
+
+	QList<Label> labels = LabelMeImporter::merge(frames, 10);
+	ASSERT_EQ(2, labels.count());
+	EXPECT_EQ(5, labels[0].number);
+	EXPECT_EQ(2, labels[1].number);
+	ASSERT_EQ(2, labels[0].boxes.count());
+	EXPECT_EQ(1, labels[0].boxes[1].frame);
+	EXPECT_EQ(QRect(2, 2, 10, 10), labels[0].viaPoints[1].rc);
+	ASSERT_EQ(2, labels[1].boxes.count());
+	EXPECT_EQ(2, labels[1].boxes[1].frame);
+
+	//the sequence ends with the first frame at or after the frame count
+	labels = LabelMeImporter::merge(frames, 1);
+	ASSERT_EQ(2, labels.count());
+	EXPECT_EQ(1, labels[1].boxes.count());
+}
+
+TEST(LabelMeImporterTests, KeepsBoxOnlyFramesOfPolygonLabels)
+{
+	QVector<LabelMeFrame> frames(3);
+	for(int f = 0; f < frames.count(); f++)
+	{
+		frames[f].frame = f;
+		frames[f].parsed = true;
+		frames[f].objects << labelMeObject(1, "a", QRect(f, 0, 10, 10));
+	}
+	//frame 1 has only the bounding box
+	frames[0].objects[0].polygon << QPoint(0, 0) << QPoint(10, 0) << QPoint(5, 10);
+	frames[2].objects[0].polygon << QPoint(2, 0) << QPoint(12, 0) << QPoint(7, 10);
+
+	QList<Label> labels = LabelMeImporter::merge(frames, 10);
+	ASSERT_EQ(1, labels.count());
+	EXPECT_EQ(Polyg, labels[0].shape);
+	EXPECT_TRUE(labels[0].viaPoints.isEmpty());
+	ASSERT_EQ(3, labels[0].viaPointsPoly.count());
+	ASSERT_EQ(3, labels[0].polygons.count());
+	EXPECT_EQ(1, labels[0].viaPointsPoly[1].frame);
+	EXPECT_EQ(4, labels[0].viaPointsPoly[1].pl.count());
+	EXPECT_EQ(QRect(1, 0, 10, 10), labels[0].viaPointsPoly[1].boundingBox().rc);
+	EXPECT_EQ(3, labels[0].viaPointsPoly[2].pl.count());
+	EXPECT_EQ(2, labels[0].polygons[2].frame);
+}
\ No newline at end of file
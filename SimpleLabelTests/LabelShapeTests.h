@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "../SimpleLabel/Constants.h"
+
+TEST(LabelShapeTests, PolygonLabelDerivesBoundingBoxes)
+{
+	Label lb;
+	lb.shape = Polyg;
+	for(int f = 10; f < 13; f++)
+	{
+		ViaPointPolygon p;
+		p.frame = f;
+		p.pl << QPoint(f, 5) << QPoint(f + 20, 0) << QPoint(f + 10, 30);
+		lb.polygons << p;
+	}
+
+	ViaPoint box;
+	ASSERT_TRUE(lb.boxAt(11, box));
+	EXPECT_EQ(11, box.frame);
+	EXPECT_EQ(QRect(QPoint(11, 0), QPoint(31, 30)), box.rc);
+	EXPECT_FALSE(lb.boxAt(13, box));
+
+	BlockList<ViaPoint> track = lb.boxTrack();
+	ASSERT_EQ(3, track.count());
+	EXPECT_EQ(12, track.last().frame);
+	EXPECT_TRUE(lb.boxes.isEmpty());
+}
+
+TEST(LabelShapeTests, RectLabelDerivesPolygons)
+{
+	Label lb;
+	lb.boxes << ViaPoint(4, 0.0, QRect(10, 20, 11, 5));
+
+	SmallPolygon pl;
+	ASSERT_TRUE(lb.polygonAt(4, pl));
+	EXPECT_EQ(QPolygon(QRect(10, 20, 11, 5)), pl.toPolygon());
+	EXPECT_FALSE(lb.polygonAt(5, pl));
+	EXPECT_TRUE(lb.polygons.isEmpty());
+}
+
+TEST(LabelShapeTests, RotatedBoxKeepsItsCentre)
+{
+	ViaPoint v(0, 90.0, QRect(0, 0, 41, 21));
+	ViaPointPolygon p = ViaPointPolygon::fromBox(v);
+
+	ASSERT_EQ(4, p.pl.count());
+	EXPECT_EQ(v.rc.center(), p.pl.boundingRect().center());
+	//a quarter turn swaps width and height
+	EXPECT_EQ(21, p.pl.boundingRect().width());
+	EXPECT_EQ(41, p.pl.boundingRect().height());
+}
+
+//imported labels may have a dense track without via points
+TEST(LabelShapeTests, FrameRangeWithoutViaPoints)
+{
+	Label lb;
+	int first = -1, last = -1;
+	EXPECT_FALSE(lb.frameRange(first, last));
+
+	lb.boxes << ViaPoint(7, 0.0, QRect(0, 0, 5, 5)) << ViaPoint(8, 0.0, QRect(0, 0, 5, 5));
+	ASSERT_TRUE(lb.frameRange(first, last));
+	EXPECT_EQ(7, first);
+	EXPECT_EQ(8, last);
+
+	lb.viaPoints << ViaPoint(3, 0.0, QRect(0, 0, 5, 5)) << ViaPoint(12, 0.0, QRect(0, 0, 5, 5));
+	ASSERT_TRUE(lb.frameRange(first, last));
+	EXPECT_EQ(3, first);
+	EXPECT_EQ(12, last);
+}
\ No newline at end of file
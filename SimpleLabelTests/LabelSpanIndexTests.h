@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include "../SimpleLabel/LabelSpanIndex.h"
+
+static Label makeSpanLabel(int first, int last)
+{
+	Label lb;
+	lb.number = 0;
+	lb.shape = Rect;
+	for(int f = first; f <= last; f++)
+		lb.boxes << ViaPoint(f, 0, QRect(0, 0, 1, 1));
+	return lb;
+}
+
+TEST(LabelSpanIndexTests, ReturnsOnlyActiveLabelsInOrder)
+{
+	QList<Label> labels;
+	labels << makeSpanLabel(0, 10) << makeSpanLabel(5, 300) << makeSpanLabel(200, 210);
+
+	LabelSpanIndex idx;
+	idx.rebuild(labels);
+
+	EXPECT_EQ(QList<int>() << 0 << 1, idx.labelsAt(7));
+	EXPECT_EQ(QList<int>() << 1 << 2, idx.labelsAt(205));
+	EXPECT_EQ(QList<int>() << 1, idx.labelsAt(300));
+	EXPECT_TRUE(idx.labelsAt(301).isEmpty());
+}
+
+TEST(LabelSpanIndexTests, UpdateAndRemoveKeepRowsInSync)
+{
+	QList<Label> labels;
+	labels << makeSpanLabel(0, 10) << makeSpanLabel(100, 110) << makeSpanLabel(100, 120);
+
+	LabelSpanIndex idx;
+	idx.rebuild(labels);
+
+	idx.update(0, makeSpanLabel(100, 105));
+	EXPECT_EQ(QList<int>() << 0 << 1 << 2, idx.labelsAt(102));
+	EXPECT_TRUE(idx.labelsAt(5).isEmpty());
+
+	idx.removeRow(1);
+	EXPECT_EQ(QList<int>() << 0 << 1, idx.labelsAt(102));
+	EXPECT_EQ(QList<int>() << 1, idx.labelsAt(115));
+}
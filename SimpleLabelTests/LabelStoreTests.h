@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <QThread>
+#include "../SimpleLabel/LabelStore.h"
+
+TEST(LabelStoreTests, SnapshotKeepsItsVersion)
+{
+	LabelStore store;
+	QList<Label> labels;
+	Label lb;
+	lb.name = "car";
+	labels << lb;
+	EXPECT_EQ(1, store.publish(labels));
+
+	LabelSnapshot snap = store.snapshot();
+	labels[0].name = "person";
+	labels << lb;
+	EXPECT_EQ(2, store.publish(labels));
+
+	EXPECT_EQ(1, snap.version());
+	ASSERT_EQ(1, snap.count());
+	EXPECT_EQ(QString("car"), snap[0].name);
+	EXPECT_EQ(2, store.snapshot().count());
+	EXPECT_EQ(2, store.version());
+}
+
+class SnapshotReader : public QThread
+{
+public:
+	SnapshotReader(const LabelStore *store) : mStore(store), mErrors(0) {}
+
+	void run()
+	{
+		for(int i = 0; i < 2000; i++)
+		{
+			//every published list holds as many boxes in each label as there are labels
+			LabelSnapshot snap = mStore->snapshot();
+			for(int r = 0; r < snap.count(); r++)
+			{
+				if(snap[r].boxes.count() != snap.count())
+					mErrors++;
+			}
+		}
+	}
+
+	const LabelStore *mStore;
+	int mErrors;
+};
+
+TEST(LabelStoreTests, ReadersSeeConsistentVersions)
+{
+	LabelStore store;
+	SnapshotReader reader(&store);
+	reader.start();
+
+	QList<Label> labels;
+	for(int i = 0; i < 200; i++)
+	{
+		labels << Label();
+		for(int r = 0; r < labels.count(); r++)
+		{
+			labels[r].boxes.clear();
+			for(int k = 0; k < labels.count(); k++)
+			{
+				labels[r].boxes << ViaPoint(k, 0.0, QRect(k, k, 10, 10));
+			}
+		}
+		store.publish(labels);
+	}
+
+	reader.wait();
+	EXPECT_EQ(0, reader.mErrors);
+	EXPECT_EQ(200, store.version());
+}
\ No newline at end of file
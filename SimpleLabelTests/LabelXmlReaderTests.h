@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <QBuffer>
+#include "../SimpleLabel/LabelXmlReader.h"
+
+static bool readLabelXml(const char *text, LabelXmlReader &reader, const QSize &displaySize = QSize(100, 100))
+{
+	QByteArray data(text);
+	QBuffer buf(&data);
+	buf.open(QIODevice::ReadOnly);
+	return reader.read(&buf, QSize(100, 100), displaySize);
+}
+
+TEST(LabelXmlReaderTests, RegeneratesBoxesFromPivots)
+{
+	//the stored boxes are wrong on purpose, they must not be read
+	LabelXmlReader reader;
+	ASSERT_TRUE(readLabelXml(
+		"<!DOCTYPE Labels>\n<root>\n"
+		" <image width=\"200\" name=\"a.png\" height=\"200\"/>\n"
+		" <label desc=\"\" number=\"1\" shape=\"0\" interpolation=\"0\" name=\"car\">\n"
+		"  <boxes>\n"
+		"   <box right=\"9\" left=\"0\" frame=\"5\" bottom=\"9\" top=\"0\" angle=\"0\"/>\n"
+		"  </boxes>\n"
+		"  <pivots>\n"
+		"   <pivot right=\"18\" left=\"0\" frame=\"0\" bottom=\"18\" top=\"0\" angle=\"0\"/>\n"
+		"   <pivot right=\"58\" left=\"40\" frame=\"4\" bottom=\"18\" top=\"0\" angle=\"0\"/>\n"
+		"  </pivots>\n"
+		" </label>\n</root>\n", reader));
+
+	ASSERT_EQ(1, reader.labels().count());
+	const Label &lb = reader.labels()[0];
+	EXPECT_EQ(QString("car"), lb.name);
+	ASSERT_EQ(2, lb.viaPoints.count());
+	ASSERT_EQ(5, lb.boxes.count());
+	EXPECT_EQ(0, lb.boxes[0].frame);
+	EXPECT_EQ(QRect(0, 0, 10, 10), lb.boxes[0].rc);
+	EXPECT_EQ(QRect(10, 0, 10, 10), lb.boxes[2].rc);
+	EXPECT_EQ(QRect(20, 0, 10, 10), lb.viaPoints[1].rc);
+}
+
+TEST(LabelXmlReaderTests, KeepsMotionTrackedBoxes)
+{
+	LabelXmlReader reader;
+	ASSERT_TRUE(readLabelXml(
+		"<root>\n"
+		" <label number=\"1\" shape=\"0\" interpolation=\"1\" name=\"car\">\n"
+		"  <boxes>\n"
+		"   <box right=\"9\" left=\"0\" frame=\"0\" bottom=\"9\" top=\"0\"/>\n"
+		"   <box right=\"15\" left=\"6\" frame=\"1\" bottom=\"19\" top=\"10\"/>\n"
+		"   <box right=\"19\" left=\"10\" frame=\"2\" bottom=\"9\" top=\"0\"/>\n"
+		"  </boxes>\n"
+		"  <pivots>\n"
+		"   <pivot right=\"9\" left=\"0\" frame=\"0\" bottom=\"9\" top=\"0\"/>\n"
+		"   <pivot right=\"19\" left=\"10\" frame=\"2\" bottom=\"9\" top=\"0\"/>\n"
+		"  </pivots>\n"
+		" </label>\n</root>\n", reader));
+
+	const Label &lb = reader.labels()[0];
+	ASSERT_EQ(3, lb.boxes.count());
+	EXPECT_EQ(QRect(6, 10, 10, 10), lb.boxes[1].rc);
+}
+
+TEST(LabelXmlReaderTests, ReadsPolygonsWithoutPivots)
+{
+	LabelXmlReader reader;
+	ASSERT_TRUE(readLabelXml(
+		"<root>\n"
+		" <label number=\"1\" shape=\"1\" name=\"a\">\n"
+		"  <polygons>\n"
+		"   <polygon frame=\"3\">\n"
+		"    <vertex x=\"10\" y=\"20\"/>\n"
+		"    <vertex x=\"30\" y=\"40\"/>\n"
+		"   </polygon>\n"
+		"  </polygons>\n"
+		"  <polygonPivots/>\n"
+		" </label>\n"
+		" <label number=\"2\" shape=\"1\" name=\"b\">\n"
+		"  <polygonPivots>\n"
+		"   <polygonPivot frame=\"0\">\n"
+		"    <vertex x=\"10\" y=\"20\"/>\n"
+		"   </polygonPivot>\n"
+		"  </polygonPivots>\n"
+		" </label>\n</root>\n", reader, QSize(50, 50)));
+
+	ASSERT_EQ(2, reader.labels().count());
+	const Label &a = reader.labels()[0];
+	ASSERT_EQ(1, a.polygons.count());
+	EXPECT_EQ(3, a.polygons[0].frame);
+	ASSERT_EQ(2, a.polygons[0].pl.count());
+	EXPECT_EQ(QPoint(15, 20), a.polygons[0].pl.point(1));
+	const Label &b = reader.labels()[1];
+	ASSERT_EQ(1, b.polygons.count());
+	EXPECT_EQ(QPoint(5, 10), b.polygons[0].pl.point(0));
+}
+
+TEST(LabelXmlReaderTests, ReportsErrors)
+{
+	LabelXmlReader reader;
+	EXPECT_FALSE(readLabelXml("<root>\n <label name=\"a\">\n</root>\n", reader));
+	EXPECT_FALSE(reader.errorString().isEmpty());
+	EXPECT_EQ(0, reader.labels().count());
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <QBuffer>
+#include <QtEndian>
+#include "../SimpleLabel/MatWriter.h"
+
+static quint32 matU32(const QByteArray &data, int pos)
+{
+	return qFromLittleEndian<quint32>((const uchar*)data.constData() + pos);
+}
+
+TEST(MatWriterTests, HeaderIsLittleEndianVersion5)
+{
+	QBuffer buf;
+	buf.open(QIODevice::WriteOnly);
+	MatWriter mat(&buf);
+	ASSERT_TRUE(mat.writeHeader("test"));
+	QByteArray h = buf.data();
+
+	ASSERT_EQ(128, h.size());
+	EXPECT_TRUE(h.startsWith("MATLAB 5.0 MAT-file, test"));
+	EXPECT_EQ(QByteArray("\x00\x01IM", 4), h.right(4));
+}
+
+TEST(MatWriterTests, DoubleMatrixIsPadded)
+{
+	QByteArray m = MatWriter::doubleMatrix(QVector<double>() << 1 << 2 << 3, 3, 1);
+
+	EXPECT_EQ(0, m.size() % 8);
+	EXPECT_EQ(14u, matU32(m, 0));
+	EXPECT_EQ((quint32)m.size() - 8, matU32(m, 4));
+	//flags, dimensions, empty name, real part
+	EXPECT_EQ(6u, matU32(m, 16));
+	EXPECT_EQ(3u, matU32(m, 32));
+	EXPECT_EQ(1u, matU32(m, 36));
+	EXPECT_EQ(9u, matU32(m, 48));
+	EXPECT_EQ(24u, matU32(m, 52));
+}
+
+TEST(MatWriterTests, EmptyStructArrayIsEmptyMatrix)
+{
+	QByteArray s = MatWriter::structArray(QStringList() << "frame", 0, QList<QByteArray>());
+	EXPECT_EQ(MatWriter::doubleMatrix(QVector<double>(), 0, 0), s);
+}
+
+TEST(MatWriterTests, StreamedStructSizeIsPatched)
+{
+	QBuffer buf;
+	buf.open(QIODevice::ReadWrite);
+	MatWriter mat(&buf);
+	ASSERT_TRUE(mat.writeHeader("test"));
+	ASSERT_TRUE(mat.beginStructArray("lbl", QStringList() << "number" << "name", 2));
+	mat.writeValue(MatWriter::scalar(1));
+	mat.writeValue(MatWriter::charArray("car"));
+	mat.writeValue(MatWriter::scalar(2));
+	mat.writeValue(MatWriter::charArray(""));
+	ASSERT_TRUE(mat.endStructArray());
+	QByteArray data = buf.data();
+
+	EXPECT_EQ(0, data.size() % 8);
+	EXPECT_EQ(14u, matU32(data, 128));
+	EXPECT_EQ((quint32)data.size() - 136, matU32(data, 132));
+	EXPECT_EQ(data.size(), (int)buf.pos());
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include "../SimpleLabel/MotionTracker.h"
+#include "TestHelpers.h"
+
+static QRect squareBox(QPoint centre)
+{
+	return QRect(centre.x() - 20, centre.y() - 20, 40, 40);
+}
+
+TEST(MotionTrackerTests, FollowsSquareBetweenViaPoints)
+{
+	//the square moves right and dips down between the via points, which the
+	//linear interpolation misses by up to 40 pixels
+	QList<QPoint> centres;
+	for(int t = 0; t <= 10; t++)
+		centres << QPoint(50 + 10*t, 100 + 8*qMin(t, 10 - t));
+
+	TestFile tmp;
+	FrameReader reader(writeSquareSequence(tmp, centres));
+	ASSERT_TRUE(reader.isValid());
+
+	ViaPoint b1(0, 0, squareBox(centres.first()));
+	ViaPoint b2(10, 0, squareBox(centres.last()));
+	QList<ViaPoint> boxes = MotionTracker::trackSegment(&reader, reader.imageSize(), b1, b2);
+
+	ASSERT_EQ(11, boxes.count());
+	EXPECT_TRUE(boxes.first() == b1);
+	EXPECT_TRUE(boxes.last() == b2);
+	for(int t = 1; t < 10; t++)
+	{
+		EXPECT_EQ(t, boxes[t].frame);
+		EXPECT_EQ(QSize(40, 40), boxes[t].rc.size());
+		EXPECT_LE(qAbs(boxes[t].rc.center().x() - squareBox(centres[t]).center().x()), 2);
+		EXPECT_LE(qAbs(boxes[t].rc.center().y() - squareBox(centres[t]).center().y()), 2);
+	}
+}
+
+TEST(MotionTrackerTests, CancelledSegmentIsEmpty)
+{
+	QList<QPoint> centres;
+	for(int t = 0; t <= 4; t++)
+		centres << QPoint(50 + 10*t, 100);
+
+	TestFile tmp;
+	FrameReader reader(writeSquareSequence(tmp, centres));
+	QAtomicInt cancel(1);
+	QList<ViaPoint> boxes = MotionTracker::trackSegment(&reader, reader.imageSize(),
+		ViaPoint(0, 0, squareBox(centres.first())), ViaPoint(4, 0, squareBox(centres.last())), &cancel);
+
+	EXPECT_TRUE(boxes.isEmpty());
+}
\ No newline at end of file
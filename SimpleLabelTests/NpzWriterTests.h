@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <QBuffer>
+#include <QtEndian>
+#include "../SimpleLabel/NpzWriter.h"
+
+static quint32 readU32(const QByteArray &data, int pos)
+{
+	return qFromLittleEndian<quint32>((const uchar*)data.constData() + pos);
+}
+
+static quint16 readU16(const QByteArray &data, int pos)
+{
+	return qFromLittleEndian<quint16>((const uchar*)data.constData() + pos);
+}
+
+TEST(NpzWriterTests, NpyHeaderIsPaddedToAlignment)
+{
+	QByteArray h = NpzWriter::npyHeader("'<i4'", QList<int>() << 3 << 2);
+
+	EXPECT_EQ(0, h.size() % NPY_ALIGNMENT);
+	EXPECT_EQ(QByteArray("\x93NUMPY\x01\x00", 8), h.left(8));
+	EXPECT_EQ(h.size() - 10, (int)readU16(h, 8));
+	EXPECT_TRUE(h.contains("'shape': (3, 2), }"));
+	EXPECT_EQ('\n', h[h.size() - 1]);
+}
+
+TEST(NpzWriterTests, OneDimensionalShapeIsATuple)
+{
+	QByteArray h = NpzWriter::npyHeader("'<i4'", QList<int>() << 5);
+	EXPECT_TRUE(h.contains("'shape': (5,), }"));
+}
+
+TEST(NpzWriterTests, Crc32MatchesZip)
+{
+	QBuffer buf;
+	NpzWriter npz(&buf);
+	EXPECT_EQ(0xcbf43926u, npz.crc32("123456789"));
+}
+
+TEST(NpzWriterTests, ArrayDataIsStoredAligned)
+{
+	QBuffer buf;
+	buf.open(QIODevice::WriteOnly);
+	NpzWriter npz(&buf);
+	QByteArray a(12, 'a'), b(8, 'b');
+	ASSERT_TRUE(npz.addArray("first", "'<i4'", QList<int>() << 3, a));
+	ASSERT_TRUE(npz.addArray("second_array", "'<i4'", QList<int>() << 2, b));
+	ASSERT_TRUE(npz.finish());
+	QByteArray zip = buf.data();
+
+	//end of central directory
+	int end = zip.size() - 22;
+	ASSERT_EQ(0x06054b50u, readU32(zip, end));
+	EXPECT_EQ(2, readU16(zip, end + 10));
+	int dir = readU32(zip, end + 16);
+
+	//second entry of the central directory, its local header and its array data
+	int second = dir + 46 + readU16(zip, dir + 28);
+	ASSERT_EQ(0x02014b50u, readU32(zip, second));
+	int local = readU32(zip, second + 42);
+	ASSERT_EQ(0x04034b50u, readU32(zip, local));
+	int npy = local + 30 + readU16(zip, local + 26) + readU16(zip, local + 28);
+	int data = npy + 10 + readU16(zip, npy + 8);
+
+	EXPECT_EQ(0, data % NPY_ALIGNMENT);
+	EXPECT_EQ(b, zip.mid(data, b.size()));
+	EXPECT_EQ(npz.crc32(zip.mid(npy, readU32(zip, local + 18))), readU32(zip, local + 14));
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "../SimpleLabel/ProjectFile.h"
+#include "../SimpleLabel/Track.h"
+#include "TestHelpers.h"
+
+static QList<Label> makeProjectLabels()
+{
+	QList<Label> labels;
+
+	Label car;
+	car.number = 1;
+	car.name = "car";
+	car.viaPoints << ViaPoint(0, 0, QRect(0, 0, 10, 10)) << ViaPoint(4, 0, QRect(20, 0, 10, 10));
+	Track<RectShape>(car).rebuild();
+	labels << car;
+
+	Label tracked = car;
+	tracked.number = 2;
+	tracked.intr = Motion;
+	tracked.boxes.replace(2, ViaPoint(2, 0, QRect(5, 5, 10, 10)));
+	labels << tracked;
+
+	Label person;
+	person.number = 3;
+	person.name = "person";
+	person.desc = "walking";
+	person.shape = Polyg;
+	ViaPointPolygon pl;
+	pl.frame = 3;
+	pl.pl << QPoint(0, 0) << QPoint(10, 0) << QPoint(5, 8);
+	person.viaPointsPoly << pl;
+	Track<PolygonShape>(person).rebuild();
+	labels << person;
+
+	return labels;
+}
+
+TEST(ProjectFileTests, RoundTripKeepsLabels)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+	QList<Label> labels = makeProjectLabels();
+
+	ProjectFile out;
+	ASSERT_TRUE(out.save(file, labels, QSize(100, 100), QSize(200, 200)));
+	ProjectFile in;
+	ASSERT_TRUE(in.open(file, QSize(100, 100)));
+
+	ASSERT_EQ(3, in.labels().count());
+	EXPECT_EQ(QSize(200, 200), in.imageSize());
+	for(int i = 0; i < labels.count(); i++)
+	{
+		const Label &a = labels[i];
+		const Label &b = in.labels()[i];
+		EXPECT_EQ(a.number, b.number);
+		EXPECT_EQ(a.name, b.name);
+		EXPECT_EQ(a.desc, b.desc);
+		EXPECT_EQ(a.shape, b.shape);
+		EXPECT_EQ(a.intr, b.intr);
+		ASSERT_EQ(a.boxes.count(), b.boxes.count());
+		for(int k = 0; k < a.boxes.count(); k++)
+		{
+			EXPECT_EQ(a.boxes[k].rc, b.boxes[k].rc);
+		}
+		ASSERT_EQ(a.polygons.count(), b.polygons.count());
+		for(int k = 0; k < a.polygons.count(); k++)
+		{
+			EXPECT_TRUE(a.polygons[k].pl == b.polygons[k].pl);
+		}
+	}
+}
+
+TEST(ProjectFileTests, SecondSaveWritesOnlyChangedBlocks)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+	QList<Label> labels = makeProjectLabels();
+
+	ProjectFile project;
+	ASSERT_TRUE(project.save(file, labels, QSize(100, 100), QSize(100, 100)));
+	//the motion tracked label has a via point and a dense block
+	EXPECT_EQ(4, project.blocksWritten());
+
+	labels[0].viaPoints[1].rc = QRect(30, 0, 10, 10);
+	Track<RectShape>(labels[0]).rebuild();
+	ASSERT_TRUE(project.save(file, labels, QSize(100, 100), QSize(100, 100)));
+	EXPECT_EQ(1, project.blocksWritten());
+	EXPECT_EQ(3, project.blocksKept());
+
+	ProjectFile in;
+	ASSERT_TRUE(in.open(file, QSize(100, 100)));
+	EXPECT_EQ(QRect(30, 0, 10, 10), in.labels()[0].boxes[4].rc);
+	EXPECT_EQ(QRect(5, 5, 10, 10), in.labels()[1].boxes[2].rc);
+}
+
+TEST(ProjectFileTests, ScalesToOtherDisplaySize)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+
+	ProjectFile project;
+	ASSERT_TRUE(project.save(file, makeProjectLabels(), QSize(100, 100), QSize(100, 100)));
+	ASSERT_TRUE(project.open(file, QSize(200, 200)));
+	EXPECT_EQ(QRect(QPoint(40, 0), QPoint(58, 18)), project.labels()[0].viaPoints[1].rc);
+}
+
+TEST(ProjectFileTests, DamagedBlockIsRejected)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+
+	ProjectFile project;
+	ASSERT_TRUE(project.save(file, makeProjectLabels(), QSize(100, 100), QSize(100, 100)));
+
+	QFile fd(file);
+	ASSERT_TRUE(fd.open(QIODevice::ReadWrite));
+	//first payload byte of the first block
+	fd.seek(PROJECT_HEADER_SIZE + 16);
+	fd.write("\xff", 1);
+	fd.close();
+
+	EXPECT_FALSE(project.open(file, QSize(100, 100)));
+	EXPECT_FALSE(project.errorString().isEmpty());
+}
\ No newline at end of file
@@ -1,3 +1,53 @@
-HEADERS += ViaPointsTests.h
+HEADERS += TestHelpers.h \
+		ViaPointsTests.h \
+		BoxTrackTests.h \
+		LabelSpanIndexTests.h \
+		GrayImageTests.h \
+		TrackSimplifierTests.h \
+		LabelShapeTests.h \
+		SmallPolygonTests.h \
+		BlockListTests.h \
+		TrackTests.h \
+		UndoStackTests.h \
+		LabelStoreTests.h \
+		DomStreamWriterTests.h \
+		LabelXmlReaderTests.h \
+		LabelMeImporterTests.h \
+		BoundedQueueTests.h \
+		LabelMaskTests.h \
+		NpzWriterTests.h \
+		MatWriterTests.h \
+		ProjectFileTests.h \
+		EditJournalTests.h \
+		FrameRangeSetTests.h \
+		TarWriterTests.h \
+		MotionTrackerTests.h \
+		DriftAnalyzerTests.h \
+		../SimpleLabel/BlockList.h \
+		../SimpleLabel/LabelMeImporter.h \
+		../SimpleLabel/EditJournal.h \
+		../SimpleLabel/FrameReader.h \
+		../SimpleLabel/MotionTracker.h \
+		../SimpleLabel/DriftAnalyzer.h
 
-SOURCES += ./main.cpp
+SOURCES += ./main.cpp \
+		../SimpleLabel/BoxTrack.cpp \
+		../SimpleLabel/LabelSpanIndex.cpp \
+		../SimpleLabel/GrayImage.cpp \
+		../SimpleLabel/TrackSimplifier.cpp \
+		../SimpleLabel/UndoStack.cpp \
+		../SimpleLabel/LabelStore.cpp \
+		../SimpleLabel/DomStreamWriter.cpp \
+		../SimpleLabel/LabelXmlReader.cpp \
+		../SimpleLabel/LabelMeImporter.cpp \
+		../SimpleLabel/LabelMask.cpp \
+		../SimpleLabel/NpzWriter.cpp \
+		../SimpleLabel/MatWriter.cpp \
+		../SimpleLabel/FileSync.cpp \
+		../SimpleLabel/ProjectFile.cpp \
+		../SimpleLabel/EditJournal.cpp \
+		../SimpleLabel/FrameRangeSet.cpp \
+		../SimpleLabel/TarWriter.cpp \
+		../SimpleLabel/FrameReader.cpp \
+		../SimpleLabel/MotionTracker.cpp \
+		../SimpleLabel/DriftAnalyzer.cpp
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "../SimpleLabel/Constants.h"
+
+TEST(SmallPolygonTests, InsertAndRemoveKeepOrder)
+{
+	SmallPolygon pl;
+	pl << QPoint(0, 0) << QPoint(10, 0) << QPoint(10, 10);
+
+	pl.insert(1, QPoint(5, -5));
+	ASSERT_EQ(4, pl.count());
+	EXPECT_EQ(QPoint(0, 0), pl.point(0));
+	EXPECT_EQ(QPoint(5, -5), pl.point(1));
+	EXPECT_EQ(QPoint(10, 10), pl.point(3));
+
+	pl.remove(0);
+	ASSERT_EQ(3, pl.count());
+	EXPECT_EQ(QPoint(5, -5), pl.point(0));
+	EXPECT_EQ(QRect(QPoint(5, -5), QPoint(10, 10)), pl.boundingRect());
+}
+
+TEST(SmallPolygonTests, LargePolygonsMatchQPolygon)
+{
+	QPolygon ref;
+	for(int i = 0; i < 3*SMALL_POLYGON_SIZE; i++)
+	{
+		ref << QPoint(i, (i*7)%13);
+	}
+
+	SmallPolygon pl(ref);
+	SmallPolygon copy = pl;
+
+	EXPECT_EQ(ref, pl.toPolygon());
+	EXPECT_EQ(ref.boundingRect(), pl.boundingRect());
+	EXPECT_TRUE(copy == pl);
+	copy[5] = QPoint(-1, -1);
+	EXPECT_TRUE(copy != pl);
+}
+
+TEST(SmallPolygonTests, ShrinkingBelowInlineSizeKeepsVertices)
+{
+	SmallPolygon pl;
+	for(int i = 0; i <= SMALL_POLYGON_SIZE; i++)
+	{
+		pl << QPoint(i, -i);
+	}
+	ASSERT_EQ(SMALL_POLYGON_SIZE + 1, pl.count());
+
+	pl.remove(0);
+	ASSERT_EQ(SMALL_POLYGON_SIZE, pl.count());
+	EXPECT_EQ(QPoint(1, -1), pl.point(0));
+	EXPECT_EQ(QPoint(SMALL_POLYGON_SIZE, -SMALL_POLYGON_SIZE), pl.point(SMALL_POLYGON_SIZE - 1));
+
+	pl.insert(0, QPoint(7, 7));
+	EXPECT_EQ(QPoint(7, 7), pl.point(0));
+	EXPECT_EQ(QPoint(1, -1), pl.point(1));
+}
+
+TEST(SmallPolygonTests, PolygonTracksSurviveReallocation)
+{
+	//the vector moves its elements with memcpy when it grows
+	QVector<ViaPointPolygon> track;
+	for(int i = 0; i < 1000; i++)
+	{
+		ViaPointPolygon p;
+		p.frame = i;
+		for(int k = 0; k < 3 + i%(2*SMALL_POLYGON_SIZE); k++)
+		{
+			p.pl << QPoint(i, k);
+		}
+		track << p;
+	}
+
+	for(int i = 0; i < track.count(); i++)
+	{
+		const ViaPointPolygon &p = track.at(i);
+		ASSERT_EQ(3 + i%(2*SMALL_POLYGON_SIZE), p.pl.count());
+		EXPECT_EQ(QPoint(i, p.pl.count() - 1), p.pl.point(p.pl.count() - 1));
+	}
+}
\ No newline at end of file
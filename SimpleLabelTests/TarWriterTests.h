@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <QFileInfo>
+#include <QStringList>
+#include "../SimpleLabel/TarWriter.h"
+#include "TestHelpers.h"
+
+//the data the index lists for the name, empty if it isn't listed
+static QByteArray readIndexedEntry(const QString &archive, const QString &name)
+{
+	QFile idx(TarWriter::indexFile(archive));
+	QFile tar(archive);
+	if(!idx.open(QIODevice::ReadOnly) || !tar.open(QIODevice::ReadOnly))
+		return QByteArray();
+
+	QStringList lines = QString::fromUtf8(idx.readAll()).split('\n', QString::SkipEmptyParts);
+	foreach(QString line, lines)
+	{
+		if(line.section(' ', 2) == name)
+		{
+			tar.seek(line.section(' ', 0, 0).toLongLong());
+			return tar.read(line.section(' ', 1, 1).toLongLong());
+		}
+	}
+	return QByteArray();
+}
+
+TEST(TarWriterTests, IndexPointsToTheEntries)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+
+	TarWriter tar;
+	ASSERT_TRUE(tar.open(file, false));
+	EXPECT_FALSE(tar.isAppending());
+	EXPECT_TRUE(tar.addFile("frame00000.xml", "<annotation/>"));
+	EXPECT_TRUE(tar.addFile("frame 00001.xml", QByteArray(1000, 'x')));
+	EXPECT_TRUE(tar.addFile("empty", QByteArray()));
+	ASSERT_TRUE(tar.finish());
+	EXPECT_EQ(3, tar.entryCount());
+
+	EXPECT_EQ(QByteArray("<annotation/>"), readIndexedEntry(file, "frame00000.xml"));
+	EXPECT_EQ(QByteArray(1000, 'x'), readIndexedEntry(file, "frame 00001.xml"));
+
+	//every entry is a header block and padded data, two zero blocks end it
+	QFile f(file);
+	ASSERT_TRUE(f.open(QIODevice::ReadOnly));
+	QByteArray data = f.readAll();
+	ASSERT_EQ((1 + 1) + (1 + 2) + 1 + 2, data.size() / TAR_BLOCK_SIZE);
+	EXPECT_EQ(0, data.size() % TAR_BLOCK_SIZE);
+	EXPECT_EQ(QByteArray(2*TAR_BLOCK_SIZE, 0), data.right(2*TAR_BLOCK_SIZE));
+	EXPECT_EQ(QByteArray("ustar"), data.mid(257, 5));
+	QFile::remove(TarWriter::indexFile(file));
+}
+
+TEST(TarWriterTests, AppendReplacesEntries)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+
+	TarWriter tar;
+	ASSERT_TRUE(tar.open(file, false));
+	tar.addFile("a", "first");
+	tar.addFile("b", "second");
+	ASSERT_TRUE(tar.finish());
+
+	ASSERT_TRUE(tar.open(file, true));
+	EXPECT_TRUE(tar.isAppending());
+	EXPECT_EQ(2, tar.entryCount());
+	tar.addFile("a", "changed");
+	ASSERT_TRUE(tar.finish());
+	EXPECT_EQ(2, tar.entryCount());
+
+	EXPECT_EQ(QByteArray("changed"), readIndexedEntry(file, "a"));
+	EXPECT_EQ(QByteArray("second"), readIndexedEntry(file, "b"));
+	//the end blocks of the first write are overwritten
+	EXPECT_EQ(3 * 2 + 2, QFileInfo(file).size() / TAR_BLOCK_SIZE);
+
+	//without an index there is nothing to append to
+	QFile::remove(TarWriter::indexFile(file));
+	ASSERT_TRUE(tar.open(file, true));
+	EXPECT_FALSE(tar.isAppending());
+	EXPECT_EQ(0, tar.entryCount());
+	tar.finish();
+	QFile::remove(TarWriter::indexFile(file));
+}
+
+TEST(TarWriterTests, RejectsLongNames)
+{
+	TestFile tmp;
+	QString file = tmp.fileName();
+
+	TarWriter tar;
+	ASSERT_TRUE(tar.open(file, false));
+	EXPECT_FALSE(tar.addFile(QString(TAR_NAME_SIZE + 1, 'n'), "data"));
+	EXPECT_FALSE(tar.errorString().isEmpty());
+	tar.finish();
+	QFile::remove(TarWriter::indexFile(file));
+}
\ No newline at end of file
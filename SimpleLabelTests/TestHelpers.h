@@ -0,0 +1,75 @@
+#ifndef TESTHELPERS_H
+#define TESTHELPERS_H
+
+#include <QTemporaryFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QStringList>
+#include <QImage>
+#include <QPainter>
+#include "../SimpleLabel/Track.h"
+
+//rectangle label moving from (0, 0) to (50, 50) over the given number of frames
+static Label makeTrackLabel(int number, int frames)
+{
+	Label lb;
+	lb.number = number;
+	lb.shape = Rect;
+	Track<RectShape> track(lb);
+	track.addViaPoint(ViaPoint(0, 0.0, QRect(0, 0, 10, 10)));
+	track.addViaPoint(ViaPoint(frames - 1, 0.0, QRect(50, 50, 10, 10)));
+	track.rebuild();
+	return lb;
+}
+
+//Reserves a unique file name in the temp directory. The file and everything
+//written next to it under the same name (indexes, .tmp files of atomic
+//replaces, image sequences) is removed when the test ends.
+class TestFile
+{
+public:
+	TestFile()
+	{
+		QTemporaryFile tmp;
+		tmp.setAutoRemove(false);
+		tmp.open();
+		mFileName = tmp.fileName();
+		tmp.close();
+	}
+
+	~TestFile()
+	{
+		QFileInfo info(mFileName);
+		QDir dir = info.absoluteDir();
+		QStringList files = dir.entryList(QStringList() << info.fileName() + "*", QDir::Files | QDir::Hidden);
+		for (int i = 0; i < files.count(); i++)
+			dir.remove(files.at(i));
+	}
+
+	QString fileName() const { return mFileName; }
+
+private:
+	TestFile(const TestFile &);
+	TestFile &operator=(const TestFile &);
+
+	QString mFileName;
+};
+
+//Writes an image sequence of 200x200 black frames with a white 20x20 square
+//centred at the given points, named after the test file so it is removed with
+//it. Returns the name of the first frame.
+static QString writeSquareSequence(const TestFile &file, const QList<QPoint> &centres)
+{
+	for(int i = 0; i < centres.count(); i++)
+	{
+		QImage im(200, 200, QImage::Format_RGB32);
+		im.fill(qRgb(0, 0, 0));
+		QPainter pt(&im);
+		pt.fillRect(centres[i].x() - 10, centres[i].y() - 10, 20, 20, Qt::white);
+		pt.end();
+		im.save(file.fileName() + QString("%1.png").arg(i, 5, 10, QChar('0')));
+	}
+	return file.fileName() + "00000.png";
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "../SimpleLabel/TrackSimplifier.h"
+
+static QList<ViaPoint> makeDenseTrack(int first, int last, QPoint (*pos)(int))
+{
+	QList<ViaPoint> track;
+	for(int f = first; f <= last; f++)
+	{
+		track << ViaPoint(f, 0.0, QRect(pos(f), QSize(20, 10)));
+	}
+	return track;
+}
+
+static QPoint linearPos(int f)
+{
+	return QPoint(2*f, 100 - f);
+}
+
+//moves right until frame 50, then down
+static QPoint cornerPos(int f)
+{
+	return f <= 50 ? QPoint(3*f, 0) : QPoint(150, 2*(f - 50));
+}
+
+TEST(TrackSimplifierTests, LinearTrackKeepsEndPoints)
+{
+	QList<ViaPoint> res = TrackSimplifier::simplify(makeDenseTrack(0, 99, linearPos), 1.0);
+
+	ASSERT_EQ(2, res.count());
+	EXPECT_EQ(0, res.first().frame);
+	EXPECT_EQ(99, res.last().frame);
+}
+
+TEST(TrackSimplifierTests, CornerIsKept)
+{
+	QList<ViaPoint> res = TrackSimplifier::simplify(makeDenseTrack(0, 100, cornerPos), 1.0);
+
+	ASSERT_EQ(3, res.count());
+	EXPECT_EQ(50, res[1].frame);
+	EXPECT_EQ(QRect(150, 0, 20, 10), res[1].rc);
+}
+
+TEST(TrackSimplifierTests, GapsAreNotBridged)
+{
+	QList<ViaPoint> track = makeDenseTrack(0, 20, linearPos) + makeDenseTrack(40, 60, linearPos);
+	QList<ViaPoint> res = TrackSimplifier::simplify(track, 1.0);
+
+	ASSERT_EQ(4, res.count());
+	EXPECT_EQ(20, res[1].frame);
+	EXPECT_EQ(40, res[2].frame);
+}
+
+TEST(TrackSimplifierTests, PolygonVertexCountChangeIsKept)
+{
+	QVector<ViaPointPolygon> track;
+	for(int f = 0; f < 30; f++)
+	{
+		ViaPointPolygon p;
+		p.frame = f;
+		p.pl << QPoint(f, 0) << QPoint(f + 10, 0) << QPoint(f + 10, 10);
+		if(f >= 15)
+			p.pl << QPoint(f, 10);
+		track << p;
+	}
+
+	QVector<ViaPointPolygon> res = TrackSimplifier::simplify(track, 1.0);
+
+	ASSERT_EQ(4, res.count());
+	EXPECT_EQ(14, res[1].frame);
+	EXPECT_EQ(15, res[2].frame);
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "../SimpleLabel/Track.h"
+
+TEST(TrackTests, AddViaPointKeepsFrameOrderAndReplaces)
+{
+	Label lb;
+	Track<RectShape> track(lb);
+	track.addViaPoint(ViaPoint(20, 0.0, QRect(0, 0, 10, 10)));
+	track.addViaPoint(ViaPoint(5, 0.0, QRect(0, 0, 10, 10)));
+	track.addViaPoint(ViaPoint(20, 0.0, QRect(4, 4, 10, 10)));
+
+	ASSERT_EQ(2, lb.viaPoints.count());
+	EXPECT_EQ(5, lb.viaPoints[0].frame);
+	EXPECT_EQ(QRect(4, 4, 10, 10), lb.viaPoints[1].rc);
+	EXPECT_TRUE(track.isViaPoint(20));
+	EXPECT_TRUE(track.isOutside(21));
+	EXPECT_FALSE(track.isOutside(12));
+}
+
+TEST(TrackTests, RectRebuildCoversAllFrames)
+{
+	Label lb;
+	Track<RectShape> track(lb);
+	track.addViaPoint(ViaPoint(0, 0.0, QRect(0, 0, 10, 10)));
+	track.addViaPoint(ViaPoint(10, 0.0, QRect(10, 0, 10, 10)));
+	track.addViaPoint(ViaPoint(20, 0.0, QRect(10, 10, 10, 10)));
+	track.rebuild();
+
+	ASSERT_EQ(21, lb.boxes.count());
+	ASSERT_TRUE(track.at(5) != NULL);
+	EXPECT_EQ(5, track.at(5)->frame);
+	EXPECT_EQ(QPoint(5, 0), track.at(5)->rc.topLeft());
+	EXPECT_EQ(QRect(10, 10, 10, 10), track.at(20)->rc);
+	EXPECT_TRUE(track.at(21) == NULL);
+
+	EXPECT_TRUE(track.removeViaPoint(20));
+	EXPECT_FALSE(track.removeViaPoint(20));
+	track.rebuild();
+	EXPECT_EQ(11, lb.boxes.count());
+}
+
+TEST(TrackTests, PolygonRebuildInterpolatesVertices)
+{
+	Label lb;
+	Track<PolygonShape> track(lb);
+	ViaPointPolygon p1, p2;
+	p1.frame = 2;
+	p1.pl << QPoint(0, 0) << QPoint(10, 0) << QPoint(0, 10);
+	p2.frame = 6;
+	p2.pl << QPoint(8, 0) << QPoint(18, 0) << QPoint(8, 10);
+	track.addViaPoint(p2);
+	track.addViaPoint(p1);
+	track.rebuild();
+
+	ASSERT_EQ(5, lb.polygons.count());
+	ASSERT_TRUE(track.at(4) != NULL);
+	EXPECT_EQ(QPoint(4, 0), track.at(4)->pl[0]);
+	EXPECT_EQ(QPoint(14, 0), track.at(4)->pl[1]);
+	EXPECT_TRUE(lb.boxes.isEmpty());
+}
+
+TEST(TrackTests, SeekMovesBetweenViaPoints)
+{
+	Label lb;
+	Track<RectShape> track(lb);
+	EXPECT_EQ(-1, track.seek(SeekFirst, 0));
+
+	track.addViaPoint(ViaPoint(3, 0.0, QRect(0, 0, 5, 5)));
+	track.addViaPoint(ViaPoint(8, 0.0, QRect(0, 0, 5, 5)));
+	track.addViaPoint(ViaPoint(15, 0.0, QRect(0, 0, 5, 5)));
+
+	EXPECT_EQ(3, track.seek(SeekFirst, 10));
+	EXPECT_EQ(8, track.seek(SeekPrevious, 10));
+	EXPECT_EQ(3, track.seek(SeekPrevious, 8));
+	EXPECT_EQ(15, track.seek(SeekNext, 8));
+	EXPECT_EQ(15, track.seek(SeekNext, 20));
+	EXPECT_EQ(15, track.seek(SeekLast, 0));
+}
+
+TEST(TrackTests, ReadingKeepsListsShared)
+{
+	Label lb;
+	Track<RectShape> track(lb);
+	track.addViaPoint(ViaPoint(0, 0.0, QRect(0, 0, 10, 10)));
+	track.addViaPoint(ViaPoint(10, 0.0, QRect(10, 0, 10, 10)));
+	track.rebuild();
+
+	Label copy = lb;
+	EXPECT_TRUE(track.isViaPoint(10));
+	EXPECT_FALSE(track.isOutside(5));
+	EXPECT_EQ(10, track.seek(SeekNext, 3));
+	ASSERT_TRUE(track.at(5) != NULL);
+
+	//the copy still shares the lists, nothing was detached for reading
+	EXPECT_EQ(&copy.viaPoints.at(0), &lb.viaPoints.at(0));
+	EXPECT_EQ(&copy.boxes.at(0), &lb.boxes.at(0));
+}
+
+TEST(TrackTests, RebuildKeepsUntouchedSegments)
+{
+	Label lb;
+	Track<RectShape> track(lb);
+	track.addViaPoint(ViaPoint(0, 0.0, QRect(0, 0, 10, 10)));
+	track.addViaPoint(ViaPoint(100, 0.0, QRect(100, 0, 10, 10)));
+	track.addViaPoint(ViaPoint(200, 0.0, QRect(200, 0, 10, 10)));
+	track.addViaPoint(ViaPoint(300, 0.0, QRect(300, 0, 10, 10)));
+	track.rebuild();
+	ASSERT_EQ(301, lb.boxes.count());
+	Label copy = lb;
+
+	track.addViaPoint(ViaPoint(200, 0.0, QRect(200, 50, 10, 10)));
+	track.rebuild();
+	ASSERT_EQ(301, lb.boxes.count());
+	EXPECT_EQ(QRect(150, 25, 10, 10), lb.boxes.at(150).rc);
+	EXPECT_EQ(QRect(50, 0, 10, 10), lb.boxes.at(50).rc);
+
+	//only the two segments next to the moved via point were interpolated again
+	EXPECT_EQ(copy.boxes.block(0).constData(), lb.boxes.block(0).constData());
+	EXPECT_NE(copy.boxes.block(1).constData(), lb.boxes.block(1).constData());
+	EXPECT_NE(copy.boxes.block(2).constData(), lb.boxes.block(2).constData());
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include "../SimpleLabel/UndoStack.h"
+#include "TestHelpers.h"
+
+TEST(UndoStackTests, UndoRedoRestoresLabels)
+{
+	QList<Label> labels;
+	labels << makeTrackLabel(0, 100);
+	UndoStack stack;
+	stack.reset(labels);
+	EXPECT_FALSE(stack.canUndo());
+	EXPECT_FALSE(stack.commit("Nothing", labels));
+
+	labels[0].name = "car";
+	ASSERT_TRUE(stack.commit("Rename Label", labels));
+	labels << makeTrackLabel(1, 10);
+	ASSERT_TRUE(stack.commit("Add Label", labels));
+
+	EXPECT_EQ(QString("Add Label"), stack.undoText());
+	QList<Label> prev = stack.undo();
+	ASSERT_EQ(1, prev.count());
+	EXPECT_EQ(QString("car"), prev[0].name);
+	EXPECT_EQ(QString("Add Label"), stack.redoText());
+
+	EXPECT_EQ(QString(), stack.undo()[0].name);
+	EXPECT_FALSE(stack.canUndo());
+	EXPECT_EQ(1, stack.redo().count());
+
+	//a new edit drops the redo steps
+	labels = prev;
+	labels[0].desc = "red";
+	ASSERT_TRUE(stack.commit("Edit", labels));
+	EXPECT_FALSE(stack.canRedo());
+	EXPECT_EQ(3, stack.count());
+}
+
+TEST(UndoStackTests, StepOnlyCostsChangedTracks)
+{
+	QList<Label> labels;
+	for(int i = 0; i < 10; i++)
+	{
+		labels << makeTrackLabel(i, 1000);
+	}
+	UndoStack stack;
+	stack.reset(labels);
+
+	Track<RectShape> track(labels[3]);
+	track.addViaPoint(ViaPoint(500, 0.0, QRect(0, 0, 20, 20)));
+	track.rebuild();
+	ASSERT_TRUE(stack.commit("Add Via Point", labels));
+
+	EXPECT_EQ(QList<int>() << 3, UndoStack::changedRows(stack.undo(), labels));
+	qint64 trackBytes = UndoStack::unsharedBytes(QList<Label>(), QList<Label>() << labels[3]);
+	EXPECT_GT(trackBytes, 0);
+	EXPECT_EQ(trackBytes, stack.memoryUsage());
+}
+
+TEST(UndoStackTests, MovingViaPointCostsItsSegments)
+{
+	QList<Label> labels;
+	labels << makeTrackLabel(0, 1000);
+	Track<RectShape> track(labels[0]);
+	for(int f = 100; f < 1000; f += 100)
+	{
+		track.addViaPoint(ViaPoint(f, 0.0, QRect(0, 0, 10, 10)));
+	}
+	track.rebuild();
+	UndoStack stack;
+	stack.reset(labels);
+
+	track.addViaPoint(ViaPoint(500, 0.0, QRect(20, 20, 10, 10)));
+	track.rebuild();
+	ASSERT_TRUE(stack.commit("Move Via Point", labels));
+
+	//the step holds the via points and two of the ten segments
+	qint64 trackBytes = UndoStack::unsharedBytes(QList<Label>(), labels);
+	EXPECT_GT(stack.memoryUsage(), 0);
+	EXPECT_LT(stack.memoryUsage(), trackBytes/3);
+}
+
+TEST(UndoStackTests, EqualContentIsNotAStep)
+{
+	QList<Label> labels;
+	labels << makeTrackLabel(0, 100) << makeTrackLabel(1, 100);
+	UndoStack stack;
+	stack.reset(labels);
+
+	//rebuilt from the same via points, nothing is shared but nothing changed
+	labels[1] = makeTrackLabel(1, 100);
+	EXPECT_TRUE(UndoStack::changedRows(stack.undo(), labels).isEmpty());
+	EXPECT_FALSE(stack.commit("Nothing", labels));
+	EXPECT_EQ(1, stack.count());
+}
+
+TEST(UndoStackTests, MemoryLimitDropsOldestSteps)
+{
+	QList<Label> labels;
+	labels << makeTrackLabel(0, 1000);
+	UndoStack stack;
+	stack.reset(labels);
+
+	for(int i = 1; i <= 5; i++)
+	{
+		labels[0] = makeTrackLabel(0, 1000 + i);
+		ASSERT_TRUE(stack.commit("Edit", labels));
+	}
+	EXPECT_EQ(6, stack.count());
+
+	stack.setMemoryLimit(stack.memoryUsage()/2);
+	EXPECT_LE(stack.memoryUsage(), stack.memoryLimit());
+	EXPECT_LT(stack.count(), 6);
+	ASSERT_TRUE(stack.canUndo());
+	EXPECT_EQ(1004, stack.undo()[0].boxes.count());
+}
\ No newline at end of file
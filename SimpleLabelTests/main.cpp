@@ -1,5 +1,28 @@
 #include <gtest/gtest.h>
 #include "ViaPointsTests.h"
+#include "BoxTrackTests.h"
+#include "LabelSpanIndexTests.h"
+#include "GrayImageTests.h"
+#include "TrackSimplifierTests.h"
+#include "LabelShapeTests.h"
+#include "SmallPolygonTests.h"
+#include "BlockListTests.h"
+#include "TrackTests.h"
+#include "UndoStackTests.h"
+#include "LabelStoreTests.h"
+#include "DomStreamWriterTests.h"
+#include "LabelXmlReaderTests.h"
+#include "LabelMeImporterTests.h"
+#include "BoundedQueueTests.h"
+#include "LabelMaskTests.h"
+#include "NpzWriterTests.h"
+#include "MatWriterTests.h"
+#include "ProjectFileTests.h"
+#include "EditJournalTests.h"
+#include "FrameRangeSetTests.h"
+#include "TarWriterTests.h"
+#include "MotionTrackerTests.h"
+#include "DriftAnalyzerTests.h"
 
 int doubleIt(int a)
 {